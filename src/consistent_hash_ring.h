@@ -0,0 +1,146 @@
+/////////////////////////////////////////////////////////////////////////
+///@file consistent_hash_ring.h
+///@brief	带权重的一致性哈希环
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// 一致性哈希环
+// 每个节点按 weight * replicas 个虚拟节点分布在环上，key落在顺时针方向第一个虚拟节点。
+// 增删节点时只有相邻区间的key迁移。哈希函数为固定的FNV-1a + 混淆，
+// 保证不同进程、不同编译器下结果一致（分片结果需要跨重启稳定）。
+template <typename Node>
+class ConsistentHashRing
+{
+public:
+    explicit ConsistentHashRing(int replicas = 160)
+        : replicas_(std::max(1, replicas))
+    {
+    }
+
+    void add_node(const std::string& name, const Node& node, int weight = 1)
+    {
+        remove_node(name);
+
+        const int virtual_nodes = std::max(1, weight) * replicas_;
+        for (int i = 0; i < virtual_nodes; ++i) {
+            uint64_t point = hash(name + "#" + std::to_string(i));
+            // 极少数虚拟节点冲突时取节点名较小者，保证结果与加入顺序无关
+            auto it = ring_.find(point);
+            if (it == ring_.end() || name < it->second.first) {
+                ring_[point] = std::make_pair(name, node);
+            }
+        }
+        nodes_[name] = std::max(1, weight);
+    }
+
+    void remove_node(const std::string& name)
+    {
+        if (nodes_.erase(name) == 0) {
+            return;
+        }
+        for (auto it = ring_.begin(); it != ring_.end();) {
+            if (it->second.first == name) {
+                it = ring_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // 查找key所属节点，环为空时返回nullptr
+    const Node* get(const std::string& key) const
+    {
+        if (ring_.empty()) {
+            return nullptr;
+        }
+        auto it = ring_.lower_bound(hash(key));
+        if (it == ring_.end()) {
+            it = ring_.begin();
+        }
+        return &it->second.second;
+    }
+
+    // 查找key所属节点名，环为空时返回空串
+    std::string get_name(const std::string& key) const
+    {
+        if (ring_.empty()) {
+            return "";
+        }
+        auto it = ring_.lower_bound(hash(key));
+        if (it == ring_.end()) {
+            it = ring_.begin();
+        }
+        return it->second.first;
+    }
+
+    // 从key所在位置顺时针查找第一个满足条件的节点名，都不满足时返回空串
+    // 用于跳过不可用的节点：某个节点不可用时只有原本属于它的key落到下一个节点
+    template <typename Pred>
+    std::string get_name_if(const std::string& key, Pred pred) const
+    {
+        if (ring_.empty()) {
+            return "";
+        }
+        std::map<std::string, bool> checked;
+        auto it = ring_.lower_bound(hash(key));
+        for (size_t i = 0; i < ring_.size() && checked.size() < nodes_.size(); ++i, ++it) {
+            if (it == ring_.end()) {
+                it = ring_.begin();
+            }
+            const std::string& name = it->second.first;
+            auto checked_it = checked.find(name);
+            if (checked_it == checked.end()) {
+                checked_it = checked.emplace(name, pred(name)).first;
+            }
+            if (checked_it->second) {
+                return name;
+            }
+        }
+        return "";
+    }
+
+    bool has_node(const std::string& name) const { return nodes_.count(name) > 0; }
+    bool empty() const { return nodes_.empty(); }
+    size_t size() const { return nodes_.size(); }
+    void clear() { ring_.clear(); nodes_.clear(); }
+
+    std::vector<std::string> get_node_names() const
+    {
+        std::vector<std::string> names;
+        names.reserve(nodes_.size());
+        for (const auto& pair : nodes_) {
+            names.push_back(pair.first);
+        }
+        return names;
+    }
+
+    static uint64_t hash(const std::string& key)
+    {
+        // FNV-1a 64
+        uint64_t h = 14695981039346656037ULL;
+        for (unsigned char c : key) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        // splitmix64 混淆，改善短key的分布
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h;
+    }
+
+private:
+    int replicas_;
+    std::map<uint64_t, std::pair<std::string, Node>> ring_;   // 虚拟节点 -> (节点名, 节点)
+    std::map<std::string, int> nodes_;                        // 节点名 -> 权重
+};
@@ -12,10 +12,45 @@
 #include <cstring>
 #include <thread>
 #include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <future>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
 
+namespace {
+
+// 行情静默检测使用单调时钟，避免系统校时造成误判
+int64_t steady_now_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 重启退避：2s起按指数增长，上限60s，在[delay/2, delay]内随机，避免多个前置同时重连
+const int64_t kRestartBackoffInitialMs = 2000;
+const int64_t kRestartBackoffMaxMs = 60000;
+const size_t kExecutorThreads = 4;
+
+// 降级恢复的观察窗口内至少收到的行情条数，单条在途行情或零星推送不足以恢复
+const uint64_t kRecoveryMinTicks = 10;
+
+std::chrono::milliseconds restart_backoff(int attempts)
+{
+    int64_t delay = kRestartBackoffInitialMs << std::min(attempts, 5);
+    delay = std::min(delay, kRestartBackoffMaxMs);
+    
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    std::uniform_int_distribution<int64_t> jitter(delay / 2, delay);
+    return std::chrono::milliseconds(jitter(rng));
+}
+
+}
+
 // CTPConnection 实现
 CTPConnection::CTPConnection(const CTPConnectionConfig& config, 
                             MarketDataServer* server,
@@ -25,17 +60,43 @@ CTPConnection::CTPConnection(const CTPConnectionConfig& config,
     , dispatcher_(dispatcher)
     , ctp_api_(nullptr)
     , status_(CTPConnectionStatus::DISCONNECTED)
+    , subscription_count_(0)
     , connection_quality_(0)
-    , last_heartbeat_(std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()))
+    , login_tick_count_(0)
+    , last_heartbeat_ms_(steady_now_ms())
     , error_count_(0)
     , request_id_(0)
+    , request_limiter_(config.request_rate, config.request_burst)
+    , command_worker_running_(true)
+    , api_calls_(0)
+    , cancelled_commands_(0)
+    , throttled_requests_(0)
+    , issued_commands_(0)
+    , acked_commands_(0)
+    , queue_latency_total_ms_(0.0)
+    , queue_latency_max_ms_(0.0)
+    , ack_latency_total_ms_(0.0)
+    , ack_latency_max_ms_(0.0)
+    , last_tick_ms_(steady_now_ms())
+    , tick_count_(0)
+    , tick_rate_(0.0)
+    , last_sampled_tick_count_(0)
+    , degraded_since_ms_(0)
+    , recovery_started_ms_(0)
+    , recovery_started_ticks_(0)
 {
+    command_worker_ = std::make_unique<std::thread>(&CTPConnection::command_worker_loop, this);
 }
 
 CTPConnection::~CTPConnection()
 {
     stop();
+    
+    command_worker_running_ = false;
+    command_cv_.notify_all();
+    if (command_worker_ && command_worker_->joinable()) {
+        command_worker_->join();
+    }
 }
 
 bool CTPConnection::start()
@@ -53,9 +114,10 @@ bool CTPConnection::start()
         std::string flow_path = "./ctpflow/" + config_.connection_id + "/";
         
         // 确保flow目录存在
-        std::string mkdir_cmd = "mkdir -p " + flow_path;
-        if (system(mkdir_cmd.c_str()) != 0) {
-            server_->log_warning("Failed to create flow directory: " + flow_path);
+        std::error_code ec;
+        std::filesystem::create_directories(flow_path, ec);
+        if (ec) {
+            server_->log_warning("Failed to create flow directory: " + flow_path + ", " + ec.message());
         }
         
         ctp_api_ = CThostFtdcMdApi::CreateFtdcMdApi(flow_path.c_str());
@@ -94,22 +156,15 @@ void CTPConnection::stop()
     {
         std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
         subscribed_instruments_.clear();
+        sync_subscription_count();
     }
+    clear_command_queue();
     
     server_->log_info("CTP connection " + config_.connection_id + " stopped");
 }
 
-bool CTPConnection::restart()
-{
-    server_->log_info("Restarting CTP connection: " + config_.connection_id);
-    stop();
-    std::this_thread::sleep_for(std::chrono::seconds(2));
-    return start();
-}
-
 bool CTPConnection::subscribe_instrument(const std::string& instrument_id)
 {
-    std::lock_guard<std::mutex> api_lock(api_mutex_);
     std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
     
     if (status_ != CTPConnectionStatus::LOGGED_IN) {
@@ -127,24 +182,16 @@ bool CTPConnection::subscribe_instrument(const std::string& instrument_id)
         return false;
     }
     
-    char* instruments[] = {const_cast<char*>(instrument_id.c_str())};
-    int ret = ctp_api_->SubscribeMarketData(instruments, 1);
-    
-    if (ret == 0) {
-        subscribed_instruments_.insert(instrument_id);
-        server_->log_info("Subscribed to " + instrument_id + " on connection " + config_.connection_id);
-        return true;
-    } else {
-        server_->log_error("Failed to subscribe to " + instrument_id + " on connection " + 
-                          config_.connection_id + ", return code: " + std::to_string(ret));
-        error_count_++;
-        return false;
-    }
+    // 订阅集合在入队时即更新，供负载均衡和容量检查使用；实际下发由命令线程完成
+    subscribed_instruments_.insert(instrument_id);
+    sync_subscription_count();
+    enqueue_command(CTPCommandType::SUBSCRIBE, instrument_id);
+    server_->log_info("Queued subscribe " + instrument_id + " on connection " + config_.connection_id);
+    return true;
 }
 
 bool CTPConnection::unsubscribe_instrument(const std::string& instrument_id)
 {
-    std::lock_guard<std::mutex> api_lock(api_mutex_);
     std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
     
     if (status_ != CTPConnectionStatus::LOGGED_IN) {
@@ -156,25 +203,368 @@ bool CTPConnection::unsubscribe_instrument(const std::string& instrument_id)
         return true; // 已经没有订阅了
     }
     
-    char* instruments[] = {const_cast<char*>(instrument_id.c_str())};
-    int ret = ctp_api_->UnSubscribeMarketData(instruments, 1);
+    subscribed_instruments_.erase(it);
+    sync_subscription_count();
+    enqueue_command(CTPCommandType::UNSUBSCRIBE, instrument_id);
+    server_->log_info("Queued unsubscribe " + instrument_id + " on connection " + config_.connection_id);
+    return true;
+}
+
+size_t CTPConnection::subscribe_instruments(const std::vector<std::string>& instrument_ids,
+                                            std::vector<std::string>& rejected)
+{
+    std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
+    
+    if (status_ != CTPConnectionStatus::LOGGED_IN) {
+        rejected.insert(rejected.end(), instrument_ids.begin(), instrument_ids.end());
+        return 0;
+    }
+    
+    // 过滤已订阅和重复的合约，按剩余容量截断
+    const size_t max_subscriptions = static_cast<size_t>(config_.max_subscriptions);
+    size_t accepted = 0;
+    for (const auto& instrument_id : instrument_ids) {
+        if (subscribed_instruments_.count(instrument_id)) {
+            continue;
+        }
+        if (subscribed_instruments_.size() >= max_subscriptions) {
+            rejected.push_back(instrument_id);
+            continue;
+        }
+        subscribed_instruments_.insert(instrument_id);
+        enqueue_command(CTPCommandType::SUBSCRIBE, instrument_id);
+        accepted++;
+    }
+    sync_subscription_count();
+    
+    return accepted;
+}
+
+size_t CTPConnection::unsubscribe_instruments(const std::vector<std::string>& instrument_ids)
+{
+    std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
+    
+    if (status_ != CTPConnectionStatus::LOGGED_IN) {
+        return 0;
+    }
+    
+    size_t released = 0;
+    for (const auto& instrument_id : instrument_ids) {
+        if (subscribed_instruments_.erase(instrument_id)) {
+            enqueue_command(CTPCommandType::UNSUBSCRIBE, instrument_id);
+            released++;
+        }
+    }
+    sync_subscription_count();
+    
+    return released;
+}
+
+void CTPConnection::enqueue_command(CTPCommandType type, const std::string& instrument_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        
+        // 队列中同一合约尚未下发的相反命令直接抵消
+        auto it = queued_commands_.find(instrument_id);
+        if (it != queued_commands_.end()) {
+            if (it->second->type != type) {
+                it->second->cancelled = true;
+                queued_commands_.erase(it);
+                cancelled_commands_ += 2;
+            }
+            return;
+        }
+        
+        auto command = std::make_shared<CTPCommand>();
+        command->type = type;
+        command->instrument_id = instrument_id;
+        command->enqueue_time = std::chrono::steady_clock::now();
+        command_queue_.push_back(command);
+        queued_commands_[instrument_id] = command;
+    }
+    command_cv_.notify_one();
+}
+
+void CTPConnection::clear_command_queue()
+{
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    command_queue_.clear();
+    queued_commands_.clear();
+    
+    std::lock_guard<std::mutex> stats_lock(command_stats_mutex_);
+    inflight_subscribes_.clear();
+}
+
+void CTPConnection::command_worker_loop()
+{
+    const size_t kMaxBatch = 500;
+    
+    while (command_worker_running_) {
+        std::vector<std::shared_ptr<CTPCommand>> batch;
+        CTPCommandType batch_type = CTPCommandType::SUBSCRIBE;
+        
+        {
+            std::unique_lock<std::mutex> lock(command_mutex_);
+            command_cv_.wait_for(lock, std::chrono::milliseconds(100), [this]() {
+                return !command_worker_running_ || !command_queue_.empty();
+            });
+            if (!command_worker_running_) {
+                break;
+            }
+            
+            while (!command_queue_.empty() && command_queue_.front()->cancelled) {
+                command_queue_.pop_front();
+            }
+            if (command_queue_.empty()) {
+                continue;
+            }
+        }
+        
+        // 未登录时保留队列，登录后继续下发
+        if (status_ != CTPConnectionStatus::LOGGED_IN) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        
+        // 令牌桶限速：一次数组调用消耗一个令牌
+        if (!request_limiter_.try_acquire()) {
+            throttled_requests_++;
+            std::this_thread::sleep_for(std::min(request_limiter_.time_until_available(),
+                                                 std::chrono::milliseconds(100)));
+            continue;
+        }
+        
+        // 取出队首连续的同类命令组成一批
+        {
+            std::lock_guard<std::mutex> lock(command_mutex_);
+            while (!command_queue_.empty() && batch.size() < kMaxBatch) {
+                auto command = command_queue_.front();
+                if (command->cancelled) {
+                    command_queue_.pop_front();
+                    continue;
+                }
+                if (!batch.empty() && command->type != batch_type) {
+                    break;
+                }
+                batch_type = command->type;
+                batch.push_back(command);
+                queued_commands_.erase(command->instrument_id);
+                command_queue_.pop_front();
+            }
+        }
+        
+        if (!batch.empty()) {
+            execute_command_batch(batch_type, batch);
+        }
+    }
+}
+
+void CTPConnection::execute_command_batch(CTPCommandType type, const std::vector<std::shared_ptr<CTPCommand>>& batch)
+{
+    std::vector<char*> instruments;
+    instruments.reserve(batch.size());
+    for (const auto& command : batch) {
+        instruments.push_back(const_cast<char*>(command->instrument_id.c_str()));
+    }
+    
+    auto issue_time = std::chrono::steady_clock::now();
+    int ret = -1;
+    {
+        // 只有命令线程在这里持有api_mutex_调用厂商接口
+        std::lock_guard<std::mutex> api_lock(api_mutex_);
+        if (ctp_api_ && status_ == CTPConnectionStatus::LOGGED_IN) {
+            if (type == CTPCommandType::SUBSCRIBE) {
+                ret = ctp_api_->SubscribeMarketData(instruments.data(), static_cast<int>(instruments.size()));
+            } else {
+                ret = ctp_api_->UnSubscribeMarketData(instruments.data(), static_cast<int>(instruments.size()));
+            }
+        }
+    }
     
+    api_calls_++;
+    {
+        std::lock_guard<std::mutex> stats_lock(command_stats_mutex_);
+        for (const auto& command : batch) {
+            double queue_ms = std::chrono::duration<double, std::milli>(issue_time - command->enqueue_time).count();
+            queue_latency_total_ms_ += queue_ms;
+            queue_latency_max_ms_ = std::max(queue_latency_max_ms_, queue_ms);
+            if (ret == 0 && type == CTPCommandType::SUBSCRIBE) {
+                inflight_subscribes_[command->instrument_id] = command->enqueue_time;
+            }
+        }
+        issued_commands_ += batch.size();
+    }
+    
+    const std::string action = (type == CTPCommandType::SUBSCRIBE) ? "subscribe" : "unsubscribe";
     if (ret == 0) {
-        subscribed_instruments_.erase(it);
-        server_->log_info("Unsubscribed from " + instrument_id + " on connection " + config_.connection_id);
-        return true;
-    } else {
-        server_->log_error("Failed to unsubscribe from " + instrument_id + " on connection " + 
-                          config_.connection_id + ", return code: " + std::to_string(ret));
-        error_count_++;
-        return false;
+        server_->log_info("Issued " + action + " for " + std::to_string(batch.size()) +
+                         " instruments on connection " + config_.connection_id);
+        return;
+    }
+    
+    server_->log_error("Failed to " + action + " " + std::to_string(batch.size()) + " instruments on connection " +
+                      config_.connection_id + ", return code: " + std::to_string(ret));
+    error_count_++;
+    
+    if (type == CTPCommandType::SUBSCRIBE) {
+        {
+            std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
+            for (const auto& command : batch) {
+                subscribed_instruments_.erase(command->instrument_id);
+            }
+            sync_subscription_count();
+        }
+        // 通知分发器重试（不持有本连接的锁）
+        if (dispatcher_) {
+            for (const auto& command : batch) {
+                dispatcher_->on_subscription_failed(config_.connection_id, command->instrument_id);
+            }
+        }
     }
 }
 
+void CTPConnection::record_subscribe_ack(const std::string& instrument_id)
+{
+    std::lock_guard<std::mutex> stats_lock(command_stats_mutex_);
+    auto it = inflight_subscribes_.find(instrument_id);
+    if (it == inflight_subscribes_.end()) {
+        return;
+    }
+    
+    double ack_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - it->second).count();
+    ack_latency_total_ms_ += ack_ms;
+    ack_latency_max_ms_ = std::max(ack_latency_max_ms_, ack_ms);
+    acked_commands_++;
+    inflight_subscribes_.erase(it);
+}
+
+CTPCommandStats CTPConnection::get_command_stats() const
+{
+    CTPCommandStats stats;
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        stats.queued = queued_commands_.size();
+    }
+    stats.api_calls = api_calls_;
+    stats.cancelled = cancelled_commands_;
+    stats.throttled = throttled_requests_;
+    
+    std::lock_guard<std::mutex> stats_lock(command_stats_mutex_);
+    stats.issued = issued_commands_;
+    stats.avg_queue_latency_ms = issued_commands_ ? queue_latency_total_ms_ / issued_commands_ : 0.0;
+    stats.max_queue_latency_ms = queue_latency_max_ms_;
+    stats.avg_ack_latency_ms = acked_commands_ ? ack_latency_total_ms_ / acked_commands_ : 0.0;
+    stats.max_ack_latency_ms = ack_latency_max_ms_;
+    return stats;
+}
+
 size_t CTPConnection::get_subscription_count() const
+{
+    return subscription_count_.load(std::memory_order_relaxed);
+}
+
+void CTPConnection::sync_subscription_count()
+{
+    subscription_count_.store(subscribed_instruments_.size(), std::memory_order_relaxed);
+}
+
+std::vector<std::string> CTPConnection::get_subscribed_instruments() const
 {
     std::lock_guard<std::mutex> lock(subscriptions_mutex_);
-    return subscribed_instruments_.size();
+    return std::vector<std::string>(subscribed_instruments_.begin(), subscribed_instruments_.end());
+}
+
+void CTPConnection::sample_tick_rate(double elapsed_seconds)
+{
+    if (elapsed_seconds <= 0.0) {
+        return;
+    }
+    
+    uint64_t count = tick_count_.load(std::memory_order_relaxed);
+    uint64_t delta = count - last_sampled_tick_count_;
+    last_sampled_tick_count_ = count;
+    
+    // 静默期间保持原频率估计，否则阈值会随静默一起放大
+    if (delta == 0) {
+        return;
+    }
+    
+    double rate = delta / elapsed_seconds;
+    double previous = tick_rate_.load(std::memory_order_relaxed);
+    tick_rate_.store(previous > 0.0 ? previous * 0.8 + rate * 0.2 : rate, std::memory_order_relaxed);
+}
+
+bool CTPConnection::degrade(const std::string& reason)
+{
+    CTPConnectionStatus expected = CTPConnectionStatus::LOGGED_IN;
+    if (!status_.compare_exchange_strong(expected, CTPConnectionStatus::DEGRADED)) {
+        return false;
+    }
+    
+    degraded_since_ms_.store(steady_now_ms(), std::memory_order_relaxed);
+    recovery_started_ms_.store(0, std::memory_order_relaxed);
+    server_->log_warning("CTP connection " + config_.connection_id + " degraded: " + reason);
+    
+    // 连接仍然在线，仅把订阅转移到其他前置；恢复推送后再迁回
+    if (dispatcher_) {
+        dispatcher_->handle_connection_failure(config_.connection_id);
+    }
+    return true;
+}
+
+bool CTPConnection::check_recovery(int64_t now_ms, int64_t gap_limit_ms, int64_t window_ms, uint64_t min_ticks)
+{
+    if (status_.load(std::memory_order_relaxed) != CTPConnectionStatus::DEGRADED) {
+        recovery_started_ms_.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    
+    int64_t started_ms = recovery_started_ms_.load(std::memory_order_relaxed);
+    uint64_t ticks = tick_count_.load(std::memory_order_relaxed);
+    int64_t silence = now_ms - last_tick_ms_.load(std::memory_order_relaxed);
+    if (silence > gap_limit_ms) {
+        if (started_ms != 0) {
+            server_->log_info("CTP connection " + config_.connection_id + " recovery suppressed: " +
+                             std::to_string(ticks - recovery_started_ticks_) + " ticks in " +
+                             std::to_string(now_ms - started_ms) + "ms, then silent for " +
+                             std::to_string(silence) + "ms");
+            recovery_started_ms_.store(0, std::memory_order_relaxed);
+        }
+        return false;
+    }
+    
+    if (started_ms == 0) {
+        recovery_started_ms_.store(now_ms, std::memory_order_relaxed);
+        recovery_started_ticks_ = ticks;
+        return false;
+    }
+    if (now_ms - started_ms < window_ms) {
+        return false;
+    }
+    if (ticks - recovery_started_ticks_ < min_ticks) {
+        // 窗口已满但行情太稀疏，不恢复，从现在重新观察
+        server_->log_info("CTP connection " + config_.connection_id + " recovery suppressed: only " +
+                         std::to_string(ticks - recovery_started_ticks_) + " ticks in " +
+                         std::to_string(now_ms - started_ms) + "ms");
+        recovery_started_ms_.store(now_ms, std::memory_order_relaxed);
+        recovery_started_ticks_ = ticks;
+        return false;
+    }
+    
+    recovery_started_ms_.store(0, std::memory_order_relaxed);
+    CTPConnectionStatus expected = CTPConnectionStatus::DEGRADED;
+    if (!status_.compare_exchange_strong(expected, CTPConnectionStatus::LOGGED_IN)) {
+        return false;
+    }
+    server_->log_info("CTP connection " + config_.connection_id + " resumed market data after " +
+                     std::to_string(now_ms - degraded_since_ms_.load()) + "ms (" +
+                     std::to_string(ticks - recovery_started_ticks_) + " ticks in " +
+                     std::to_string(now_ms - started_ms) + "ms)");
+    if (dispatcher_) {
+        dispatcher_->handle_connection_recovery(config_.connection_id);
+    }
+    return true;
 }
 
 bool CTPConnection::can_accept_more_subscriptions() const
@@ -183,16 +573,14 @@ bool CTPConnection::can_accept_more_subscriptions() const
         return false;
     }
     
-    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
-    return subscribed_instruments_.size() < static_cast<size_t>(config_.max_subscriptions);
+    return get_subscription_count() < static_cast<size_t>(config_.max_subscriptions);
 }
 
 void CTPConnection::OnFrontConnected()
 {
     server_->log_info("CTP connection " + config_.connection_id + " front connected");
     status_ = CTPConnectionStatus::CONNECTED;
-    last_heartbeat_ = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch());
+    last_heartbeat_ms_.store(steady_now_ms(), std::memory_order_relaxed);
     login();
 }
 
@@ -222,7 +610,9 @@ void CTPConnection::OnRspUserLogin(CThostFtdcRspUserLoginField *pRspUserLogin,
     
     server_->log_info("CTP login successful on connection " + config_.connection_id);
     status_ = CTPConnectionStatus::LOGGED_IN;
-    connection_quality_ = 80; // 初始连接质量
+    login_tick_count_.store(tick_count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    connection_quality_ = 80; // 初始连接质量，收到行情后按实时指标评分
+    last_tick_ms_.store(steady_now_ms(), std::memory_order_relaxed);
     
     // 通知订阅分发器连接恢复
     if (dispatcher_) {
@@ -238,6 +628,12 @@ void CTPConnection::OnRspSubMarketData(CThostFtdcSpecificInstrumentField *pSpeci
         std::string error_msg = pRspInfo->ErrorMsg ? std::string(pRspInfo->ErrorMsg) : "Unknown error";
         server_->log_error("Subscribe market data failed on connection " + config_.connection_id + ": " + error_msg);
         
+        if (pSpecificInstrument) {
+            record_subscribe_ack(pSpecificInstrument->InstrumentID);
+            std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
+            subscribed_instruments_.erase(pSpecificInstrument->InstrumentID);
+            sync_subscription_count();
+        }
         if (pSpecificInstrument && dispatcher_) {
             dispatcher_->on_subscription_failed(config_.connection_id, pSpecificInstrument->InstrumentID);
         }
@@ -245,10 +641,11 @@ void CTPConnection::OnRspSubMarketData(CThostFtdcSpecificInstrumentField *pSpeci
         return;
     }
     
+    if (pSpecificInstrument) {
+        record_subscribe_ack(pSpecificInstrument->InstrumentID);
+    }
     if (pSpecificInstrument && dispatcher_) {
-        std::string instrument_id = pSpecificInstrument->InstrumentID;
-        server_->log_info("Successfully subscribed to " + instrument_id + " on connection " + config_.connection_id);
-        dispatcher_->on_subscription_success(config_.connection_id, instrument_id);
+        dispatcher_->on_subscription_success(config_.connection_id, pSpecificInstrument->InstrumentID);
     }
 }
 
@@ -264,9 +661,7 @@ void CTPConnection::OnRspUnSubMarketData(CThostFtdcSpecificInstrumentField *pSpe
     }
     
     if (pSpecificInstrument && dispatcher_) {
-        std::string instrument_id = pSpecificInstrument->InstrumentID;
-        server_->log_info("Successfully unsubscribed from " + instrument_id + " on connection " + config_.connection_id);
-        dispatcher_->on_unsubscription_success(config_.connection_id, instrument_id);
+        dispatcher_->on_unsubscription_success(config_.connection_id, pSpecificInstrument->InstrumentID);
     }
 }
 
@@ -279,6 +674,12 @@ void CTPConnection::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pDepthM
         return;
     }
 
+    // 行情回调的锁约定：连接健康指标、延迟统计、合约频率计数、行情看板槽位查找只用原子变量，不加锁。
+    // 仍会加锁的只有去重和数据交接本身：
+    //   - 行情仲裁：仅在冗余模式开启或有合约迁移重叠时按合约分片加锁，否则直接放行；
+    //   - tick广播环：多个前置线程的写入加锁串行，保持单写入者；
+    //   - Redis写入队列和行情缓存：把数据交给写线程和推送路径。
+
     // 调试日志：记录收到行情数据
     // if (server_) {
     //     server_->log_info("MULTI_CTP_DEBUG: OnRtnDepthMarketData called on connection " + config_.connection_id + 
@@ -287,10 +688,21 @@ void CTPConnection::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pDepthM
     //                      ", volume=" + std::to_string(pDepthMarketData->Volume));
     // }
     
-    // 更新连接质量和心跳
-    last_heartbeat_ = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch());
-    update_connection_quality();
+    // 更新心跳和行情计数，只写原子变量，不加锁；连接质量由读取方计算
+    int64_t now_ms = steady_now_ms();
+    last_heartbeat_ms_.store(now_ms, std::memory_order_relaxed);
+    last_tick_ms_.store(now_ms, std::memory_order_relaxed);
+    tick_count_.fetch_add(1, std::memory_order_relaxed);
+    
+    // 降级的连接是否恢复由检测线程按持续到达的行情判定，单条行情不触发恢复
+    
+    // 每个副本都计入本前置的延迟，仲裁前记录
+    latency_tracker_.record(*pDepthMarketData);
+    
+    // 行情仲裁：多前置订阅同一合约时只转发先到的副本
+    if (!dispatcher_->accept_tick(config_.connection_id, *pDepthMarketData)) {
+        return;
+    }
     
     std::string instrument_id = pDepthMarketData->InstrumentID;
     
@@ -304,8 +716,10 @@ void CTPConnection::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pDepthM
     doc.SetObject();
     auto& allocator = doc.GetAllocator();
     
-    long long timestamp_ms;
-    rapidjson::Value inst_data = MarketDataServer::build_quote_data(pDepthMarketData, display_instrument, allocator, timestamp_ms);
+    NormalizedQuote quote;
+    QuoteCodec::normalize(*pDepthMarketData, quote);
+    server_->publish_quote(display_instrument, quote);
+    rapidjson::Value inst_data = QuoteCodec::to_json(quote, display_instrument, allocator);
     
     // 转换为JSON字符串用于Redis存储和内存缓存
     rapidjson::StringBuffer buffer;
@@ -314,7 +728,7 @@ void CTPConnection::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pDepthM
     std::string json_data = buffer.GetString();
     
     // 存储到Redis
-    server_->store_market_data_to_redis(instrument_id, json_data, timestamp_ms);
+    server_->store_market_data_to_redis(instrument_id, display_instrument, json_data, quote);
     
     // 转发给订阅分发器（用于缓存）
     dispatcher_->on_market_data(config_.connection_id, instrument_id, json_data);
@@ -330,6 +744,14 @@ void CTPConnection::OnRspError(CThostFtdcRspInfoField *pRspInfo, int nRequestID,
     }
 }
 
+void CTPConnection::OnHeartBeatWarning(int nTimeLapse)
+{
+    // 前置心跳超时通常早于断线回调，直接降级以便尽快转移订阅
+    server_->log_warning("CTP heartbeat warning on connection " + config_.connection_id +
+                        ": " + std::to_string(nTimeLapse) + "s since last message");
+    degrade("heartbeat warning");
+}
+
 void CTPConnection::login()
 {
     CThostFtdcReqUserLoginField req;
@@ -350,23 +772,27 @@ void CTPConnection::login()
     }
 }
 
-void CTPConnection::update_connection_quality()
+int CTPConnection::get_connection_quality() const
 {
-    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch());
-    auto time_since_heartbeat = now - last_heartbeat_;
+    // 断开、出错或登录后尚未收到行情时使用状态评分
+    int base = connection_quality_.load(std::memory_order_relaxed);
+    if (base == 0 || tick_count_.load(std::memory_order_relaxed) == login_tick_count_.load(std::memory_order_relaxed)) {
+        return base;
+    }
+    
+    int64_t time_since_heartbeat = steady_now_ms() - last_heartbeat_ms_.load(std::memory_order_relaxed);
     
     int quality = 100;
     
     // 根据心跳间隔调整质量
-    if (time_since_heartbeat.count() > 10000) { // 10秒
+    if (time_since_heartbeat > 10000) { // 10秒
         quality -= 30;
-    } else if (time_since_heartbeat.count() > 5000) { // 5秒
+    } else if (time_since_heartbeat > 5000) { // 5秒
         quality -= 15;
     }
     
     // 根据错误数量调整质量
-    int error_penalty = std::min(error_count_.load() * 10, 50);
+    int error_penalty = std::min(error_count_.load(std::memory_order_relaxed) * 10, 50);
     quality -= error_penalty;
     
     // 根据订阅负载调整质量
@@ -377,7 +803,7 @@ void CTPConnection::update_connection_quality()
         quality -= 10;
     }
     
-    connection_quality_ = std::max(0, std::min(100, quality));
+    return std::max(0, std::min(100, quality));
 }
 
 void CTPConnection::handle_connection_error()
@@ -396,6 +822,9 @@ CTPConnectionManager::CTPConnectionManager(MarketDataServer* server,
     , dispatcher_(dispatcher)
     , health_check_running_(false)
     , health_check_interval_(30) // 30秒健康检查间隔
+    , executor_(std::make_unique<boost::asio::thread_pool>(kExecutorThreads))
+    , restarts_enabled_(false)
+    , startup_login_ms_(-1)
 {
 }
 
@@ -403,6 +832,9 @@ CTPConnectionManager::~CTPConnectionManager()
 {
     stop_health_monitor();
     stop_all_connections();
+    
+    executor_->stop();
+    executor_->join();
 }
 
 bool CTPConnectionManager::add_connection(const CTPConnectionConfig& config)
@@ -439,29 +871,135 @@ bool CTPConnectionManager::remove_connection(const std::string& connection_id)
 
 bool CTPConnectionManager::start_all_connections()
 {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
+    std::vector<std::shared_ptr<CTPConnection>> connections;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        for (const auto& pair : connections_) {
+            connections.push_back(pair.second);
+        }
+    }
+    
+    restarts_enabled_ = true;
+    startup_login_ms_ = -1;
+    int64_t started_ms = steady_now_ms();
+    
+    // 各连接在执行器上并行启动，启动失败的按退避重试
+    std::vector<std::future<bool>> results;
+    for (const auto& conn : connections) {
+        auto task = std::make_shared<std::packaged_task<bool()>>([conn]() {
+            return conn->get_status() != CTPConnectionStatus::DISCONNECTED || conn->start();
+        });
+        results.push_back(task->get_future());
+        boost::asio::post(*executor_, [task]() { (*task)(); });
+    }
     
     bool all_started = true;
-    for (auto& pair : connections_) {
-        if (pair.second->get_status() == CTPConnectionStatus::DISCONNECTED) {
-            if (!pair.second->start()) {
-                server_->log_error("Failed to start connection: " + pair.first);
-                all_started = false;
-            }
+    for (size_t i = 0; i < connections.size(); ++i) {
+        if (!results[i].get()) {
+            server_->log_error("Failed to start connection: " + connections[i]->get_connection_id());
+            schedule_restart(connections[i], "start failed");
+            all_started = false;
         }
     }
     
     // 启动健康检查
     start_health_monitor();
+    watch_startup_login(started_ms);
     
-    server_->log_info("Started " + std::to_string(connections_.size()) + " CTP connections");
+    server_->log_info("Started " + std::to_string(connections.size()) + " CTP connections in " +
+                     std::to_string(steady_now_ms() - started_ms) + "ms");
     return all_started;
 }
 
+void CTPConnectionManager::watch_startup_login(int64_t started_ms)
+{
+    // 每100ms检查一次是否全部登录，最多等待5分钟
+    auto timer = std::make_shared<boost::asio::steady_timer>(*executor_, std::chrono::milliseconds(100));
+    timer->async_wait([this, timer, started_ms](const boost::system::error_code& ec) {
+        if (ec || !restarts_enabled_) {
+            return;
+        }
+        
+        size_t total = 0;
+        size_t logged_in = 0;
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            for (const auto& pair : connections_) {
+                total++;
+                if (pair.second->get_status() == CTPConnectionStatus::LOGGED_IN) {
+                    logged_in++;
+                }
+            }
+        }
+        
+        int64_t elapsed = steady_now_ms() - started_ms;
+        if (total > 0 && logged_in == total) {
+            startup_login_ms_ = elapsed;
+            server_->log_info("All " + std::to_string(total) + " CTP connections logged in after " +
+                             std::to_string(elapsed) + "ms");
+            return;
+        }
+        if (elapsed > 300000) {
+            server_->log_warning("Only " + std::to_string(logged_in) + "/" + std::to_string(total) +
+                                " CTP connections logged in after " + std::to_string(elapsed) + "ms");
+            return;
+        }
+        watch_startup_login(started_ms);
+    });
+}
+
+void CTPConnectionManager::schedule_restart(const std::shared_ptr<CTPConnection>& connection, const std::string& reason)
+{
+    if (!restarts_enabled_) {
+        return;
+    }
+    
+    const std::string conn_id = connection->get_connection_id();
+    std::chrono::milliseconds delay;
+    int attempt = 0;
+    {
+        std::lock_guard<std::mutex> lock(restart_mutex_);
+        auto& state = restart_states_[conn_id];
+        if (state.pending) {
+            return;
+        }
+        state.pending = true;
+        attempt = ++state.attempts;
+        delay = restart_backoff(attempt - 1);
+    }
+    
+    server_->log_warning("Connection " + conn_id + " " + reason + ", restarting in " +
+                        std::to_string(delay.count()) + "ms (attempt " + std::to_string(attempt) + ")");
+    
+    // 先在执行器上停止连接，再由定时器在退避结束后启动
+    boost::asio::post(*executor_, [this, connection, conn_id, delay]() {
+        connection->stop();
+        
+        auto timer = std::make_shared<boost::asio::steady_timer>(*executor_, delay);
+        timer->async_wait([this, connection, conn_id, timer](const boost::system::error_code& ec) {
+            {
+                std::lock_guard<std::mutex> lock(restart_mutex_);
+                restart_states_[conn_id].pending = false;
+            }
+            if (ec || !restarts_enabled_) {
+                return;
+            }
+            
+            server_->log_info("Restarting CTP connection: " + conn_id);
+            if (!connection->start()) {
+                schedule_restart(connection, "restart failed");
+            }
+        });
+    });
+}
+
 void CTPConnectionManager::stop_all_connections()
 {
     stop_health_monitor();
     
+    // 不再执行排队中的重启
+    restarts_enabled_ = false;
+    
     std::lock_guard<std::mutex> lock(connections_mutex_);
     
     for (auto& pair : connections_) {
@@ -557,6 +1095,11 @@ size_t CTPConnectionManager::get_total_subscriptions() const
     return total;
 }
 
+void CTPConnectionManager::set_watchdog(const MultiCTPConfig& config)
+{
+    watchdog_ = std::make_unique<TickWatchdog>(config);
+}
+
 void CTPConnectionManager::start_health_monitor()
 {
     if (health_check_running_) {
@@ -566,6 +1109,10 @@ void CTPConnectionManager::start_health_monitor()
     health_check_running_ = true;
     health_check_thread_ = std::make_unique<std::thread>(&CTPConnectionManager::health_check_loop, this);
     
+    if (watchdog_ && watchdog_->is_enabled()) {
+        watchdog_thread_ = std::make_unique<std::thread>(&CTPConnectionManager::watchdog_loop, this);
+    }
+    
     server_->log_info("Started CTP connection health monitor");
 }
 
@@ -577,7 +1124,12 @@ void CTPConnectionManager::stop_health_monitor()
         health_check_thread_->join();
     }
     
+    if (watchdog_thread_ && watchdog_thread_->joinable()) {
+        watchdog_thread_->join();
+    }
+    
     health_check_thread_.reset();
+    watchdog_thread_.reset();
     server_->log_info("Stopped CTP connection health monitor");
 }
 
@@ -597,36 +1149,33 @@ void CTPConnectionManager::health_check_loop()
             for (const auto& conn : connections_to_check) {
                 CTPConnectionStatus status = conn->get_status();
                 
-                // 检查连接状态
+                // 登录成功后重置退避
+                if (status == CTPConnectionStatus::LOGGED_IN) {
+                    std::lock_guard<std::mutex> lock(restart_mutex_);
+                    auto it = restart_states_.find(conn->get_connection_id());
+                    if (it != restart_states_.end() && !it->second.pending) {
+                        restart_states_.erase(it);
+                    }
+                }
+                
+                // 检查连接状态；重启在执行器上按退避进行，不阻塞其他连接的检查
                 if (status == CTPConnectionStatus::ERROR || 
                     (status == CTPConnectionStatus::DISCONNECTED && conn->get_error_count() > 5)) {
-                    const std::string conn_id = conn->get_connection_id();
-                    bool should_restart = false;
-                    
-                    // 检查是否允许重启（去重+退避）
-                    {
-                        std::lock_guard<std::mutex> lock(restart_mutex_);
-                        const auto now = std::chrono::steady_clock::now();
-                        const auto it = next_restart_allowed_.find(conn_id);
-                        
-                        if (it == next_restart_allowed_.end() || now >= it->second) {
-                            // 允许重启：首次或已过退避期
-                            next_restart_allowed_[conn_id] = now + std::chrono::seconds(10);
-                            should_restart = true;
-                        }
-                    }
-                    
-                    if (should_restart) {
-                        server_->log_warning("Connection " + conn_id + " is unhealthy, attempting restart");
-                        // 直接在健康检查线程内重启，不创建新线程
-                        conn->restart();
+                    schedule_restart(conn, "is unhealthy");
+                }
+                
+                // 降级过久：连接仍在但长时间无行情，重建连接
+                if (status == CTPConnectionStatus::DEGRADED && watchdog_) {
+                    int64_t degraded_ms = steady_now_ms() - conn->get_degraded_since_ms();
+                    // 正在观察恢复的连接等观察结束（恢复或再次静默）后再决定
+                    if (degraded_ms > watchdog_->get_restart_after_seconds() * 1000LL && !conn->is_recovering()) {
+                        schedule_restart(conn, "degraded for " + std::to_string(degraded_ms / 1000) + "s");
+                        continue;
                     }
                 }
                 
                 // 检查心跳超时
-                auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::system_clock::now().time_since_epoch());
-                auto heartbeat_timeout = now - conn->get_last_heartbeat();
+                auto heartbeat_timeout = std::chrono::milliseconds(steady_now_ms()) - conn->get_last_heartbeat();
                 
                 if (status == CTPConnectionStatus::LOGGED_IN && heartbeat_timeout.count() > 60000) { // 1分钟无心跳
                     server_->log_warning("Connection " + conn->get_connection_id() + " heartbeat timeout");
@@ -645,6 +1194,85 @@ void CTPConnectionManager::health_check_loop()
     }
 }
 
+void CTPConnectionManager::watchdog_loop()
+{
+    const auto interval = std::chrono::milliseconds(watchdog_->get_interval_ms());
+    int64_t last_sample_ms = steady_now_ms();
+    
+    while (health_check_running_) {
+        try {
+            std::vector<std::shared_ptr<CTPConnection>> connections;
+            {
+                std::lock_guard<std::mutex> lock(connections_mutex_);
+                for (const auto& pair : connections_) {
+                    connections.push_back(pair.second);
+                }
+            }
+            
+            int64_t now_ms = steady_now_ms();
+            
+            // 每秒采样一次行情频率
+            if (now_ms - last_sample_ms >= 1000) {
+                double elapsed = (now_ms - last_sample_ms) / 1000.0;
+                for (const auto& conn : connections) {
+                    conn->sample_tick_rate(elapsed);
+                }
+                last_sample_ms = now_ms;
+            }
+            
+            // 降级连接的恢复：行情间隔不超过按当前频率计算的静默阈值（频率过低时用上限）并持续一个观察窗口
+            for (const auto& conn : connections) {
+                if (conn->get_status() != CTPConnectionStatus::DEGRADED) {
+                    continue;
+                }
+                int64_t gap_limit = watchdog_->silence_threshold_ms(conn->get_tick_rate());
+                if (gap_limit < 0) {
+                    gap_limit = watchdog_->get_max_silence_ms();
+                }
+                conn->check_recovery(now_ms, gap_limit, watchdog_->recovery_window_ms(), kRecoveryMinTicks);
+            }
+            
+            int64_t ms_since_open = 0;
+            if (watchdog_->in_session(ms_since_open)) {
+                int64_t session_open_ms = now_ms - ms_since_open;
+                
+                // 最近一条行情的到达时间，用于区分单个前置静默和全市场无行情
+                int64_t newest_tick_ms = 0;
+                for (const auto& conn : connections) {
+                    if (conn->get_status() == CTPConnectionStatus::LOGGED_IN) {
+                        newest_tick_ms = std::max(newest_tick_ms, conn->get_last_tick_ms());
+                    }
+                }
+                
+                for (const auto& conn : connections) {
+                    if (conn->get_status() != CTPConnectionStatus::LOGGED_IN || conn->get_subscription_count() == 0) {
+                        continue;
+                    }
+                    
+                    int64_t threshold = watchdog_->silence_threshold_ms(conn->get_tick_rate());
+                    if (threshold < 0) {
+                        continue;
+                    }
+                    
+                    // 开盘前的静默不计入
+                    int64_t last_tick_ms = conn->get_last_tick_ms();
+                    int64_t silence = now_ms - std::max(last_tick_ms, session_open_ms);
+                    if (silence <= threshold || now_ms - newest_tick_ms > threshold || newest_tick_ms <= last_tick_ms) {
+                        continue;
+                    }
+                    
+                    conn->degrade("no market data for " + std::to_string(silence) + "ms (threshold " +
+                                  std::to_string(threshold) + "ms)");
+                }
+            }
+        } catch (const std::exception& e) {
+            server_->log_error("Tick watchdog error: " + std::string(e.what()));
+        }
+        
+        std::this_thread::sleep_for(interval);
+    }
+}
+
 void CTPConnectionManager::handle_connection_failure(const std::string& connection_id)
 {
     server_->log_warning("Handling connection failure: " + connection_id);
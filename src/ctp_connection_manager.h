@@ -9,6 +9,9 @@
 #include "../libs/ThostFtdcMdApi.h"
 #include "../include/open-trade-common/types.h"
 #include "multi_ctp_config.h"
+#include "token_bucket.h"
+#include "latency_tracker.h"
+#include "tick_watchdog.h"
 #include <memory>
 #include <vector>
 #include <map>
@@ -19,20 +22,55 @@
 #include <functional>
 #include <thread>
 #include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <condition_variable>
 
 class MarketDataServer;
 class SubscriptionDispatcher;
 
+namespace boost { namespace asio { class thread_pool; } }
+
 // CTP连接状态
 enum class CTPConnectionStatus {
     DISCONNECTED = 0,
     CONNECTING = 1,
     CONNECTED = 2,
     LOGGED_IN = 3,
-    ERROR = 4
+    ERROR = 4,
+    DEGRADED = 5     // 已登录但行情静默，订阅已转移，恢复推送后回到LOGGED_IN
+};
+
+// CTP命令类型
+enum class CTPCommandType {
+    SUBSCRIBE = 0,
+    UNSUBSCRIBE = 1
+};
+
+// 待下发的CTP命令
+struct CTPCommand {
+    CTPCommandType type;
+    std::string instrument_id;
+    std::chrono::steady_clock::time_point enqueue_time;
+    bool cancelled = false;   // 被队列中的相反命令抵消
+};
+
+// 命令管道统计
+struct CTPCommandStats {
+    size_t queued = 0;                  // 队列中待下发的命令数
+    size_t issued = 0;                  // 已下发的命令数（按合约计）
+    size_t api_calls = 0;               // 厂商接口调用次数
+    size_t cancelled = 0;               // 在队列中相互抵消的命令数
+    size_t throttled = 0;               // 因限速等待的次数
+    double avg_queue_latency_ms = 0.0;  // 入队到下发
+    double max_queue_latency_ms = 0.0;
+    double avg_ack_latency_ms = 0.0;    // 入队到订阅应答
+    double max_ack_latency_ms = 0.0;
 };
 
 // 单个CTP连接管理类
+// 订阅/取消订阅只更新订阅集合并入队，由每个连接独立的命令线程按令牌桶限速、
+// 合并为数组调用后下发，调用方线程不会阻塞在厂商接口上。
 class CTPConnection : public CThostFtdcMdSpi
 {
 public:
@@ -44,22 +82,50 @@ public:
     // 连接管理
     bool start();
     void stop();
-    bool restart();
     
-    // 订阅管理
+    // 订阅管理（非阻塞，入队后由命令线程下发）
     bool subscribe_instrument(const std::string& instrument_id);
     bool unsubscribe_instrument(const std::string& instrument_id);
     
+    // 批量订阅：超出容量的合约放入rejected，返回本次新入队的合约数（已订阅的合约不重复入队）
+    // 命令线程把连续的同类命令合并为一次数组调用
+    size_t subscribe_instruments(const std::vector<std::string>& instrument_ids,
+                                 std::vector<std::string>& rejected);
+    size_t unsubscribe_instruments(const std::vector<std::string>& instrument_ids);
+    
     // 状态查询
     CTPConnectionStatus get_status() const { return status_; }
     const std::string& get_connection_id() const { return config_.connection_id; }
     size_t get_subscription_count() const;
+    size_t get_max_subscriptions() const { return static_cast<size_t>(config_.max_subscriptions); }
+    int get_priority() const { return config_.priority; }
     bool can_accept_more_subscriptions() const;
     
-    // 连接质量指标
-    int get_connection_quality() const { return connection_quality_; }
-    std::chrono::milliseconds get_last_heartbeat() const { return last_heartbeat_; }
-    int get_error_count() const { return error_count_; }
+    // 连接质量指标（读取时计算，行情线程只更新原子计数）
+    int get_connection_quality() const;
+    std::chrono::milliseconds get_last_heartbeat() const   // steady_clock毫秒
+    {
+        return std::chrono::milliseconds(last_heartbeat_ms_.load(std::memory_order_relaxed));
+    }
+    int get_error_count() const { return error_count_.load(std::memory_order_relaxed); }
+    
+    // 行情静默检测
+    int64_t get_last_tick_ms() const { return last_tick_ms_.load(std::memory_order_relaxed); }   // steady_clock毫秒
+    double get_tick_rate() const { return tick_rate_.load(std::memory_order_relaxed); }          // 条/秒（EWMA）
+    void sample_tick_rate(double elapsed_seconds);   // 仅由检测线程调用
+    bool degrade(const std::string& reason);         // LOGGED_IN -> DEGRADED并故障转移
+    // 降级连接的恢复判定，仅由检测线程调用：行情间隔都不超过gap_limit_ms并持续window_ms、
+    // 期间至少min_ticks条时DEGRADED -> LOGGED_IN并迁回订阅；中途再次静默则放弃本次观察并记录日志
+    bool check_recovery(int64_t now_ms, int64_t gap_limit_ms, int64_t window_ms, uint64_t min_ticks);
+    bool is_recovering() const { return recovery_started_ms_.load(std::memory_order_relaxed) != 0; }
+    int64_t get_degraded_since_ms() const { return degraded_since_ms_.load(std::memory_order_relaxed); }
+    std::vector<std::string> get_subscribed_instruments() const;
+    
+    // 实测行情延迟（本地接收时间 - 交易所时间）
+    LatencySnapshot get_latency_snapshot() const { return latency_tracker_.snapshot(); }
+    
+    // 命令管道统计
+    CTPCommandStats get_command_stats() const;
     
     // CTP SPI回调实现
     virtual void OnFrontConnected() override;
@@ -75,12 +141,20 @@ public:
                                      int nRequestID, bool bIsLast) override;
     virtual void OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pDepthMarketData) override;
     virtual void OnRspError(CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast) override;
+    virtual void OnHeartBeatWarning(int nTimeLapse) override;
     
 private:
     void login();
-    void update_connection_quality();
+    void sync_subscription_count();   // 调用方持有subscriptions_mutex_
     void handle_connection_error();
     
+    // 命令管道
+    void enqueue_command(CTPCommandType type, const std::string& instrument_id);
+    void clear_command_queue();
+    void command_worker_loop();
+    void execute_command_batch(CTPCommandType type, const std::vector<std::shared_ptr<CTPCommand>>& batch);
+    void record_subscribe_ack(const std::string& instrument_id);
+    
     CTPConnectionConfig config_;
     MarketDataServer* server_;
     SubscriptionDispatcher* dispatcher_;
@@ -88,16 +162,50 @@ private:
     CThostFtdcMdApi* ctp_api_;
     std::atomic<CTPConnectionStatus> status_;
     std::set<std::string> subscribed_instruments_;
+    std::atomic<size_t> subscription_count_;   // subscribed_instruments_的大小，无锁读取
     
     // 连接质量监控
-    std::atomic<int> connection_quality_;  // 0-100的连接质量评分
-    std::chrono::milliseconds last_heartbeat_;
+    std::atomic<int> connection_quality_;      // 状态评分：断开/错误为0，登录后未收到行情为80
+    std::atomic<uint64_t> login_tick_count_;   // 登录时的tick_count_，之后有行情才按实时指标评分
+    std::atomic<int64_t> last_heartbeat_ms_;   // steady_clock毫秒
     std::atomic<int> error_count_;
     std::atomic<int> request_id_;
+    LatencyTracker latency_tracker_;
+    
+    // 行情静默检测
+    std::atomic<int64_t> last_tick_ms_;
+    std::atomic<uint64_t> tick_count_;
+    std::atomic<double> tick_rate_;
+    uint64_t last_sampled_tick_count_;   // 仅检测线程访问
+    std::atomic<int64_t> degraded_since_ms_;
+    std::atomic<int64_t> recovery_started_ms_;   // 降级后行情重新连续到达的起点，0表示未在观察
+    uint64_t recovery_started_ticks_;            // 仅检测线程访问
     
     // 线程安全
     mutable std::mutex subscriptions_mutex_;
-    std::mutex api_mutex_;
+    std::mutex api_mutex_;  // 仅命令线程和start/stop持有
+    
+    // 命令队列：按入队顺序下发，queued_commands_索引每个合约尚未下发的命令
+    std::deque<std::shared_ptr<CTPCommand>> command_queue_;
+    std::unordered_map<std::string, std::shared_ptr<CTPCommand>> queued_commands_;
+    mutable std::mutex command_mutex_;
+    std::condition_variable command_cv_;
+    TokenBucket request_limiter_;
+    std::unique_ptr<std::thread> command_worker_;
+    std::atomic<bool> command_worker_running_;
+    
+    // 命令统计
+    std::atomic<size_t> api_calls_;
+    std::atomic<size_t> cancelled_commands_;
+    std::atomic<size_t> throttled_requests_;
+    size_t issued_commands_;
+    size_t acked_commands_;
+    double queue_latency_total_ms_;
+    double queue_latency_max_ms_;
+    double ack_latency_total_ms_;
+    double ack_latency_max_ms_;
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> inflight_subscribes_;
+    mutable std::mutex command_stats_mutex_;
 };
 
 // 多CTP连接管理器
@@ -125,14 +233,25 @@ public:
     size_t get_active_connections() const;
     size_t get_total_subscriptions() const;
     
+    // 启动到所有连接登录成功的耗时(毫秒)，尚未全部登录时返回-1
+    int64_t get_startup_login_ms() const { return startup_login_ms_.load(); }
+    
     // 健康检查
     void start_health_monitor();
     void stop_health_monitor();
     
+    // 行情静默检测（随健康检查一起启停）
+    void set_watchdog(const MultiCTPConfig& config);
+    
 private:
     void health_check_loop();
+    void watchdog_loop();
     void handle_connection_failure(const std::string& connection_id);
     
+    // 在执行器上停止连接，退避后由定时器重新启动，不阻塞调用线程
+    void schedule_restart(const std::shared_ptr<CTPConnection>& connection, const std::string& reason);
+    void watch_startup_login(int64_t started_ms);
+    
     MarketDataServer* server_;
     SubscriptionDispatcher* dispatcher_;
     
@@ -144,7 +263,20 @@ private:
     std::atomic<bool> health_check_running_;
     std::chrono::seconds health_check_interval_;
     
-    // 重启去重与退避控制
+    // 行情静默检测线程
+    std::unique_ptr<TickWatchdog> watchdog_;
+    std::unique_ptr<std::thread> watchdog_thread_;
+    
+    // 连接启动与重启执行器
+    std::unique_ptr<boost::asio::thread_pool> executor_;
+    std::atomic<bool> restarts_enabled_;
+    std::atomic<int64_t> startup_login_ms_;
+    
+    // 重启去重与指数退避：登录成功后清零
+    struct RestartState {
+        int attempts = 0;
+        bool pending = false;
+    };
     std::mutex restart_mutex_;
-    std::map<std::string, std::chrono::steady_clock::time_point> next_restart_allowed_;
+    std::map<std::string, RestartState> restart_states_;
 };
\ No newline at end of file
@@ -0,0 +1,518 @@
+/////////////////////////////////////////////////////////////////////////
+///@file front_prober.cpp
+///@brief	行情前置探测与自动选优实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "front_prober.h"
+#include "latency_tracker.h"
+#include "../libs/ThostFtdcMdApi.h"
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 探测用的行情SPI：记录前置连接、登录应答和首个tick的时间
+class ProbeMdSpi : public CThostFtdcMdSpi
+{
+public:
+    ProbeMdSpi(FrontProbeResult& result, const std::string& instrument,
+               std::mutex& mutex, std::condition_variable& cv)
+        : result_(result)
+        , instrument_(instrument)
+        , mutex_(mutex)
+        , cv_(cv)
+        , api_(nullptr)
+        , done_(false)
+        , start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    void attach(CThostFtdcMdApi* api) { api_ = api; }
+    bool is_done() const { return done_; }
+
+    void OnFrontConnected() override
+    {
+        CThostFtdcReqUserLoginField req;
+        memset(&req, 0, sizeof(req));
+        if (api_->ReqUserLogin(&req, 1) != 0) {
+            finish("login request failed");
+        }
+    }
+
+    void OnFrontDisconnected(int nReason) override
+    {
+        finish("front disconnected: " + std::to_string(nReason));
+    }
+
+    void OnRspUserLogin(CThostFtdcRspUserLoginField*, CThostFtdcRspInfoField* pRspInfo,
+                        int, bool) override
+    {
+        if (pRspInfo && pRspInfo->ErrorID != 0) {
+            finish("login failed: " + std::to_string(pRspInfo->ErrorID));
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            result_.login_ok = true;
+            result_.login_ms = elapsed_ms(start_);
+        }
+        if (instrument_.empty()) {
+            finish("");
+            return;
+        }
+        char* instruments[1] = {const_cast<char*>(instrument_.c_str())};
+        if (api_->SubscribeMarketData(instruments, 1) != 0) {
+            finish("subscribe request failed");
+        }
+    }
+
+    void OnRtnDepthMarketData(CThostFtdcDepthMarketDataField* pDepthMarketData) override
+    {
+        if (!pDepthMarketData) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (result_.tick_received) {
+                return;
+            }
+            result_.tick_received = true;
+            result_.tick_latency_ms = std::max(0.0, LatencyTracker::exchange_latency_ms(*pDepthMarketData));
+        }
+        finish("");
+    }
+
+private:
+    void finish(const std::string& error)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (done_) {
+            return;
+        }
+        if (!error.empty() && result_.error.empty()) {
+            result_.error = error;
+        }
+        done_ = true;
+        cv_.notify_all();
+    }
+
+    FrontProbeResult& result_;
+    std::string instrument_;
+    std::mutex& mutex_;
+    std::condition_variable& cv_;
+    CThostFtdcMdApi* api_;
+    bool done_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace
+
+FrontProber::FrontProber(const MultiCTPConfig& config)
+    : timeout_ms_(config.probe_timeout_ms)
+    , top_k_(config.probe_top_k)
+    , ctp_login_(config.probe_ctp_login)
+    , probe_instrument_(config.probe_instrument)
+{
+}
+
+bool FrontProber::load_candidates(const std::string& broker_data_file,
+                                  const std::vector<std::string>& brokers,
+                                  std::vector<FrontCandidate>& candidates)
+{
+    std::ifstream file(broker_data_file);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open broker data file: " << broker_data_file << std::endl;
+        return false;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    rapidjson::Document doc;
+    doc.Parse(content.c_str());
+    if (doc.HasParseError() || !doc.IsArray()) {
+        std::cerr << "Invalid broker data file: " << broker_data_file << std::endl;
+        return false;
+    }
+
+    std::set<std::string> broker_filter(brokers.begin(), brokers.end());
+    std::set<std::string> seen_addresses;
+    candidates.clear();
+
+    for (const auto& broker : doc.GetArray()) {
+        if (!broker.IsObject() || !broker.HasMember("brokerid") || !broker["brokerid"].IsString()) {
+            continue;
+        }
+        FrontCandidate base;
+        base.broker_id = broker["brokerid"].GetString();
+        if (!broker_filter.empty() && broker_filter.count(base.broker_id) == 0) {
+            continue;
+        }
+        if (broker.HasMember("broker_name") && broker["broker_name"].IsString()) {
+            base.broker_name = broker["broker_name"].GetString();
+        }
+        if (broker.HasMember("broker_ename") && broker["broker_ename"].IsString()) {
+            base.broker_ename = broker["broker_ename"].GetString();
+        }
+        if (!broker.HasMember("servers") || !broker["servers"].IsArray()) {
+            continue;
+        }
+
+        for (const auto& server : broker["servers"].GetArray()) {
+            if (!server.IsObject() || !server.HasMember("market_data") || !server["market_data"].IsArray()) {
+                continue;
+            }
+            FrontCandidate candidate = base;
+            if (server.HasMember("name") && server["name"].IsString()) {
+                candidate.server_name = server["name"].GetString();
+            }
+            for (const auto& address : server["market_data"].GetArray()) {
+                if (!address.IsString()) {
+                    continue;
+                }
+                candidate.address = address.GetString();
+                // 同一地址只探测一次
+                if (candidate.address.find(':') != std::string::npos &&
+                    seen_addresses.insert(candidate.address).second) {
+                    candidates.push_back(candidate);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<FrontProbeResult> FrontProber::probe(const std::vector<FrontCandidate>& candidates)
+{
+    std::vector<FrontProbeResult> results;
+    results.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        FrontProbeResult result;
+        result.candidate = candidate;
+        result.connection_id = make_connection_id(candidate);
+        results.push_back(result);
+    }
+
+    std::cout << "Probing " << results.size() << " market data fronts (timeout " << timeout_ms_ << " ms)..." << std::endl;
+    probe_tcp(results);
+
+    if (ctp_login_) {
+        probe_ctp_login(results);
+    }
+
+    rank(results);
+    return results;
+}
+
+void FrontProber::probe_tcp(std::vector<FrontProbeResult>& results) const
+{
+    struct PendingConnect {
+        size_t index;
+        int fd;
+        std::chrono::steady_clock::time_point start;
+    };
+    std::vector<PendingConnect> pending;
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const std::string& address = results[i].candidate.address;
+        size_t colon = address.rfind(':');
+        std::string host = address.substr(0, colon);
+        std::string port = address.substr(colon + 1);
+
+        addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* info = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &info) != 0 || !info) {
+            results[i].error = "resolve failed";
+            continue;
+        }
+
+        int fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd < 0) {
+            results[i].error = "socket failed";
+            freeaddrinfo(info);
+            continue;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+        auto start = std::chrono::steady_clock::now();
+        int ret = connect(fd, info->ai_addr, info->ai_addrlen);
+        freeaddrinfo(info);
+        if (ret == 0) {
+            results[i].tcp_ok = true;
+            results[i].connect_ms = elapsed_ms(start);
+            close(fd);
+        } else if (errno == EINPROGRESS) {
+            pending.push_back({i, fd, start});
+        } else {
+            results[i].error = std::string("connect failed: ") + strerror(errno);
+            close(fd);
+        }
+    }
+
+    // 所有连接共用一个截止时间，poll等待
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms_);
+    while (!pending.empty()) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            break;
+        }
+
+        std::vector<pollfd> fds(pending.size());
+        for (size_t i = 0; i < pending.size(); ++i) {
+            fds[i].fd = pending[i].fd;
+            fds[i].events = POLLOUT;
+            fds[i].revents = 0;
+        }
+        if (poll(fds.data(), fds.size(), static_cast<int>(remaining)) <= 0) {
+            continue;
+        }
+
+        std::vector<PendingConnect> still_pending;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (fds[i].revents == 0) {
+                still_pending.push_back(pending[i]);
+                continue;
+            }
+            FrontProbeResult& result = results[pending[i].index];
+            int so_error = 0;
+            socklen_t len = sizeof(so_error);
+            getsockopt(pending[i].fd, SOL_SOCKET, SO_ERROR, &so_error, &len);
+            if (so_error == 0) {
+                result.tcp_ok = true;
+                result.connect_ms = elapsed_ms(pending[i].start);
+            } else {
+                result.error = std::string("connect failed: ") + strerror(so_error);
+            }
+            close(pending[i].fd);
+        }
+        pending.swap(still_pending);
+    }
+
+    for (const auto& item : pending) {
+        results[item.index].error = "connect timeout";
+        close(item.fd);
+    }
+}
+
+void FrontProber::probe_ctp_login(std::vector<FrontProbeResult>& results) const
+{
+    // 只对TCP建连最快的一部分前置做登录探测，控制API实例数量
+    std::vector<size_t> order;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i].tcp_ok) {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&results](size_t a, size_t b) {
+        return results[a].connect_ms < results[b].connect_ms;
+    });
+    size_t login_limit = static_cast<size_t>(std::max(top_k_ * 3, 10));
+    if (order.size() > login_limit) {
+        order.resize(login_limit);
+    }
+    if (order.empty()) {
+        return;
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::unique_ptr<ProbeMdSpi>> spis;
+    std::vector<CThostFtdcMdApi*> apis;
+
+    for (size_t index : order) {
+        FrontProbeResult& result = results[index];
+        std::string flow_path = "./ctpflow/probe/" + result.connection_id + "/";
+        std::error_code ec;
+        std::filesystem::create_directories(flow_path, ec);
+        if (ec) {
+            std::cerr << "Failed to create probe flow directory: " << flow_path << ", " << ec.message() << std::endl;
+            result.error = "failed to create flow directory: " + ec.message();
+            continue;
+        }
+
+        CThostFtdcMdApi* api = CThostFtdcMdApi::CreateFtdcMdApi(flow_path.c_str());
+        if (!api) {
+            result.error = "failed to create md api";
+            continue;
+        }
+        auto spi = std::make_unique<ProbeMdSpi>(result, probe_instrument_, mutex, cv);
+        spi->attach(api);
+        api->RegisterSpi(spi.get());
+        std::string front_addr = "tcp://" + result.candidate.address;
+        api->RegisterFront(const_cast<char*>(front_addr.c_str()));
+        api->Init();
+
+        spis.push_back(std::move(spi));
+        apis.push_back(api);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::milliseconds(timeout_ms_), [&spis]() {
+            for (const auto& spi : spis) {
+                if (!spi->is_done()) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+
+    for (auto* api : apis) {
+        api->RegisterSpi(nullptr);
+        api->Release();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t index : order) {
+        FrontProbeResult& result = results[index];
+        if (!result.login_ok && result.error.empty()) {
+            result.error = "login timeout";
+        }
+    }
+}
+
+void FrontProber::rank(std::vector<FrontProbeResult>& results)
+{
+    bool login_probed = false;
+    bool tick_probed = false;
+    for (const auto& result : results) {
+        login_probed = login_probed || result.login_ok;
+        tick_probed = tick_probed || result.tick_received;
+    }
+
+    for (auto& result : results) {
+        result.score = -1.0;
+        if (!result.tcp_ok) {
+            continue;
+        }
+        if (login_probed) {
+            // 有前置登录成功时，登录失败的前置不参与选择
+            if (!result.login_ok) {
+                continue;
+            }
+            result.score = result.login_ms;
+        } else {
+            result.score = result.connect_ms;
+        }
+        // 首个tick越新鲜越好；收不到探测合约行情的前置排在有行情的之后
+        if (tick_probed) {
+            result.score += result.tick_received ? result.tick_latency_ms : 60000.0;
+        }
+    }
+
+    std::stable_sort(results.begin(), results.end(), [](const FrontProbeResult& a, const FrontProbeResult& b) {
+        if ((a.score < 0) != (b.score < 0)) {
+            return b.score < 0;
+        }
+        return a.score < b.score;
+    });
+}
+
+std::vector<CTPConnectionConfig> FrontProber::build_connections(std::vector<FrontProbeResult>& results,
+                                                                const CTPConnectionConfig& template_config) const
+{
+    std::vector<CTPConnectionConfig> connections;
+    int priority = 1;
+    for (auto& result : results) {
+        if (static_cast<int>(connections.size()) >= top_k_ || result.score < 0) {
+            break;
+        }
+        CTPConnectionConfig conn = template_config;
+        conn.connection_id = result.connection_id;
+        conn.front_addr = "tcp://" + result.candidate.address;
+        conn.broker_id = result.candidate.broker_id;
+        conn.priority = priority++;
+        conn.enabled = true;
+        connections.push_back(conn);
+        result.selected = true;
+    }
+    return connections;
+}
+
+bool FrontProber::write_report(const std::vector<FrontProbeResult>& results, const std::string& report_file) const
+{
+    rapidjson::Document doc;
+    doc.SetObject();
+    auto& allocator = doc.GetAllocator();
+
+    std::time_t now = std::time(nullptr);
+    char time_buf[32];
+    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+    doc.AddMember("generated_at", rapidjson::Value(time_buf, allocator), allocator);
+    doc.AddMember("timeout_ms", timeout_ms_, allocator);
+    doc.AddMember("top_k", top_k_, allocator);
+    doc.AddMember("ctp_login", ctp_login_, allocator);
+    doc.AddMember("probe_instrument", rapidjson::Value(probe_instrument_.c_str(), allocator), allocator);
+
+    rapidjson::Value items(rapidjson::kArrayType);
+    int rank_no = 1;
+    for (const auto& result : results) {
+        rapidjson::Value item(rapidjson::kObjectType);
+        item.AddMember("rank", result.score >= 0 ? rank_no++ : 0, allocator);
+        item.AddMember("selected", result.selected, allocator);
+        item.AddMember("connection_id", rapidjson::Value(result.connection_id.c_str(), allocator), allocator);
+        item.AddMember("broker_id", rapidjson::Value(result.candidate.broker_id.c_str(), allocator), allocator);
+        item.AddMember("broker_name", rapidjson::Value(result.candidate.broker_name.c_str(), allocator), allocator);
+        item.AddMember("server", rapidjson::Value(result.candidate.server_name.c_str(), allocator), allocator);
+        item.AddMember("address", rapidjson::Value(result.candidate.address.c_str(), allocator), allocator);
+        item.AddMember("tcp_ok", result.tcp_ok, allocator);
+        item.AddMember("connect_ms", result.connect_ms, allocator);
+        item.AddMember("login_ok", result.login_ok, allocator);
+        item.AddMember("login_ms", result.login_ms, allocator);
+        item.AddMember("tick_received", result.tick_received, allocator);
+        item.AddMember("tick_latency_ms", result.tick_latency_ms, allocator);
+        item.AddMember("score", result.score, allocator);
+        item.AddMember("error", rapidjson::Value(result.error.c_str(), allocator), allocator);
+        items.PushBack(item, allocator);
+    }
+    doc.AddMember("results", items, allocator);
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    doc.Accept(writer);
+
+    std::ofstream file(report_file);
+    if (!file.is_open()) {
+        std::cerr << "Failed to write probe report: " << report_file << std::endl;
+        return false;
+    }
+    file << buffer.GetString() << std::endl;
+    return true;
+}
+
+std::string FrontProber::make_connection_id(const FrontCandidate& candidate)
+{
+    // 例如 bhfcc_116_228_31_198_43213
+    std::string id = candidate.broker_ename.empty() ? candidate.broker_id : candidate.broker_ename;
+    id += "_" + candidate.address;
+    std::replace(id.begin(), id.end(), '.', '_');
+    std::replace(id.begin(), id.end(), ':', '_');
+    return id;
+}
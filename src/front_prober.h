@@ -0,0 +1,70 @@
+/////////////////////////////////////////////////////////////////////////
+///@file front_prober.h
+///@brief	行情前置探测与自动选优
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "multi_ctp_config.h"
+#include <string>
+#include <vector>
+
+// 候选前置（来自broker_data.json）
+struct FrontCandidate {
+    std::string broker_id;
+    std::string broker_name;
+    std::string broker_ename;
+    std::string server_name;      // 线路名称，如"电信"、"联通"
+    std::string address;          // host:port
+};
+
+// 单个前置的探测结果
+struct FrontProbeResult {
+    FrontCandidate candidate;
+    std::string connection_id;
+    bool tcp_ok = false;
+    double connect_ms = -1.0;     // TCP建连耗时
+    bool login_ok = false;
+    double login_ms = -1.0;       // 从Init到登录应答的耗时
+    bool tick_received = false;
+    double tick_latency_ms = -1.0; // 首个tick相对交易所时间的延迟
+    double score = -1.0;          // 排序得分（毫秒，越小越好），不可用为负
+    bool selected = false;
+    std::string error;
+};
+
+// 前置探测器
+// 并行对所有候选前置发起非阻塞TCP连接，在截止时间内按建连耗时排序；
+// 可选对TCP可达的前置并行执行CTP登录并订阅探测合约，按登录耗时和首个tick的新鲜度修正排序。
+// 最终取前K个生成连接配置，并把完整探测结果写入报告文件。
+class FrontProber
+{
+public:
+    explicit FrontProber(const MultiCTPConfig& config);
+
+    // 从broker_data.json加载候选前置，brokers非空时只保留指定的brokerid
+    static bool load_candidates(const std::string& broker_data_file,
+                                const std::vector<std::string>& brokers,
+                                std::vector<FrontCandidate>& candidates);
+
+    // 执行探测，返回按得分排序的结果（不可用的前置排在最后）
+    std::vector<FrontProbeResult> probe(const std::vector<FrontCandidate>& candidates);
+
+    // 用前K个可用前置生成连接配置，template_config提供max_subscriptions/限速等参数
+    std::vector<CTPConnectionConfig> build_connections(std::vector<FrontProbeResult>& results,
+                                                       const CTPConnectionConfig& template_config) const;
+
+    bool write_report(const std::vector<FrontProbeResult>& results, const std::string& report_file) const;
+
+private:
+    void probe_tcp(std::vector<FrontProbeResult>& results) const;
+    void probe_ctp_login(std::vector<FrontProbeResult>& results) const;
+    static void rank(std::vector<FrontProbeResult>& results);
+    static std::string make_connection_id(const FrontCandidate& candidate);
+
+    int timeout_ms_;
+    int top_k_;
+    bool ctp_login_;
+    std::string probe_instrument_;
+};
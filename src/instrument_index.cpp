@@ -0,0 +1,180 @@
+/////////////////////////////////////////////////////////////////////////
+///@file instrument_index.cpp
+///@brief	共享内存合约哈希索引实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "instrument_index.h"
+
+InstrumentIndex::InstrumentIndex()
+    : header_(nullptr)
+    , legacy_map_(nullptr)
+{
+}
+
+bool InstrumentIndex::attach(boost::interprocess::managed_shared_memory* segment, uint32_t capacity,
+                             InsMapType* legacy_map, std::string& error)
+{
+    detach();
+    
+    uint32_t bucket_count = 1;
+    while (bucket_count < capacity * 2u) {
+        bucket_count <<= 1;
+    }
+    
+    try {
+        auto existing = segment->find<char>(kInsIndexName);
+        if (existing.first) {
+            header_ = reinterpret_cast<InsIndexHeader*>(existing.first);
+            if (header_->magic != kInsIndexMagic || header_->version != kInsIndexVersion ||
+                header_->entry_size != sizeof(InsIndexEntry) ||
+                ins_index_size(header_->capacity, header_->bucket_count) > existing.second) {
+                header_ = nullptr;
+                error = "incompatible InsIndex layout in segment";
+                return false;
+            }
+        } else {
+            size_t size = ins_index_size(capacity, bucket_count);
+            char* block = segment->construct<char>(kInsIndexName)[size](0);
+            header_ = reinterpret_cast<InsIndexHeader*>(block);
+            new (&header_->count) std::atomic<uint32_t>(0);
+            InsIndexEntry* entries = ins_index_entries(header_);
+            for (uint32_t i = 0; i < capacity; ++i) {
+                new (&entries[i].instrument) Instrument();
+            }
+            header_->version = kInsIndexVersion;
+            header_->capacity = capacity;
+            header_->bucket_count = bucket_count;
+            header_->entry_size = sizeof(InsIndexEntry);
+            InsIndexBucket* buckets = ins_index_buckets(header_);
+            for (uint32_t i = 0; i < bucket_count; ++i) {
+                new (&buckets[i].slot) std::atomic<uint32_t>(0);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            header_->magic = kInsIndexMagic;
+        }
+    } catch (const boost::interprocess::interprocess_exception& e) {
+        header_ = nullptr;
+        error = e.what();
+        return false;
+    }
+    
+    legacy_map_ = legacy_map;
+    legacy_instruments_.assign(header_->capacity, nullptr);
+    if (!legacy_map_) {
+        return true;
+    }
+    
+    // 导入InsMap中已有的合约（其他进程写入或上次运行留下的），并解析两边的对应关系
+    for (auto& item : *legacy_map_) {
+        const char* key = item.first.data();
+        if (key[0] == '\0') {
+            continue;
+        }
+        uint64_t hash = ins_index_hash(key);
+        int slot = find(hash, key);
+        if (slot < 0) {
+            slot = insert_entry(hash, key);
+            if (slot < 0) {
+                error = "InsIndex full, " + std::to_string(legacy_map_->size()) + " instruments in InsMap";
+                break;
+            }
+            // 新条目沿用InsMap中的合约信息和最新价
+            ins_index_entries(header_)[slot].instrument = const_cast<const Instrument&>(item.second);
+        }
+        legacy_instruments_[slot] = &item.second;
+    }
+    return true;
+}
+
+void InstrumentIndex::detach()
+{
+    header_ = nullptr;
+    legacy_map_ = nullptr;
+    legacy_instruments_.clear();
+}
+
+int InstrumentIndex::insert_entry(uint64_t hash, const char* key)
+{
+    uint32_t slot = header_->count.load(std::memory_order_relaxed);
+    if (slot >= header_->capacity) {
+        return -1;
+    }
+    
+    InsIndexEntry& entry = ins_index_entries(header_)[slot];
+    entry.hash = hash;
+    entry.key = {};
+    strncpy(entry.key.data(), key, entry.key.size() - 1);
+    entry.instrument = Instrument();
+    
+    InsIndexBucket* buckets = ins_index_buckets(header_);
+    uint32_t mask = header_->bucket_count - 1;
+    uint32_t pos = static_cast<uint32_t>(hash) & mask;
+    while (buckets[pos].slot.load(std::memory_order_relaxed) != 0) {
+        pos = (pos + 1) & mask;
+    }
+    buckets[pos].hash = hash;
+    buckets[pos].slot.store(slot + 1, std::memory_order_release);
+    header_->count.store(slot + 1, std::memory_order_release);
+    return static_cast<int>(slot);
+}
+
+int InstrumentIndex::upsert(const std::string& instrument_id, bool& created)
+{
+    created = false;
+    if (!header_ || instrument_id.empty()) {
+        return -1;
+    }
+    
+    uint64_t hash = ins_index_hash(instrument_id.c_str());
+    int slot = find(hash, instrument_id.c_str());
+    if (slot < 0) {
+        slot = insert_entry(hash, instrument_id.c_str());
+        if (slot < 0) {
+            return -1;
+        }
+        created = true;
+    }
+    
+    if (legacy_map_ && !legacy_instruments_[slot]) {
+        InsMapKeyType key = {};
+        strncpy(key.data(), instrument_id.c_str(), key.size() - 1);
+        auto it = legacy_map_->find(key);
+        if (it == legacy_map_->end()) {
+            // 共享内存不足时抛出boost::interprocess::bad_alloc，由调用方处理；索引条目已生效
+            it = legacy_map_->insert(InsMapValueType(key, Instrument())).first;
+        }
+        legacy_instruments_[slot] = &it->second;
+    }
+    return slot;
+}
+
+int InstrumentIndex::find(const std::string& instrument_id) const
+{
+    return find(ins_index_hash(instrument_id.c_str()), instrument_id.c_str());
+}
+
+int InstrumentIndex::find(uint64_t hash, const char* instrument_id) const
+{
+    return header_ ? ins_index_find(header_, hash, instrument_id) : -1;
+}
+
+Instrument* InstrumentIndex::instrument(int slot)
+{
+    return (header_ && slot >= 0 && static_cast<uint32_t>(slot) < size()) ? &ins_index_entries(header_)[slot].instrument : nullptr;
+}
+
+Instrument* InstrumentIndex::legacy_instrument(int slot)
+{
+    return (slot >= 0 && static_cast<size_t>(slot) < legacy_instruments_.size()) ? legacy_instruments_[slot] : nullptr;
+}
+
+const char* InstrumentIndex::instrument_id(int slot) const
+{
+    return (header_ && slot >= 0 && static_cast<uint32_t>(slot) < size()) ? ins_index_entries(header_)[slot].key.data() : nullptr;
+}
+
+uint32_t InstrumentIndex::size() const
+{
+    return header_ ? header_->count.load(std::memory_order_acquire) : 0;
+}
@@ -0,0 +1,50 @@
+/////////////////////////////////////////////////////////////////////////
+///@file instrument_index.h
+///@brief	共享内存合约哈希索引（写入端）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "instrument_index_layout.h"
+#include <string>
+#include <vector>
+
+// qamddata段中定容的开放寻址哈希表，替代按64字节strncmp逐层比较的InsMap红黑树查找。
+// 整张表一次分配，合约增加时不再零碎分配共享内存；条目槽号稳定，可作为稠密合约编号。
+// 迁移期间（legacy_map非空）新增合约同时写入InsMap，已有的InsMap读取进程不受影响；
+// Instrument的行情字段由调用方经instrument()和legacy_instrument()两处同步更新。
+// 只有网关一个写入者，新增合约只在启动加载合约表时发生；查找不加锁。
+class InstrumentIndex
+{
+public:
+    InstrumentIndex();
+
+    // 在段中查找或创建索引；已存在时沿用其容量。legacy_map中已有的合约导入索引
+    bool attach(boost::interprocess::managed_shared_memory* segment, uint32_t capacity,
+                InsMapType* legacy_map, std::string& error);
+    void detach();
+    bool is_attached() const { return header_ != nullptr; }
+
+    // 查找或新增合约，返回槽号；索引已满或共享内存不足时返回-1
+    int upsert(const std::string& instrument_id, bool& created);
+
+    int find(const std::string& instrument_id) const;
+    int find(uint64_t hash, const char* instrument_id) const;
+
+    Instrument* instrument(int slot);
+    // InsMap中的同一合约，未启用兼容或InsMap中没有时为nullptr
+    Instrument* legacy_instrument(int slot);
+    const char* instrument_id(int slot) const;
+
+    uint32_t size() const;
+    uint32_t capacity() const { return header_ ? header_->capacity : 0; }
+
+private:
+    int insert_entry(uint64_t hash, const char* key);
+
+    InsIndexHeader* header_;
+    InsMapType* legacy_map_;
+    // 槽号 -> InsMap中的合约（本进程内地址）
+    std::vector<Instrument*> legacy_instruments_;
+};
@@ -0,0 +1,104 @@
+/////////////////////////////////////////////////////////////////////////
+///@file instrument_index_layout.h
+///@brief	共享内存合约哈希索引布局（网关与qamddata的其他读取进程共用）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../include/open-trade-common/types.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// qamddata段中名为"InsIndex"的一块连续内存：InsIndexHeader 后接 capacity 个 InsIndexEntry，再接 bucket_count 个 InsIndexBucket。
+// 条目按合约首次加入的顺序追加，槽号不再改变，可直接作为稠密的合约编号；合约代码为带交易所前缀的显示格式，如SHFE.rb2501。
+// 桶为开放寻址（线性探测），保存合约代码的64位哈希和条目槽号+1，0表示空桶。只有网关写入：先写条目，再写桶的哈希，最后以release写槽号。
+// 读取进程：
+//   auto block = segment.find<char>(kInsIndexName);
+//   auto* header = reinterpret_cast<const InsIndexHeader*>(block.first);
+//   int slot = ins_index_find(header, ins_index_hash("SHFE.rb2501"), "SHFE.rb2501");   // 哈希可预先算好
+//   const Instrument& instrument = ins_index_entries(header)[slot].instrument;
+
+const uint64_t kInsIndexMagic = 0x31304949444d4151ULL;   // "QAMDII01"
+const uint32_t kInsIndexVersion = 1;
+const char* const kInsIndexName = "InsIndex";
+
+struct InsIndexHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t capacity;                      // 最多容纳的合约数
+    uint32_t bucket_count;                  // 2的幂，不小于capacity的2倍
+    uint32_t entry_size;
+    std::atomic<uint32_t> count;            // 已使用的条目数，条目先于计数写入
+};
+
+struct InsIndexEntry {
+    uint64_t hash;
+    InsMapKeyType key;
+    Instrument instrument;
+};
+
+struct InsIndexBucket {
+    uint64_t hash;
+    std::atomic<uint32_t> slot;             // 条目槽号+1，0为空桶
+    uint32_t reserved;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "instrument index requires lock-free 32-bit atomics");
+
+// FNV-1a，遇到'\0'或64字节截止
+inline uint64_t ins_index_hash(const char* key)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < sizeof(InsMapKeyType) && key[i] != '\0'; ++i) {
+        hash ^= static_cast<unsigned char>(key[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+inline size_t ins_index_size(uint32_t capacity, uint32_t bucket_count)
+{
+    return sizeof(InsIndexHeader) + static_cast<size_t>(capacity) * sizeof(InsIndexEntry) +
+           static_cast<size_t>(bucket_count) * sizeof(InsIndexBucket);
+}
+
+inline InsIndexEntry* ins_index_entries(InsIndexHeader* header)
+{
+    return reinterpret_cast<InsIndexEntry*>(reinterpret_cast<char*>(header) + sizeof(InsIndexHeader));
+}
+
+inline const InsIndexEntry* ins_index_entries(const InsIndexHeader* header)
+{
+    return reinterpret_cast<const InsIndexEntry*>(reinterpret_cast<const char*>(header) + sizeof(InsIndexHeader));
+}
+
+inline InsIndexBucket* ins_index_buckets(InsIndexHeader* header)
+{
+    return reinterpret_cast<InsIndexBucket*>(reinterpret_cast<char*>(ins_index_entries(header) + header->capacity));
+}
+
+inline const InsIndexBucket* ins_index_buckets(const InsIndexHeader* header)
+{
+    return reinterpret_cast<const InsIndexBucket*>(reinterpret_cast<const char*>(ins_index_entries(header) + header->capacity));
+}
+
+// 按预先算好的哈希查找条目槽号，未找到返回-1；不加锁
+inline int ins_index_find(const InsIndexHeader* header, uint64_t hash, const char* key)
+{
+    const InsIndexEntry* entries = ins_index_entries(header);
+    const InsIndexBucket* buckets = ins_index_buckets(header);
+    uint32_t mask = header->bucket_count - 1;
+    for (uint32_t i = 0, pos = static_cast<uint32_t>(hash) & mask; i < header->bucket_count; ++i, pos = (pos + 1) & mask) {
+        uint32_t slot = buckets[pos].slot.load(std::memory_order_acquire);
+        if (slot == 0) {
+            return -1;
+        }
+        if (buckets[pos].hash == hash && strncmp(entries[slot - 1].key.data(), key, sizeof(InsMapKeyType)) == 0) {
+            return static_cast<int>(slot - 1);
+        }
+    }
+    return -1;
+}
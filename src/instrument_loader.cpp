@@ -0,0 +1,410 @@
+/////////////////////////////////////////////////////////////////////////
+///@file instrument_loader.cpp
+///@brief	通过交易前置查询合约表实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "instrument_loader.h"
+#include "../libs/ThostFtdcTraderApi.h"
+#include <rapidjson/document.h>
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+
+namespace {
+
+// 查询用的交易SPI：连接后认证、登录，由调用线程在登录后发起查询，收集全部应答
+class QueryTraderSpi : public CThostFtdcTraderSpi
+{
+public:
+    QueryTraderSpi(const std::string& broker_id, const std::string& user_id, const std::string& password,
+                   const std::string& app_id, const std::string& auth_code,
+                   std::vector<InstrumentRecord>& instruments, std::mutex& mutex, std::condition_variable& cv)
+        : broker_id_(broker_id)
+        , user_id_(user_id)
+        , password_(password)
+        , app_id_(app_id)
+        , auth_code_(auth_code)
+        , instruments_(instruments)
+        , mutex_(mutex)
+        , cv_(cv)
+        , api_(nullptr)
+        , logged_in_(false)
+        , done_(false)
+    {
+    }
+
+    void attach(CThostFtdcTraderApi* api) { api_ = api; }
+
+    // 以下在持有mutex时调用
+    bool is_logged_in() const { return logged_in_; }
+    bool is_done() const { return done_; }
+    const std::string& get_error() const { return error_; }
+
+    void OnFrontConnected() override
+    {
+        if (auth_code_.empty()) {
+            login();
+            return;
+        }
+
+        CThostFtdcReqAuthenticateField req;
+        memset(&req, 0, sizeof(req));
+        strncpy(req.BrokerID, broker_id_.c_str(), sizeof(req.BrokerID) - 1);
+        strncpy(req.UserID, user_id_.c_str(), sizeof(req.UserID) - 1);
+        strncpy(req.AppID, app_id_.c_str(), sizeof(req.AppID) - 1);
+        strncpy(req.AuthCode, auth_code_.c_str(), sizeof(req.AuthCode) - 1);
+        if (api_->ReqAuthenticate(&req, 1) != 0) {
+            finish("authenticate request failed");
+        }
+    }
+
+    void OnFrontDisconnected(int nReason) override
+    {
+        finish("front disconnected: " + std::to_string(nReason));
+    }
+
+    void OnRspAuthenticate(CThostFtdcRspAuthenticateField*, CThostFtdcRspInfoField* pRspInfo,
+                           int, bool) override
+    {
+        if (pRspInfo && pRspInfo->ErrorID != 0) {
+            finish("authenticate failed: " + std::to_string(pRspInfo->ErrorID));
+            return;
+        }
+        login();
+    }
+
+    void OnRspUserLogin(CThostFtdcRspUserLoginField*, CThostFtdcRspInfoField* pRspInfo,
+                        int, bool) override
+    {
+        if (pRspInfo && pRspInfo->ErrorID != 0) {
+            finish("login failed: " + std::to_string(pRspInfo->ErrorID));
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        logged_in_ = true;
+        cv_.notify_all();
+    }
+
+    void OnRspQryInstrument(CThostFtdcInstrumentField* pInstrument, CThostFtdcRspInfoField* pRspInfo,
+                            int, bool bIsLast) override
+    {
+        if (pRspInfo && pRspInfo->ErrorID != 0) {
+            finish("query failed: " + std::to_string(pRspInfo->ErrorID));
+            return;
+        }
+
+        if (pInstrument && pInstrument->InstrumentID[0] != '\0') {
+            InstrumentRecord record;
+            record.exchange_id = pInstrument->ExchangeID;
+            record.instrument_id = pInstrument->InstrumentID;
+            record.product_id = pInstrument->ProductID;
+            record.product_class = pInstrument->ProductClass;
+            record.volume_multiple = pInstrument->VolumeMultiple;
+            record.price_tick = pInstrument->PriceTick;
+            record.expire_date = pInstrument->ExpireDate;
+            record.is_trading = pInstrument->IsTrading != 0;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            instruments_.push_back(std::move(record));
+        }
+
+        if (bIsLast) {
+            finish("");
+        }
+    }
+
+    void OnRspError(CThostFtdcRspInfoField* pRspInfo, int, bool) override
+    {
+        finish("error response: " + std::to_string(pRspInfo ? pRspInfo->ErrorID : -1));
+    }
+
+private:
+    void login()
+    {
+        CThostFtdcReqUserLoginField req;
+        memset(&req, 0, sizeof(req));
+        strncpy(req.BrokerID, broker_id_.c_str(), sizeof(req.BrokerID) - 1);
+        strncpy(req.UserID, user_id_.c_str(), sizeof(req.UserID) - 1);
+        strncpy(req.Password, password_.c_str(), sizeof(req.Password) - 1);
+        if (api_->ReqUserLogin(&req, 1) != 0) {
+            finish("login request failed");
+        }
+    }
+
+    void finish(const std::string& error)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (done_) {
+            return;
+        }
+        error_ = error;
+        done_ = true;
+        cv_.notify_all();
+    }
+
+    std::string broker_id_;
+    std::string user_id_;
+    std::string password_;
+    std::string app_id_;
+    std::string auth_code_;
+    std::vector<InstrumentRecord>& instruments_;
+    std::mutex& mutex_;
+    std::condition_variable& cv_;
+    CThostFtdcTraderApi* api_;
+    bool logged_in_;
+    bool done_;
+    std::string error_;
+};
+
+long long now_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+InstrumentLoader::InstrumentLoader(const MultiCTPConfig& config)
+    : front_addr_(config.instrument_trade_front)
+    , broker_id_(config.instrument_broker_id)
+    , user_id_(config.instrument_user_id)
+    , password_(config.instrument_password)
+    , app_id_(config.instrument_app_id)
+    , auth_code_(config.instrument_auth_code)
+    , cache_file_(config.instrument_cache_file)
+    , cache_max_age_hours_(config.instrument_cache_max_age_hours)
+    , timeout_ms_(config.instrument_query_timeout_ms)
+{
+}
+
+bool InstrumentLoader::load(std::vector<InstrumentRecord>& instruments, std::string& source) const
+{
+    if (load_cache(instruments, false)) {
+        source = "cache";
+        return true;
+    }
+
+    std::string error;
+    if (query(instruments, error)) {
+        source = (cache_file_.empty() || save_cache(instruments)) ? "query" : "query (cache not saved)";
+        return true;
+    }
+
+    // 查询失败时使用过期的缓存，总比空合约表好
+    if (load_cache(instruments, true)) {
+        source = "stale cache (query failed: " + error + ")";
+        return true;
+    }
+
+    source = error;
+    return false;
+}
+
+bool InstrumentLoader::query(std::vector<InstrumentRecord>& instruments, std::string& error) const
+{
+    instruments.clear();
+    if (front_addr_.empty()) {
+        error = "no trade front configured";
+        return false;
+    }
+
+    std::string flow_path = "./ctpflow/instrument/";
+    std::error_code ec;
+    std::filesystem::create_directories(flow_path, ec);
+    if (ec) {
+        error = "failed to create flow directory: " + ec.message();
+        return false;
+    }
+
+    CThostFtdcTraderApi* api = CThostFtdcTraderApi::CreateFtdcTraderApi(flow_path.c_str());
+    if (!api) {
+        error = "failed to create trader api";
+        return false;
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<InstrumentRecord> received;
+    QueryTraderSpi spi(broker_id_, user_id_, password_, app_id_, auth_code_, received, mutex, cv);
+    spi.attach(api);
+    api->RegisterSpi(&spi);
+    api->RegisterFront(const_cast<char*>(front_addr_.c_str()));
+    api->SubscribePublicTopic(THOST_TERT_QUICK);
+    api->SubscribePrivateTopic(THOST_TERT_QUICK);
+    api->Init();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms_);
+    bool requested = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!spi.is_done()) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                error = requested ? "query timeout" : "login timeout";
+                break;
+            }
+
+            if (spi.is_logged_in() && !requested) {
+                // 查询在调用线程发起，被查询流控拒绝(-2/-3)时1秒后重试
+                lock.unlock();
+                CThostFtdcQryInstrumentField req;
+                memset(&req, 0, sizeof(req));
+                int result = api->ReqQryInstrument(&req, 2);
+                lock.lock();
+                if (result == 0) {
+                    requested = true;
+                } else {
+                    cv.wait_until(lock, std::min(deadline, now + std::chrono::seconds(1)),
+                                  [&spi]() { return spi.is_done(); });
+                }
+                continue;
+            }
+
+            cv.wait_until(lock, deadline, [&spi, requested]() {
+                return spi.is_done() || (spi.is_logged_in() && !requested);
+            });
+        }
+        if (spi.is_done() && !spi.get_error().empty()) {
+            error = spi.get_error();
+        }
+    }
+
+    api->RegisterSpi(nullptr);
+    api->Release();
+
+    if (!error.empty()) {
+        return false;
+    }
+    if (received.empty()) {
+        error = "no instruments returned";
+        return false;
+    }
+    instruments.swap(received);
+    return true;
+}
+
+bool InstrumentLoader::load_cache(std::vector<InstrumentRecord>& instruments, bool allow_stale) const
+{
+    if (cache_file_.empty()) {
+        return false;
+    }
+
+    std::ifstream file(cache_file_);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    rapidjson::Document doc;
+    doc.Parse(content.c_str());
+    if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("instruments") || !doc["instruments"].IsArray()) {
+        return false;
+    }
+
+    if (!allow_stale) {
+        if (!doc.HasMember("saved_at") || !doc["saved_at"].IsInt64()) {
+            return false;
+        }
+        long long age_ms = now_ms() - doc["saved_at"].GetInt64();
+        if (age_ms < 0 || age_ms >= static_cast<long long>(cache_max_age_hours_) * 3600 * 1000) {
+            return false;
+        }
+        // 换了交易前置（如仿真切到实盘）时缓存作废
+        if (!doc.HasMember("trade_front") || !doc["trade_front"].IsString() ||
+            front_addr_ != doc["trade_front"].GetString()) {
+            return false;
+        }
+    }
+
+    std::vector<InstrumentRecord> loaded;
+    for (const auto& item : doc["instruments"].GetArray()) {
+        if (!item.IsObject() || !item.HasMember("instrument_id") || !item["instrument_id"].IsString() ||
+            !item.HasMember("exchange_id") || !item["exchange_id"].IsString()) {
+            continue;
+        }
+        InstrumentRecord record;
+        record.exchange_id = item["exchange_id"].GetString();
+        record.instrument_id = item["instrument_id"].GetString();
+        if (item.HasMember("product_id") && item["product_id"].IsString()) {
+            record.product_id = item["product_id"].GetString();
+        }
+        if (item.HasMember("product_class") && item["product_class"].IsString() &&
+            item["product_class"].GetStringLength() == 1) {
+            record.product_class = item["product_class"].GetString()[0];
+        }
+        if (item.HasMember("volume_multiple") && item["volume_multiple"].IsInt()) {
+            record.volume_multiple = item["volume_multiple"].GetInt();
+        }
+        if (item.HasMember("price_tick") && item["price_tick"].IsNumber()) {
+            record.price_tick = item["price_tick"].GetDouble();
+        }
+        if (item.HasMember("expire_date") && item["expire_date"].IsString()) {
+            record.expire_date = item["expire_date"].GetString();
+        }
+        if (item.HasMember("is_trading") && item["is_trading"].IsBool()) {
+            record.is_trading = item["is_trading"].GetBool();
+        }
+        loaded.push_back(std::move(record));
+    }
+
+    if (loaded.empty()) {
+        return false;
+    }
+    instruments.swap(loaded);
+    return true;
+}
+
+bool InstrumentLoader::save_cache(const std::vector<InstrumentRecord>& instruments) const
+{
+    rapidjson::Document doc;
+    doc.SetObject();
+    auto& allocator = doc.GetAllocator();
+
+    rapidjson::Value items(rapidjson::kArrayType);
+    for (const auto& record : instruments) {
+        rapidjson::Value item(rapidjson::kObjectType);
+        char product_class[2] = {record.product_class, '\0'};
+        item.AddMember("exchange_id", rapidjson::Value(record.exchange_id.c_str(), allocator), allocator);
+        item.AddMember("instrument_id", rapidjson::Value(record.instrument_id.c_str(), allocator), allocator);
+        item.AddMember("product_id", rapidjson::Value(record.product_id.c_str(), allocator), allocator);
+        item.AddMember("product_class", rapidjson::Value(product_class, allocator), allocator);
+        item.AddMember("volume_multiple", record.volume_multiple, allocator);
+        item.AddMember("price_tick", record.price_tick, allocator);
+        item.AddMember("expire_date", rapidjson::Value(record.expire_date.c_str(), allocator), allocator);
+        item.AddMember("is_trading", record.is_trading, allocator);
+        items.PushBack(item, allocator);
+    }
+
+    doc.AddMember("saved_at", static_cast<int64_t>(now_ms()), allocator);
+    doc.AddMember("trade_front", rapidjson::Value(front_addr_.c_str(), allocator), allocator);
+    doc.AddMember("instruments", items, allocator);
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    doc.Accept(writer);
+
+    // 先写临时文件再改名，避免进程中断留下不完整的缓存
+    std::string tmp_file = cache_file_ + ".tmp";
+    {
+        std::ofstream file(tmp_file, std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file << buffer.GetString();
+        if (!file.good()) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_file, cache_file_, ec);
+    return !ec;
+}
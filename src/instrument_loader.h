@@ -0,0 +1,52 @@
+/////////////////////////////////////////////////////////////////////////
+///@file instrument_loader.h
+///@brief	通过交易前置查询合约表（带本地缓存）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "multi_ctp_config.h"
+#include <string>
+#include <vector>
+
+// 一个合约的基础信息
+struct InstrumentRecord {
+    std::string exchange_id;
+    std::string instrument_id;     // CTP合约代码，不带交易所前缀
+    std::string product_id;
+    char product_class = '1';      // CTP ProductClass（THOST_FTDC_PC_*）
+    int volume_multiple = 0;
+    double price_tick = 0.0;
+    std::string expire_date;
+    bool is_trading = true;
+};
+
+// 合约表加载器
+// 登录配置的交易前置（可选看穿式认证）后执行一次全量ReqQryInstrument，结果写入缓存文件；
+// 缓存未过期时直接读取缓存，查询失败时退回过期的缓存。
+class InstrumentLoader
+{
+public:
+    explicit InstrumentLoader(const MultiCTPConfig& config);
+
+    // 加载合约表，source返回数据来源（"cache"/"query"/"stale cache"），失败时返回错误信息
+    bool load(std::vector<InstrumentRecord>& instruments, std::string& source) const;
+
+    // 查询交易前置，阻塞到最后一条应答或超时
+    bool query(std::vector<InstrumentRecord>& instruments, std::string& error) const;
+
+    bool load_cache(std::vector<InstrumentRecord>& instruments, bool allow_stale) const;
+    bool save_cache(const std::vector<InstrumentRecord>& instruments) const;
+
+private:
+    std::string front_addr_;
+    std::string broker_id_;
+    std::string user_id_;
+    std::string password_;
+    std::string app_id_;
+    std::string auth_code_;
+    std::string cache_file_;
+    int cache_max_age_hours_;
+    int timeout_ms_;
+};
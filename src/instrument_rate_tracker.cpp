@@ -0,0 +1,137 @@
+/////////////////////////////////////////////////////////////////////////
+///@file instrument_rate_tracker.cpp
+///@brief	合约行情频率统计实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "instrument_rate_tracker.h"
+#include <functional>
+
+InstrumentRateTracker::InstrumentRateTracker(double alpha, uint32_t capacity)
+    : alpha_(alpha)
+    , last_sample_(std::chrono::steady_clock::now())
+    , slots_(new RateSlot[capacity])
+    , capacity_(capacity)
+    , size_(0)
+{
+    uint32_t bucket_count = 1;
+    while (bucket_count < capacity * 2u) {
+        bucket_count <<= 1;
+    }
+    buckets_.reset(new std::atomic<uint32_t>[bucket_count]);
+    for (uint32_t i = 0; i < bucket_count; ++i) {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+    bucket_mask_ = bucket_count - 1;
+}
+
+int InstrumentRateTracker::find(size_t hash, const std::string& instrument_id) const
+{
+    uint32_t pos = static_cast<uint32_t>(hash) & bucket_mask_;
+    while (true) {
+        uint32_t slot = buckets_[pos].load(std::memory_order_acquire);
+        if (slot == 0) {
+            return -1;
+        }
+        const RateSlot& entry = slots_[slot - 1];
+        if (entry.hash == hash && entry.instrument_id == instrument_id) {
+            return static_cast<int>(slot - 1);
+        }
+        pos = (pos + 1) & bucket_mask_;
+    }
+}
+
+int InstrumentRateTracker::add_instrument(const std::string& instrument_id)
+{
+    size_t hash = std::hash<std::string>()(instrument_id);
+    int slot = find(hash, instrument_id);
+    if (slot < 0) {
+        uint32_t next = size_.load(std::memory_order_relaxed);
+        if (next >= capacity_) {
+            return -1;
+        }
+        RateSlot& entry = slots_[next];
+        entry.hash = hash;
+        entry.instrument_id = instrument_id;
+        
+        uint32_t pos = static_cast<uint32_t>(hash) & bucket_mask_;
+        while (buckets_[pos].load(std::memory_order_relaxed) != 0) {
+            pos = (pos + 1) & bucket_mask_;
+        }
+        // 条目内容先于桶发布，行情线程经acquire读到桶时即可见
+        buckets_[pos].store(next + 1, std::memory_order_release);
+        size_.store(next + 1, std::memory_order_release);
+        slot = static_cast<int>(next);
+    }
+    
+    RateSlot& entry = slots_[slot];
+    if (!entry.active.load(std::memory_order_relaxed)) {
+        entry.count.store(0, std::memory_order_relaxed);
+        entry.ewma.store(0.0, std::memory_order_relaxed);
+        entry.sampled = false;
+        entry.active.store(true, std::memory_order_relaxed);
+    }
+    return slot;
+}
+
+void InstrumentRateTracker::on_tick(const std::string& instrument_id)
+{
+    int slot = find(std::hash<std::string>()(instrument_id), instrument_id);
+    if (slot >= 0) {
+        slots_[slot].count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void InstrumentRateTracker::sample()
+{
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - last_sample_).count();
+    last_sample_ = now;
+    if (elapsed <= 0.0) {
+        return;
+    }
+
+    uint32_t size = size_.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < size; ++i) {
+        RateSlot& entry = slots_[i];
+        uint64_t count = entry.count.exchange(0, std::memory_order_relaxed);
+        if (!entry.active.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        double rate = count / elapsed;
+        double ewma = entry.ewma.load(std::memory_order_relaxed);
+        entry.ewma.store(entry.sampled ? ewma + alpha_ * (rate - ewma) : rate, std::memory_order_relaxed);
+        entry.sampled = true;
+    }
+}
+
+double InstrumentRateTracker::get_rate(const std::string& instrument_id) const
+{
+    int slot = find(std::hash<std::string>()(instrument_id), instrument_id);
+    if (slot < 0 || !slots_[slot].active.load(std::memory_order_relaxed)) {
+        return 0.0;
+    }
+    return slots_[slot].ewma.load(std::memory_order_relaxed);
+}
+
+std::map<std::string, double> InstrumentRateTracker::get_rates() const
+{
+    std::map<std::string, double> rates;
+    uint32_t size = size_.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < size; ++i) {
+        const RateSlot& entry = slots_[i];
+        if (entry.active.load(std::memory_order_relaxed)) {
+            rates[entry.instrument_id] = entry.ewma.load(std::memory_order_relaxed);
+        }
+    }
+    return rates;
+}
+
+void InstrumentRateTracker::remove_instrument(const std::string& instrument_id)
+{
+    int slot = find(std::hash<std::string>()(instrument_id), instrument_id);
+    if (slot >= 0) {
+        slots_[slot].active.store(false, std::memory_order_relaxed);
+        slots_[slot].ewma.store(0.0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,61 @@
+/////////////////////////////////////////////////////////////////////////
+///@file instrument_rate_tracker.h
+///@brief	合约行情频率统计
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+
+// 合约行情频率统计
+// 订阅创建时由事件循环登记合约，得到一个稳定的计数槽；行情线程按开放寻址表无锁查到计数槽后
+// 原子加一，未登记的合约不计数。事件循环每秒调用sample()交换出计数并折算为条/秒的EWMA。
+// 槽只增不删：退订后保留计数槽，重新订阅时复用，行情线程读到的槽始终有效。
+class InstrumentRateTracker
+{
+public:
+    explicit InstrumentRateTracker(double alpha = 0.2, uint32_t capacity = 65536);
+
+    // 登记合约并返回槽号，已登记时返回原槽号；表满时返回-1。仅由事件循环调用
+    int add_instrument(const std::string& instrument_id);
+
+    // 行情线程调用，不加锁
+    void on_tick(const std::string& instrument_id);
+
+    // 按距上次采样的时间折算频率并更新EWMA，建议每秒调用一次；仅由事件循环调用
+    void sample();
+
+    // 合约的EWMA频率（条/秒），未知合约返回0
+    double get_rate(const std::string& instrument_id) const;
+    std::map<std::string, double> get_rates() const;
+
+    // 停止统计该合约并清零频率，计数槽留待复用；仅由事件循环调用
+    void remove_instrument(const std::string& instrument_id);
+
+private:
+    struct RateSlot {
+        size_t hash = 0;
+        std::string instrument_id;
+        std::atomic<uint64_t> count{0};      // 本采样周期内的tick数
+        std::atomic<double> ewma{0.0};
+        std::atomic<bool> active{false};
+        bool sampled = false;
+    };
+
+    int find(size_t hash, const std::string& instrument_id) const;
+
+    double alpha_;
+    std::chrono::steady_clock::time_point last_sample_;
+    std::unique_ptr<RateSlot[]> slots_;
+    uint32_t capacity_;
+    std::atomic<uint32_t> size_;
+    // 槽号+1，0为空桶；桶数为容量两倍以上的2的幂
+    std::unique_ptr<std::atomic<uint32_t>[]> buckets_;
+    uint32_t bucket_mask_;
+};
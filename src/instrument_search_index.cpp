@@ -0,0 +1,193 @@
+/////////////////////////////////////////////////////////////////////////
+///@file instrument_search_index.cpp
+///@brief	合约搜索索引实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "instrument_search_index.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+enum MatchRank {
+    kRankExact = 0,
+    kRankSymbolPrefix = 1,
+    kRankPrefix = 2,
+    kRankSubstring = 3
+};
+
+std::string to_lower(const std::string& text)
+{
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lower;
+}
+
+uint32_t trigram_at(const std::string& text, size_t pos)
+{
+    return (static_cast<uint32_t>(static_cast<unsigned char>(text[pos])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 1])) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 2]));
+}
+
+// 合约部分：SHFE.rb2501 -> rb2501，没有交易所前缀时为整个代码
+size_t symbol_offset(const std::string& instrument)
+{
+    size_t dot = instrument.find('.');
+    return dot == std::string::npos ? 0 : dot + 1;
+}
+
+} // namespace
+
+InstrumentSearchIndex::InstrumentSearchIndex()
+    : snapshot_(std::make_shared<Snapshot>())
+{
+}
+
+void InstrumentSearchIndex::rebuild(const std::vector<std::string>& instruments)
+{
+    std::lock_guard<std::mutex> lock(rebuild_mutex_);
+    
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->instruments = instruments;
+    snapshot->lower_instruments.reserve(instruments.size());
+    snapshot->prefix_keys.reserve(instruments.size() * 2);
+    
+    for (uint32_t id = 0; id < instruments.size(); ++id) {
+        std::string lower = to_lower(instruments[id]);
+        size_t offset = symbol_offset(lower);
+        snapshot->prefix_keys.emplace_back(lower, id);
+        if (offset > 0) {
+            snapshot->prefix_keys.emplace_back(lower.substr(offset), id);
+        }
+        for (size_t pos = 0; pos + 3 <= lower.size(); ++pos) {
+            std::vector<uint32_t>& postings = snapshot->trigrams[trigram_at(lower, pos)];
+            if (postings.empty() || postings.back() != id) {
+                postings.push_back(id);
+            }
+        }
+        snapshot->lower_instruments.push_back(std::move(lower));
+    }
+    std::sort(snapshot->prefix_keys.begin(), snapshot->prefix_keys.end());
+    
+    std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+}
+
+size_t InstrumentSearchIndex::size() const
+{
+    return std::atomic_load(&snapshot_)->instruments.size();
+}
+
+std::vector<std::string> InstrumentSearchIndex::search(const std::string& pattern, size_t offset, size_t limit,
+                                                       size_t* total) const
+{
+    std::vector<std::string> results;
+    if (total) {
+        *total = 0;
+    }
+    if (pattern.empty()) {
+        return results;
+    }
+    
+    std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&snapshot_);
+    std::string lower_pattern = to_lower(pattern);
+    
+    // 合约编号 -> 最好的匹配档次
+    std::unordered_map<uint32_t, int> ranks;
+    auto add_match = [&ranks](uint32_t id, int rank) {
+        auto it = ranks.find(id);
+        if (it == ranks.end()) {
+            ranks.emplace(id, rank);
+        } else if (rank < it->second) {
+            it->second = rank;
+        }
+    };
+    
+    // 前缀：有序键上二分定位
+    auto it = std::lower_bound(snapshot->prefix_keys.begin(), snapshot->prefix_keys.end(),
+                               std::make_pair(lower_pattern, static_cast<uint32_t>(0)));
+    for (; it != snapshot->prefix_keys.end() && it->first.compare(0, lower_pattern.size(), lower_pattern) == 0; ++it) {
+        const std::string& lower = snapshot->lower_instruments[it->second];
+        bool is_symbol_key = it->first.size() < lower.size();
+        int rank = is_symbol_key ? kRankSymbolPrefix : kRankPrefix;
+        if (it->first.size() == lower_pattern.size()) {
+            rank = kRankExact;
+        }
+        add_match(it->second, rank);
+    }
+    
+    // 子串：三个字符以上取各三元组倒排表的交集再逐个确认，更短的模式直接扫描小写代码
+    if (lower_pattern.size() >= 3) {
+        const std::vector<uint32_t>* shortest = nullptr;
+        std::vector<const std::vector<uint32_t>*> lists;
+        for (size_t pos = 0; pos + 3 <= lower_pattern.size(); ++pos) {
+            auto found = snapshot->trigrams.find(trigram_at(lower_pattern, pos));
+            if (found == snapshot->trigrams.end()) {
+                lists.clear();
+                shortest = nullptr;
+                break;
+            }
+            lists.push_back(&found->second);
+            if (!shortest || found->second.size() < shortest->size()) {
+                shortest = &found->second;
+            }
+        }
+        if (shortest) {
+            for (uint32_t id : *shortest) {
+                bool in_all = true;
+                for (const auto* list : lists) {
+                    if (list != shortest && !std::binary_search(list->begin(), list->end(), id)) {
+                        in_all = false;
+                        break;
+                    }
+                }
+                if (in_all && snapshot->lower_instruments[id].find(lower_pattern) != std::string::npos) {
+                    add_match(id, kRankSubstring);
+                }
+            }
+        }
+    } else {
+        for (uint32_t id = 0; id < snapshot->lower_instruments.size(); ++id) {
+            if (snapshot->lower_instruments[id].find(lower_pattern) != std::string::npos) {
+                add_match(id, kRankSubstring);
+            }
+        }
+    }
+    
+    std::vector<std::pair<int, uint32_t>> ranked;
+    ranked.reserve(ranks.size());
+    for (const auto& item : ranks) {
+        ranked.emplace_back(item.second, item.first);
+    }
+    
+    size_t end = ranked.size();
+    if (limit > 0) {
+        end = std::min(ranked.size(), offset + limit);
+    }
+    auto less = [&snapshot](const std::pair<int, uint32_t>& a, const std::pair<int, uint32_t>& b) {
+        if (a.first != b.first) {
+            return a.first < b.first;
+        }
+        const std::string& ka = snapshot->instruments[a.second];
+        const std::string& kb = snapshot->instruments[b.second];
+        if (ka.size() != kb.size()) {
+            return ka.size() < kb.size();
+        }
+        return ka < kb;
+    };
+    // 只需排出请求的这一页
+    if (offset < end) {
+        std::partial_sort(ranked.begin(), ranked.begin() + end, ranked.end(), less);
+        results.reserve(end - offset);
+        for (size_t i = offset; i < end; ++i) {
+            results.push_back(snapshot->instruments[ranked[i].second]);
+        }
+    }
+    
+    if (total) {
+        *total = ranked.size();
+    }
+    return results;
+}
@@ -0,0 +1,45 @@
+/////////////////////////////////////////////////////////////////////////
+///@file instrument_search_index.h
+///@brief	合约搜索索引（前缀与子串）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 合约代码搜索：小写键的有序数组做前缀查找，三元组倒排表做子串查找。
+// 合约表变化时整体重建并以atomic_store替换，查询线程用atomic_load取得只读快照，不加锁。
+// 排序：完全匹配 > 合约部分前缀（rb匹配SHFE.rb2501）> 完整代码前缀（shfe.rb）> 子串，同档内短代码在前、再按字母序。
+class InstrumentSearchIndex
+{
+public:
+    InstrumentSearchIndex();
+
+    // 用完整合约列表重建索引；多个线程同时重建时串行执行，不合并，去重由调用方负责
+    void rebuild(const std::vector<std::string>& instruments);
+
+    // 构建快照时的合约数，用于判断合约表是否已变化
+    size_t size() const;
+
+    // 返回第offset条起最多limit条（limit为0表示全部），total返回匹配总数；模式为空时返回空
+    std::vector<std::string> search(const std::string& pattern, size_t offset, size_t limit, size_t* total = nullptr) const;
+
+private:
+    struct Snapshot {
+        std::vector<std::string> instruments;           // 原始代码，下标即合约编号
+        std::vector<std::string> lower_instruments;     // 对应的小写代码
+        // 有序的 (小写键, 合约编号)：每个合约有完整代码和去掉交易所前缀后的合约部分两个键
+        std::vector<std::pair<std::string, uint32_t>> prefix_keys;
+        // 三元组 -> 升序合约编号
+        std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams;
+    };
+
+    std::shared_ptr<const Snapshot> snapshot_;
+    std::mutex rebuild_mutex_;
+};
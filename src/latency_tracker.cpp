@@ -0,0 +1,162 @@
+/////////////////////////////////////////////////////////////////////////
+///@file latency_tracker.cpp
+///@brief	前置行情延迟统计实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "latency_tracker.h"
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <cstring>
+
+const double LatencyTracker::kMaxLatencyMs = 60000.0;
+const double LatencyTracker::kMinLatencyMs = -5000.0;
+const double LatencyTracker::kEwmaAlpha = 0.05;
+
+LatencyTracker::LatencyTracker()
+    : samples_(0)
+    , discarded_(0)
+    , ewma_ms_(0.0)
+    , max_ms_(0.0)
+{
+    for (int i = 0; i < kBucketCount; ++i) {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyTracker::record(const CThostFtdcDepthMarketDataField& md)
+{
+    if (strnlen(md.UpdateTime, sizeof(md.UpdateTime)) < 8) {
+        discarded_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    record(exchange_latency_ms(md));
+}
+
+void LatencyTracker::record(double latency_ms)
+{
+    if (latency_ms > kMaxLatencyMs || latency_ms < kMinLatencyMs) {
+        discarded_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // 本机时钟略慢于交易所时出现负值，按0计
+    if (latency_ms < 0.0) {
+        latency_ms = 0.0;
+    }
+
+    buckets_[bucket_of(latency_ms)].fetch_add(1, std::memory_order_relaxed);
+
+    // 单写者，load/store即可
+    uint64_t count = samples_.load(std::memory_order_relaxed);
+    double ewma = ewma_ms_.load(std::memory_order_relaxed);
+    ewma_ms_.store(count == 0 ? latency_ms : ewma + kEwmaAlpha * (latency_ms - ewma), std::memory_order_relaxed);
+    if (latency_ms > max_ms_.load(std::memory_order_relaxed)) {
+        max_ms_.store(latency_ms, std::memory_order_relaxed);
+    }
+    samples_.store(count + 1, std::memory_order_release);
+}
+
+LatencySnapshot LatencyTracker::snapshot() const
+{
+    LatencySnapshot snap;
+    snap.samples = samples_.load(std::memory_order_acquire);
+    snap.discarded = discarded_.load(std::memory_order_relaxed);
+    snap.ewma_ms = ewma_ms_.load(std::memory_order_relaxed);
+    snap.max_ms = max_ms_.load(std::memory_order_relaxed);
+
+    uint64_t counts[kBucketCount];
+    uint64_t total = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    snap.p50_ms = percentile(counts, total, 0.50);
+    snap.p90_ms = percentile(counts, total, 0.90);
+    snap.p99_ms = percentile(counts, total, 0.99);
+    return snap;
+}
+
+namespace {
+
+// 本地当日零点（epoch毫秒）与下一个零点，跨日时由第一个看到的行情线程用localtime_r重算一次；
+// 两个值分开读写，跨日瞬间读到新旧混合时只影响当笔延迟
+std::atomic<long long> g_local_day_start_ms(0);
+std::atomic<long long> g_local_day_end_ms(0);
+
+long long local_ms_of_day(long long epoch_ms)
+{
+    long long day_start = g_local_day_start_ms.load(std::memory_order_relaxed);
+    if (epoch_ms >= day_start && epoch_ms < g_local_day_end_ms.load(std::memory_order_relaxed)) {
+        return epoch_ms - day_start;
+    }
+
+    std::time_t now_t = static_cast<std::time_t>(epoch_ms / 1000);
+    std::tm local_tm;
+    localtime_r(&now_t, &local_tm);
+    long long ms_of_day = ((local_tm.tm_hour * 60LL + local_tm.tm_min) * 60 + local_tm.tm_sec) * 1000 + epoch_ms % 1000;
+    day_start = epoch_ms - ms_of_day;
+    g_local_day_start_ms.store(day_start, std::memory_order_relaxed);
+    g_local_day_end_ms.store(day_start + 24LL * 3600 * 1000, std::memory_order_relaxed);
+    return ms_of_day;
+}
+
+} // namespace
+
+double LatencyTracker::exchange_latency_ms(const CThostFtdcDepthMarketDataField& md)
+{
+    // 本地当日毫秒数（UpdateTime为交易所本地时间，假定服务器时区与交易所一致）；
+    // 当日零点缓存，localtime_r（glibc时区锁）每天只调用一次
+    long long now_ms = local_ms_of_day(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    const char* t = md.UpdateTime;
+    long long exchange_ms = (((t[0] - '0') * 10 + (t[1] - '0')) * 3600LL +
+                             ((t[3] - '0') * 10 + (t[4] - '0')) * 60LL +
+                             ((t[6] - '0') * 10 + (t[7] - '0'))) * 1000 + md.UpdateMillisec;
+
+    // 夜盘跨零点回绕
+    const long long kDayMs = 24LL * 3600 * 1000;
+    long long diff = now_ms - exchange_ms;
+    if (diff < -kDayMs / 2) {
+        diff += kDayMs;
+    } else if (diff > kDayMs / 2) {
+        diff -= kDayMs;
+    }
+    return static_cast<double>(diff);
+}
+
+int LatencyTracker::bucket_of(double latency_ms)
+{
+    if (latency_ms <= 0.1) {
+        return 0;
+    }
+    int bucket = static_cast<int>(std::ceil(std::log(latency_ms / 0.1) / std::log(1.25)));
+    return bucket >= kBucketCount ? kBucketCount - 1 : bucket;
+}
+
+double LatencyTracker::bucket_upper_ms(int bucket)
+{
+    return 0.1 * std::pow(1.25, bucket);
+}
+
+double LatencyTracker::percentile(const uint64_t* counts, uint64_t total, double ratio) const
+{
+    if (total == 0) {
+        return 0.0;
+    }
+    uint64_t target = static_cast<uint64_t>(std::ceil(total * ratio));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        if (counts[i] > 0 && seen + counts[i] >= target) {
+            // 桶内线性插值
+            double lower = (i == 0) ? 0.0 : bucket_upper_ms(i - 1);
+            double fraction = static_cast<double>(target - seen) / counts[i];
+            double value = lower + (bucket_upper_ms(i) - lower) * fraction;
+            double max_ms = max_ms_.load(std::memory_order_relaxed);
+            return value < max_ms ? value : max_ms;
+        }
+        seen += counts[i];
+    }
+    return bucket_upper_ms(kBucketCount - 1);
+}
@@ -0,0 +1,59 @@
+/////////////////////////////////////////////////////////////////////////
+///@file latency_tracker.h
+///@brief	前置行情延迟统计（EWMA与分位数）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../libs/ThostFtdcUserApiStruct.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// 延迟统计快照
+struct LatencySnapshot {
+    size_t samples = 0;       // 有效样本数
+    size_t discarded = 0;     // 超出合理范围被丢弃的样本（登录快照、时钟异常等）
+    double ewma_ms = 0.0;     // 指数加权平均延迟
+    double p50_ms = 0.0;
+    double p90_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+// 行情延迟统计
+// 延迟 = 本地收到时间 - 交易所UpdateTime/UpdateMillisec（均为当日毫秒，跨零点回绕）。
+// 本机时钟与交易所的偏差对所有前置相同，因此绝对值仅供参考，前置之间的比较是可靠的。
+// 只由所属连接的行情线程写入，其它线程读取快照，全部使用原子变量，无锁。
+class LatencyTracker
+{
+public:
+    LatencyTracker();
+
+    // 记录一条行情的延迟
+    void record(const CThostFtdcDepthMarketDataField& md);
+    void record(double latency_ms);
+
+    LatencySnapshot snapshot() const;
+
+    // 计算单条行情相对交易所时间的延迟（毫秒）
+    static double exchange_latency_ms(const CThostFtdcDepthMarketDataField& md);
+
+private:
+    // 对数分桶：第i个桶上界为 0.1ms * 1.25^i，覆盖约0.1ms到60s
+    static const int kBucketCount = 64;
+    static const double kMaxLatencyMs;     // 超过该值视为快照/回放数据
+    static const double kMinLatencyMs;     // 低于该值视为时钟异常
+    static const double kEwmaAlpha;
+
+    static int bucket_of(double latency_ms);
+    static double bucket_upper_ms(int bucket);
+    double percentile(const uint64_t* counts, uint64_t total, double ratio) const;
+
+    std::atomic<uint64_t> buckets_[kBucketCount];
+    std::atomic<uint64_t> samples_;
+    std::atomic<uint64_t> discarded_;
+    std::atomic<double> ewma_ms_;
+    std::atomic<double> max_ms_;
+};
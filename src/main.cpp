@@ -6,6 +6,7 @@
 
 #include "market_data_server.h"
 #include "multi_ctp_config.h"
+#include "front_prober.h"
 #include <iostream>
 #include <signal.h>
 #include <thread>
@@ -32,7 +33,8 @@ void print_usage() {
     std::cout << "  Multi-CTP mode (recommended):" << std::endl;
     std::cout << "    --config <config_file>    Load multi-CTP configuration from JSON file" << std::endl;
     std::cout << "    --multi-ctp               Use default multi-CTP configuration (SimNow)" << std::endl;
-    std::cout << "    --strategy <strategy>     Load balance strategy: round_robin, least_connections, connection_quality, hash_based" << std::endl;
+    std::cout << "    --strategy <strategy>     Load balance strategy: round_robin, least_connections, connection_quality, hash_based, latency" << std::endl;
+    std::cout << "    --probe-fronts            Probe fronts in broker_data.json and use the fastest top-K" << std::endl;
     std::cout << std::endl;
     std::cout << "  Common options:" << std::endl;
     std::cout << "    --help                    Show this help message" << std::endl;
@@ -47,6 +49,7 @@ LoadBalanceStrategy parse_strategy(const std::string& strategy_str) {
     if (strategy_str == "least_connections") return LoadBalanceStrategy::LEAST_CONNECTIONS;
     if (strategy_str == "connection_quality") return LoadBalanceStrategy::CONNECTION_QUALITY;
     if (strategy_str == "hash_based") return LoadBalanceStrategy::HASH_BASED;
+    if (strategy_str == "latency") return LoadBalanceStrategy::LATENCY;
     return LoadBalanceStrategy::CONNECTION_QUALITY; // 默认策略
 }
 
@@ -61,6 +64,7 @@ int main(int argc, char* argv[]) {
     std::string config_file;
     LoadBalanceStrategy strategy = LoadBalanceStrategy::CONNECTION_QUALITY;
     bool show_status = false;
+    bool probe_fronts = false;
 
     // 解析命令行参数
     for (int i = 1; i < argc; i++) {
@@ -76,6 +80,9 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--config" && i + 1 < argc) {
             config_file = argv[++i];
             use_multi_ctp = true;
+        } else if (arg == "--probe-fronts") {
+            probe_fronts = true;
+            use_multi_ctp = true;
         } else if (arg == "--strategy" && i + 1 < argc) {
             strategy = parse_strategy(argv[++i]);
         } else if (arg == "--front-addr" && i + 1 < argc) {
@@ -129,6 +136,32 @@ int main(int argc, char* argv[]) {
                 }
             }
             
+            // 前置探测：用最快的前K个前置替换连接集合
+            if (probe_fronts || config.probe_fronts) {
+                std::vector<FrontCandidate> candidates;
+                if (!FrontProber::load_candidates(config.probe_broker_file, config.probe_brokers, candidates)) {
+                    std::cerr << "Front probe skipped: cannot load " << config.probe_broker_file << std::endl;
+                } else {
+                    FrontProber prober(config);
+                    auto results = prober.probe(candidates);
+                    
+                    CTPConnectionConfig template_config;
+                    if (!config.connections.empty()) {
+                        template_config = config.connections.front();
+                    }
+                    auto probed = prober.build_connections(results, template_config);
+                    prober.write_report(results, config.probe_report_file);
+                    
+                    if (probed.empty()) {
+                        std::cerr << "Front probe found no reachable front, keeping configured connections" << std::endl;
+                    } else {
+                        std::cout << "Front probe selected " << probed.size() << " of " << results.size()
+                                  << " fronts (report: " << config.probe_report_file << ")" << std::endl;
+                        config.connections = probed;
+                    }
+                }
+            }
+            
             // 验证配置
             if (!ConfigLoader::validate_config(config)) {
                 std::cerr << "Invalid configuration" << std::endl;
@@ -137,13 +170,22 @@ int main(int argc, char* argv[]) {
             
             std::cout << "Multi-CTP Mode Configuration:" << std::endl;
             std::cout << "  WebSocket:    ws://0.0.0.0:" << config.websocket_port << std::endl;
-            std::cout << "  Redis:        " << config.redis_host << ":" << config.redis_port << std::endl;
+            if (config.redis_endpoints.empty()) {
+                std::cout << "  Redis:        " << config.redis_host << ":" << config.redis_port << std::endl;
+            } else {
+                std::cout << "  Redis:        " << config.redis_endpoints.size() << " shards (";
+                for (size_t i = 0; i < config.redis_endpoints.size(); ++i) {
+                    std::cout << (i ? ", " : "") << config.redis_endpoints[i].host << ":" << config.redis_endpoints[i].port;
+                }
+                std::cout << ")" << std::endl;
+            }
             std::cout << "  Strategy:     ";
             switch (config.load_balance_strategy) {
                 case LoadBalanceStrategy::ROUND_ROBIN: std::cout << "Round Robin"; break;
                 case LoadBalanceStrategy::LEAST_CONNECTIONS: std::cout << "Least Connections"; break;
                 case LoadBalanceStrategy::CONNECTION_QUALITY: std::cout << "Connection Quality"; break;
                 case LoadBalanceStrategy::HASH_BASED: std::cout << "Hash Based"; break;
+                case LoadBalanceStrategy::LATENCY: std::cout << "Latency"; break;
             }
             std::cout << std::endl;
             std::cout << "  Connections:  " << config.connections.size() << " configured" << std::endl;
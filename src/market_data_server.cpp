@@ -5,6 +5,7 @@
 /////////////////////////////////////////////////////////////////////////
 
 #include "market_data_server.h"
+#include "instrument_loader.h"
 #include <iostream>
 #include <sstream>
 #include <cstring>
@@ -259,12 +260,14 @@ void WebSocketSession::handle_message(const std::string& message)
                         instruments.push_back(nohead_instrument);
                         subscriptions_.insert(nohead_instrument);
                         
-                        // 更新映射表和订阅者
+                        // 更新映射表
                         server_->noheadtohead_instruments_map_[nohead_instrument] = instrument;
-                        server_->subscribe_instrument(session_id_, nohead_instrument);  // 使用CTP格式订阅
                     }
                 }
                 
+                // 批量订阅（使用CTP格式）
+                server_->subscribe_instruments(session_id_, instruments);
+                
                 // 发送mdservice格式响应
                 rapidjson::Document response;
                 response.SetObject();
@@ -296,13 +299,16 @@ void WebSocketSession::handle_message(const std::string& message)
             }
             
             const auto& instruments = doc["instruments"].GetArray();
+            std::vector<std::string> instrument_ids;
+            instrument_ids.reserve(instruments.Size());
             for (const auto& inst : instruments) {
                 if (inst.IsString()) {
                     std::string instrument_id = inst.GetString();
                     subscriptions_.insert(instrument_id);
-                    server_->subscribe_instrument(session_id_, instrument_id);
+                    instrument_ids.push_back(instrument_id);
                 }
             }
+            server_->subscribe_instruments(session_id_, instrument_ids);
             
             rapidjson::Document response;
             response.SetObject();
@@ -320,13 +326,16 @@ void WebSocketSession::handle_message(const std::string& message)
             }
             
             const auto& instruments = doc["instruments"].GetArray();
+            std::vector<std::string> instrument_ids;
+            instrument_ids.reserve(instruments.Size());
             for (const auto& inst : instruments) {
                 if (inst.IsString()) {
                     std::string instrument_id = inst.GetString();
                     subscriptions_.erase(instrument_id);
-                    server_->unsubscribe_instrument(session_id_, instrument_id);
+                    instrument_ids.push_back(instrument_id);
                 }
             }
+            server_->unsubscribe_instruments(session_id_, instrument_ids);
             
             rapidjson::Document response;
             response.SetObject();
@@ -361,7 +370,16 @@ void WebSocketSession::handle_message(const std::string& message)
             }
             
             std::string pattern = doc["pattern"].GetString();
-            auto instruments = server_->search_instruments(pattern);
+            size_t offset = 0;
+            size_t limit = 0;
+            if (doc.HasMember("offset") && doc["offset"].IsUint()) {
+                offset = doc["offset"].GetUint();
+            }
+            if (doc.HasMember("limit") && doc["limit"].IsUint()) {
+                limit = doc["limit"].GetUint();
+            }
+            size_t total = 0;
+            auto instruments = server_->search_instruments(pattern, offset, limit, &total);
             
             rapidjson::Document response;
             response.SetObject();
@@ -375,9 +393,23 @@ void WebSocketSession::handle_message(const std::string& message)
             }
             response.AddMember("instruments", inst_array, allocator);
             response.AddMember("count", static_cast<int>(instruments.size()), allocator);
+            response.AddMember("total", static_cast<uint64_t>(total), allocator);
+            response.AddMember("offset", static_cast<uint64_t>(offset), allocator);
             
             send_response("search_result", response);
             
+        } else if (action == "get_metrics") {
+            rapidjson::Document response;
+            response.SetObject();
+            auto& allocator = response.GetAllocator();
+            response.AddMember("type", "metrics", allocator);
+            response.AddMember("connections", server_->get_connection_metrics(allocator), allocator);
+            response.AddMember("startup_login_ms", server_->get_startup_login_ms(), allocator);
+            response.AddMember("dispatcher", server_->get_dispatcher_metrics(allocator), allocator);
+            response.AddMember("tick_ring", server_->get_tick_ring_metrics(allocator), allocator);
+            
+            send_response("metrics", response);
+            
         } else {
             send_error("Unknown action: " + action);
         }
@@ -514,277 +546,10 @@ rapidjson::Value MarketDataServer::build_quote_data(CThostFtdcDepthMarketDataFie
                                                      rapidjson::Document::AllocatorType& allocator,
                                                      long long& timestamp_ms)
 {
-    rapidjson::Value inst_data(rapidjson::kObjectType);
-    
-    // 1. instrument_id
-    inst_data.AddMember("instrument_id", rapidjson::Value(display_instrument.c_str(), allocator), allocator);
-    
-    // 2. datetime - 合并trading_day和update_time
-    std::string datetime_str;
-    {
-        std::string trading_day = pDepthMarketData->TradingDay;
-        std::string update_time = pDepthMarketData->UpdateTime;
-        int update_millisec = pDepthMarketData->UpdateMillisec;
-
-        // 格式化为 YYYY-MM-DD HH:MM:SS.xxxxx （秒后5位），容错短字符串
-        if (update_time.empty()) {
-            update_time = "00:00:00";
-        }
-
-        std::string date_part;
-        if (trading_day.size() >= 8) {
-            date_part = trading_day.substr(0, 4) + "-" +
-                        trading_day.substr(4, 2) + "-" +
-                        trading_day.substr(6, 2);
-        } else {
-            date_part = trading_day; // 保留原始值，避免越界
-        }
-
-        {
-            std::ostringstream oss;
-            oss << date_part << " " << update_time << ".";
-            int frac5 = update_millisec * 100; // ms -> 5位小数
-            oss << std::setw(5) << std::setfill('0') << frac5;
-            datetime_str = oss.str();
-        }
-        
-        // 计算毫秒时间戳
-        try {
-            if (trading_day.size() >= 8 && update_time.size() >= 8) {
-                // 解析年月日
-                int year = std::stoi(trading_day.substr(0, 4));
-                int month = std::stoi(trading_day.substr(4, 2));
-                int day = std::stoi(trading_day.substr(6, 2));
-                
-                // 解析时分秒
-                int hour = std::stoi(update_time.substr(0, 2));
-                int minute = std::stoi(update_time.substr(3, 2));
-                int second = std::stoi(update_time.substr(6, 2));
-                
-                // 转换为time_point
-                std::tm tm_struct = {};
-                tm_struct.tm_year = year - 1900;
-                tm_struct.tm_mon = month - 1;
-                tm_struct.tm_mday = day;
-                tm_struct.tm_hour = hour;
-                tm_struct.tm_min = minute;
-                tm_struct.tm_sec = second;
-                
-                std::time_t time_t_val = std::mktime(&tm_struct);
-                auto time_point = std::chrono::system_clock::from_time_t(time_t_val);
-                
-                // 转换为毫秒时间戳
-                auto ms_since_epoch = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    time_point.time_since_epoch()).count();
-                
-                timestamp_ms = ms_since_epoch + update_millisec;
-            } else {
-                // 解析失败时使用当前时间戳
-                timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count();
-            }
-        } catch (const std::exception& e) {
-            // 异常时使用当前时间戳
-            timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::system_clock::now().time_since_epoch()).count();
-        }
-    }
-    inst_data.AddMember("datetime", rapidjson::Value(datetime_str.c_str(), allocator), allocator);
-    
-    // 3. 卖价和卖量（ask_price10到ask_price1，从高到低）
-    inst_data.AddMember("ask_price10", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("ask_volume10", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("ask_price9", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("ask_volume9", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("ask_price8", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("ask_volume8", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("ask_price7", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("ask_volume7", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("ask_price6", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("ask_volume6", rapidjson::Value().SetNull(), allocator);
-    
-    // CTP提供的5档卖价（检查有效性：大于1e-6且小于1e300）
-    double ask5 = pDepthMarketData->AskPrice5;
-    if (ask5 > 1e-6 && ask5 < 1e300) {
-        inst_data.AddMember("ask_price5", round(ask5 * 100.0) / 100.0, allocator);
-        inst_data.AddMember("ask_volume5", pDepthMarketData->AskVolume5, allocator);
-    } else {
-        inst_data.AddMember("ask_price5", rapidjson::Value().SetNull(), allocator);
-        inst_data.AddMember("ask_volume5", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double ask4 = pDepthMarketData->AskPrice4;
-    if (ask4 > 1e-6 && ask4 < 1e300) {
-        inst_data.AddMember("ask_price4", round(ask4 * 100.0) / 100.0, allocator);
-        inst_data.AddMember("ask_volume4", pDepthMarketData->AskVolume4, allocator);
-    } else {
-        inst_data.AddMember("ask_price4", rapidjson::Value().SetNull(), allocator);
-        inst_data.AddMember("ask_volume4", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double ask3 = pDepthMarketData->AskPrice3;
-    if (ask3 > 1e-6 && ask3 < 1e300) {
-        inst_data.AddMember("ask_price3", round(ask3 * 100.0) / 100.0, allocator);
-        inst_data.AddMember("ask_volume3", pDepthMarketData->AskVolume3, allocator);
-    } else {
-        inst_data.AddMember("ask_price3", rapidjson::Value().SetNull(), allocator);
-        inst_data.AddMember("ask_volume3", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double ask2 = pDepthMarketData->AskPrice2;
-    if (ask2 > 1e-6 && ask2 < 1e300) {
-        inst_data.AddMember("ask_price2", round(ask2 * 100.0) / 100.0, allocator);
-        inst_data.AddMember("ask_volume2", pDepthMarketData->AskVolume2, allocator);
-    } else {
-        inst_data.AddMember("ask_price2", rapidjson::Value().SetNull(), allocator);
-        inst_data.AddMember("ask_volume2", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double ask1 = pDepthMarketData->AskPrice1;
-    if (ask1 > 1e-6 && ask1 < 1e300) {
-        inst_data.AddMember("ask_price1", round(ask1 * 100.0) / 100.0, allocator);
-        inst_data.AddMember("ask_volume1", pDepthMarketData->AskVolume1, allocator);
-    } else {
-        inst_data.AddMember("ask_price1", rapidjson::Value().SetNull(), allocator);
-        inst_data.AddMember("ask_volume1", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    // 4. 买价和买量（bid_price1到bid_price10，从高到低）
-    double bid1 = pDepthMarketData->BidPrice1;
-    if (bid1 > 1e-6 && bid1 < 1e300) {
-        inst_data.AddMember("bid_price1", round(bid1 * 100.0) / 100.0, allocator);
-        inst_data.AddMember("bid_volume1", pDepthMarketData->BidVolume1, allocator);
-    } else {
-        inst_data.AddMember("bid_price1", rapidjson::Value().SetNull(), allocator);
-        inst_data.AddMember("bid_volume1", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double bid2 = pDepthMarketData->BidPrice2;
-    if (bid2 > 1e-6 && bid2 < 1e300) {
-        inst_data.AddMember("bid_price2", round(bid2 * 100.0) / 100.0, allocator);
-        inst_data.AddMember("bid_volume2", pDepthMarketData->BidVolume2, allocator);
-    } else {
-        inst_data.AddMember("bid_price2", rapidjson::Value().SetNull(), allocator);
-        inst_data.AddMember("bid_volume2", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double bid3 = pDepthMarketData->BidPrice3;
-    if (bid3 > 1e-6 && bid3 < 1e300) {
-        inst_data.AddMember("bid_price3", round(bid3 * 100.0) / 100.0, allocator);
-        inst_data.AddMember("bid_volume3", pDepthMarketData->BidVolume3, allocator);
-    } else {
-        inst_data.AddMember("bid_price3", rapidjson::Value().SetNull(), allocator);
-        inst_data.AddMember("bid_volume3", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double bid4 = pDepthMarketData->BidPrice4;
-    if (bid4 > 1e-6 && bid4 < 1e300) {
-        inst_data.AddMember("bid_price4", round(bid4 * 100.0) / 100.0, allocator);
-        inst_data.AddMember("bid_volume4", pDepthMarketData->BidVolume4, allocator);
-    } else {
-        inst_data.AddMember("bid_price4", rapidjson::Value().SetNull(), allocator);
-        inst_data.AddMember("bid_volume4", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double bid5 = pDepthMarketData->BidPrice5;
-    if (bid5 > 1e-6 && bid5 < 1e300) {
-        inst_data.AddMember("bid_price5", round(bid5 * 100.0) / 100.0, allocator);
-        inst_data.AddMember("bid_volume5", pDepthMarketData->BidVolume5, allocator);
-    } else {
-        inst_data.AddMember("bid_price5", rapidjson::Value().SetNull(), allocator);
-        inst_data.AddMember("bid_volume5", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    inst_data.AddMember("bid_price6", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("bid_volume6", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("bid_price7", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("bid_volume7", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("bid_price8", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("bid_volume8", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("bid_price9", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("bid_volume9", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("bid_price10", rapidjson::Value().SetNull(), allocator);
-    inst_data.AddMember("bid_volume10", rapidjson::Value().SetNull(), allocator);
-    
-    // 5. 其他字段（检查有效性：大于1e-6且小于1e300）
-    double last_price = pDepthMarketData->LastPrice;
-    if (last_price > 1e-6 && last_price < 1e300) {
-        inst_data.AddMember("last_price", round(last_price * 100.0) / 100.0, allocator);
-    } else {
-        inst_data.AddMember("last_price", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double highest = pDepthMarketData->HighestPrice;
-    if (highest > 1e-6 && highest < 1e300) {
-        inst_data.AddMember("highest", round(highest * 100.0) / 100.0, allocator);
-    } else {
-        inst_data.AddMember("highest", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double lowest = pDepthMarketData->LowestPrice;
-    if (lowest > 1e-6 && lowest < 1e300) {
-        inst_data.AddMember("lowest", round(lowest * 100.0) / 100.0, allocator);
-    } else {
-        inst_data.AddMember("lowest", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double open = pDepthMarketData->OpenPrice;
-    if (open > 1e-6 && open < 1e300) {
-        inst_data.AddMember("open", round(open * 100.0) / 100.0, allocator);
-    } else {
-        inst_data.AddMember("open", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double close = pDepthMarketData->ClosePrice;
-    if (close > 1e-6 && close < 1e300) {
-        inst_data.AddMember("close", round(close * 100.0) / 100.0, allocator);
-    } else {
-        inst_data.AddMember("close", rapidjson::Value("-", allocator), allocator);
-    }
-    
-    inst_data.AddMember("average", rapidjson::Value().SetNull(), allocator);
-
-    inst_data.AddMember("volume", pDepthMarketData->Volume, allocator);
-    inst_data.AddMember("amount", pDepthMarketData->Turnover, allocator);
-    inst_data.AddMember("open_interest", static_cast<int64_t>(pDepthMarketData->OpenInterest), allocator);
-    double settlement = pDepthMarketData->SettlementPrice;
-    if (settlement > 1e-6 && settlement < 1e300) {
-        inst_data.AddMember("settlement", round(settlement * 100.0) / 100.0, allocator);
-    } else {
-        inst_data.AddMember("settlement", rapidjson::Value("-", allocator), allocator);
-    }
-    
-    double upper_limit = pDepthMarketData->UpperLimitPrice;
-    if (upper_limit > 1e-6 && upper_limit < 1e300) {
-        inst_data.AddMember("upper_limit", round(upper_limit * 100.0) / 100.0, allocator);
-    } else {
-        inst_data.AddMember("upper_limit", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double lower_limit = pDepthMarketData->LowerLimitPrice;
-    if (lower_limit > 1e-6 && lower_limit < 1e300) {
-        inst_data.AddMember("lower_limit", round(lower_limit * 100.0) / 100.0, allocator);
-    } else {
-        inst_data.AddMember("lower_limit", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    inst_data.AddMember("pre_open_interest", static_cast<int64_t>(pDepthMarketData->PreOpenInterest), allocator);
-    
-    double pre_settlement = pDepthMarketData->PreSettlementPrice;
-    if (pre_settlement > 1e-6 && pre_settlement < 1e300) {
-        inst_data.AddMember("pre_settlement", round(pre_settlement * 100.0) / 100.0, allocator);
-    } else {
-        inst_data.AddMember("pre_settlement", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    double pre_close = pDepthMarketData->PreClosePrice;
-    if (pre_close > 1e-6 && pre_close < 1e300) {
-        inst_data.AddMember("pre_close", round(pre_close * 100.0) / 100.0, allocator);
-    } else {
-        inst_data.AddMember("pre_close", rapidjson::Value().SetNull(), allocator);
-    }
-    
-    return inst_data;
+    NormalizedQuote quote;
+    QuoteCodec::normalize(*pDepthMarketData, quote);
+    timestamp_ms = quote.timestamp_ms;
+    return QuoteCodec::to_json(quote, display_instrument, allocator);
 }
 
 void MarketDataSpi::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pDepthMarketData)
@@ -808,8 +573,10 @@ void MarketDataSpi::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pDepthM
     doc.SetObject();
     auto& allocator = doc.GetAllocator();
     
-    long long timestamp_ms;
-    rapidjson::Value inst_data = MarketDataServer::build_quote_data(pDepthMarketData, display_instrument, allocator, timestamp_ms);
+    NormalizedQuote quote;
+    QuoteCodec::normalize(*pDepthMarketData, quote);
+    server_->publish_quote(display_instrument, quote);
+    rapidjson::Value inst_data = QuoteCodec::to_json(quote, display_instrument, allocator);
     
     // 转换为JSON字符串用于Redis存储和内存缓存
     rapidjson::StringBuffer buffer;
@@ -818,7 +585,7 @@ void MarketDataSpi::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pDepthM
     std::string json_data = buffer.GetString();
     
     // 存储到Redis
-    server_->store_market_data_to_redis(instrument_id, json_data, timestamp_ms);
+    server_->store_market_data_to_redis(instrument_id, display_instrument, json_data, quote);
     
     // 缓存行情数据（用于peek_message）
     server_->cache_market_data(instrument_id, json_data);
@@ -846,10 +613,12 @@ MarketDataServer::MarketDataServer(const std::string& ctp_front_addr,
     , segment_(nullptr)
     , alloc_inst_(nullptr)
     , ins_map_(nullptr)
+    , search_index_universe_size_(0)
+    , search_index_rebuilding_(false)
     , is_running_(false)
     , request_id_(0)
     , use_multi_ctp_mode_(false)
-    , redis_client_(std::make_unique<RedisClient>("192.168.2.27", 6379))
+    , redis_router_(std::make_unique<RedisShardRouter>(this, multi_ctp_config_))
 {
 }
 
@@ -864,11 +633,13 @@ MarketDataServer::MarketDataServer(const MultiCTPConfig& config)
     , segment_(nullptr)
     , alloc_inst_(nullptr)
     , ins_map_(nullptr)
+    , search_index_universe_size_(0)
+    , search_index_rebuilding_(false)
     , multi_ctp_config_(config)
     , use_multi_ctp_mode_(true)
     , is_running_(false)
     , request_id_(0)
-    , redis_client_(std::make_unique<RedisClient>(config.redis_host, config.redis_port))
+    , redis_router_(std::make_unique<RedisShardRouter>(this, config))
 {
 }
 
@@ -893,21 +664,21 @@ bool MarketDataServer::start()
     try {
         // 初始化共享内存
         init_shared_memory();
+        attach_instrument_index();
         
-        // 初始化Redis连接
-        std::string redis_info;
-        if (use_multi_ctp_mode_) {
-            redis_info = multi_ctp_config_.redis_host + ":" + std::to_string(multi_ctp_config_.redis_port);
-        } else {
-            redis_info = "192.168.2.27:6379";
-        }
-            
-        if (!redis_client_->connect()) {
-            log_error("Failed to connect to Redis server at " + redis_info);
-            log_warning("Market data will not be stored in Redis");
-        } else {
-            log_info("Connected to Redis server at " + redis_info);
-        }
+        // 从交易前置（或本地缓存）加载合约表到共享内存
+        load_instrument_table();
+        refresh_search_index(true);
+        
+        // 打开共享内存行情看板和tick广播环
+        open_quote_board();
+        open_tick_ring();
+        
+        // 初始化Redis连接（按合约分片；连接失败时行情写入本地溢出文件，后台重连后回放）
+        redis_router_->start();
+        
+        // 从Redis预热最新行情，保证监听开启后客户端立即拿到快照
+        warm_start_from_redis();
         
         // 启动WebSocket服务器
         start_websocket_server();
@@ -977,10 +748,18 @@ void MarketDataServer::stop()
     // 停止IO上下文
     ioc_.stop();
     
+    // 停止Redis写入和恢复线程（写队列中剩余行情会先写出或转入溢出）
+    if (redis_router_) {
+        redis_router_->stop();
+    }
+    
     // 等待服务器线程结束
     if (server_thread_.joinable()) {
         server_thread_.join();
     }
+    if (search_index_thread_.joinable()) {
+        search_index_thread_.join();
+    }
     
     // 清理CTP资源
     if (ctp_api_) {
@@ -1035,6 +814,18 @@ void MarketDataServer::init_shared_memory()
 
 void MarketDataServer::cleanup_shared_memory()
 {
+    if (quote_board_) {
+        quote_board_->close();
+        quote_board_.reset();
+    }
+    quote_board_instruments_.reset();
+    quote_board_legacy_instruments_.reset();
+    
+    if (tick_ring_) {
+        tick_ring_->close();
+        tick_ring_.reset();
+    }
+    
     if (alloc_inst_) {
         delete alloc_inst_;
         alloc_inst_ = nullptr;
@@ -1045,9 +836,304 @@ void MarketDataServer::cleanup_shared_memory()
         segment_ = nullptr;
     }
     
+    instrument_index_.detach();
     ins_map_ = nullptr;
 }
 
+void MarketDataServer::attach_instrument_index()
+{
+    if (!segment_) {
+        return;
+    }
+    
+    InsMapType* legacy_map = multi_ctp_config_.instrument_index_legacy_map ? ins_map_ : nullptr;
+    std::string error;
+    try {
+        if (!instrument_index_.attach(segment_, static_cast<uint32_t>(multi_ctp_config_.instrument_index_capacity),
+                                      legacy_map, error)) {
+            log_warning("Instrument index disabled, falling back to InsMap: " + error);
+            return;
+        }
+    } catch (const boost::interprocess::bad_alloc& e) {
+        instrument_index_.detach();
+        log_warning("Instrument index disabled, shared memory full: " + std::string(e.what()));
+        return;
+    }
+    
+    if (!error.empty()) {
+        log_warning("Instrument index: " + error);
+    }
+    log_info("Instrument index ready: " + std::to_string(instrument_index_.size()) + "/" +
+             std::to_string(instrument_index_.capacity()) + " slots in use" +
+             (legacy_map ? ", InsMap kept in sync" : ""));
+}
+
+void MarketDataServer::load_instrument_table()
+{
+    if (!multi_ctp_config_.instrument_query_enabled || (!ins_map_ && !instrument_index_.is_attached())) {
+        return;
+    }
+    
+    auto start_time = std::chrono::steady_clock::now();
+    InstrumentLoader loader(multi_ctp_config_);
+    std::vector<InstrumentRecord> instruments;
+    std::string source;
+    if (!loader.load(instruments, source)) {
+        log_warning("Instrument table not loaded: " + source);
+        return;
+    }
+    
+    size_t added = 0;
+    size_t updated = 0;
+    try {
+        for (const auto& record : instruments) {
+            // 共享内存合约表的key为带交易所前缀的显示格式，如SHFE.rb2501
+            std::string display_instrument = record.exchange_id + "." + record.instrument_id;
+            Instrument* targets[2] = {nullptr, nullptr};
+            bool created = false;
+            if (instrument_index_.is_attached()) {
+                int slot = instrument_index_.upsert(display_instrument, created);
+                if (slot < 0) {
+                    log_error("Instrument index full at " + std::to_string(instrument_index_.capacity()) +
+                              " instruments, stopped loading");
+                    break;
+                }
+                targets[0] = instrument_index_.instrument(slot);
+                targets[1] = instrument_index_.legacy_instrument(slot);
+            } else {
+                InsMapKeyType key = {};
+                strncpy(key.data(), display_instrument.c_str(), key.size() - 1);
+                auto it = ins_map_->find(key);
+                if (it == ins_map_->end()) {
+                    it = ins_map_->insert(InsMapValueType(key, Instrument())).first;
+                    created = true;
+                }
+                targets[0] = &it->second;
+            }
+            if (created) {
+                added++;
+            } else {
+                updated++;
+            }
+            
+            long product_class = kProductClassFutures;
+            switch (record.product_class) {
+                case THOST_FTDC_PC_Options:
+                case THOST_FTDC_PC_SpotOption:
+                    product_class = kProductClassOptions;
+                    break;
+                case THOST_FTDC_PC_Combination:
+                    product_class = kProductClassCombination;
+                    break;
+                default:
+                    break;
+            }
+            for (Instrument* instrument : targets) {
+                if (!instrument) {
+                    continue;
+                }
+                instrument->expired = !record.is_trading;
+                instrument->product_class = product_class;
+                instrument->volume_multiple = record.volume_multiple;
+                instrument->price_tick = record.price_tick;
+            }
+            
+            noheadtohead_instruments_map_.emplace(record.instrument_id, display_instrument);
+        }
+    } catch (const boost::interprocess::bad_alloc& e) {
+        log_error("Shared memory full while loading instrument table after " +
+                  std::to_string(added + updated) + " instruments: " + e.what());
+    }
+    
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    log_info("Loaded instrument table from " + source + ": " + std::to_string(added) + " added, " +
+             std::to_string(updated) + " updated in " + std::to_string(elapsed_ms) + " ms");
+}
+
+void MarketDataServer::open_quote_board()
+{
+    if (!multi_ctp_config_.quote_board_enabled) {
+        return;
+    }
+    
+    auto board = std::make_unique<QuoteBoard>();
+    uint32_t capacity = static_cast<uint32_t>(multi_ctp_config_.quote_board_capacity);
+    std::string error;
+    if (!board->open(multi_ctp_config_.quote_board_name, capacity, error)) {
+        log_warning("Quote board disabled: failed to open shared memory " + multi_ctp_config_.quote_board_name +
+                    ": " + error);
+        return;
+    }
+    if (board->get_capacity() != capacity) {
+        log_warning("Quote board " + multi_ctp_config_.quote_board_name + " reused with existing capacity " +
+                    std::to_string(board->get_capacity()) + " (configured " + std::to_string(capacity) +
+                    "); remove /dev/shm/" + multi_ctp_config_.quote_board_name + " to resize");
+        capacity = board->get_capacity();
+    }
+    
+    quote_board_instruments_.reset(new std::atomic<Instrument*>[capacity]);
+    quote_board_legacy_instruments_.reset(new std::atomic<Instrument*>[capacity]);
+    for (uint32_t i = 0; i < capacity; ++i) {
+        quote_board_instruments_[i].store(nullptr, std::memory_order_relaxed);
+        quote_board_legacy_instruments_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    log_info("Quote board " + multi_ctp_config_.quote_board_name + " ready: " +
+             std::to_string(board->get_instrument_count()) + "/" + std::to_string(capacity) + " slots in use");
+    quote_board_ = std::move(board);
+}
+
+void MarketDataServer::open_tick_ring()
+{
+    if (!multi_ctp_config_.tick_ring_enabled) {
+        return;
+    }
+    
+    auto ring = std::make_unique<TickRing>();
+    std::string error;
+    if (!ring->open(multi_ctp_config_.tick_ring_name, static_cast<uint32_t>(multi_ctp_config_.tick_ring_capacity), error)) {
+        log_warning("Tick ring disabled: failed to open shared memory " + multi_ctp_config_.tick_ring_name +
+                    ": " + error);
+        return;
+    }
+    
+    log_info("Tick ring " + multi_ctp_config_.tick_ring_name + " ready: capacity " +
+             std::to_string(ring->get_capacity()) + ", write cursor " + std::to_string(ring->get_write_cursor()));
+    tick_ring_ = std::move(ring);
+}
+
+void MarketDataServer::publish_quote(const std::string& display_instrument, const NormalizedQuote& quote)
+{
+    if (tick_ring_) {
+        int64_t receive_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        tick_ring_->publish(display_instrument, receive_time_ms, quote);
+    }
+    
+    if (!quote_board_) {
+        return;
+    }
+    
+    bool created = false;
+    int slot = quote_board_->publish(display_instrument, quote, created);
+    if (slot < 0) {
+        return;
+    }
+    
+    // 新槽位：在合约索引（或InsMap）中查找一次，之后按槽号直接更新
+    if (created) {
+        if (instrument_index_.is_attached()) {
+            int index_slot = instrument_index_.find(display_instrument);
+            if (index_slot >= 0) {
+                quote_board_legacy_instruments_[slot].store(instrument_index_.legacy_instrument(index_slot),
+                                                            std::memory_order_relaxed);
+                quote_board_instruments_[slot].store(instrument_index_.instrument(index_slot), std::memory_order_release);
+            }
+        } else if (ins_map_) {
+            InsMapKeyType key = {};
+            strncpy(key.data(), display_instrument.c_str(), key.size() - 1);
+            auto it = ins_map_->find(key);
+            if (it != ins_map_->end()) {
+                quote_board_instruments_[slot].store(&it->second, std::memory_order_release);
+            }
+        }
+    }
+    
+    Instrument* instrument = quote_board_instruments_[slot].load(std::memory_order_acquire);
+    if (!instrument) {
+        return;
+    }
+    Instrument* targets[2] = {instrument, quote_board_legacy_instruments_[slot].load(std::memory_order_relaxed)};
+    for (Instrument* target : targets) {
+        if (!target) {
+            continue;
+        }
+        target->last_price = quote.has(kQuoteLastPrice) ? quote.last_price : NAN;
+        target->ask_price1 = quote.has(kQuoteAskPrice1) ? quote.ask_price[0] : NAN;
+        target->bid_price1 = quote.has(kQuoteBidPrice1) ? quote.bid_price[0] : NAN;
+        target->upper_limit = quote.has(kQuoteUpperLimit) ? quote.upper_limit : NAN;
+        target->lower_limit = quote.has(kQuoteLowerLimit) ? quote.lower_limit : NAN;
+        target->pre_settlement = quote.has(kQuotePreSettlement) ? quote.pre_settlement : NAN;
+    }
+}
+
+void MarketDataServer::warm_start_from_redis()
+{
+    if (!multi_ctp_config_.warm_start || !redis_router_) {
+        return;
+    }
+    
+    auto start_time = std::chrono::steady_clock::now();
+    
+    // 合约范围：共享内存合约表 + 配置的预热合约，统一为不带交易所前缀的CTP合约代码
+    std::set<std::string> universe;
+    auto add_instrument = [&universe](const std::string& instrument) {
+        size_t dot_pos = instrument.find('.');
+        std::string nohead_instrument = (dot_pos != std::string::npos) ? instrument.substr(dot_pos + 1) : instrument;
+        if (!nohead_instrument.empty()) {
+            universe.insert(nohead_instrument);
+        }
+    };
+    for (const auto& instrument : get_all_instruments()) {
+        add_instrument(instrument);
+    }
+    for (const auto& instrument : multi_ctp_config_.warm_start_instruments) {
+        add_instrument(instrument);
+    }
+    
+    if (universe.empty()) {
+        log_info("Warm start skipped: no instruments to load");
+        return;
+    }
+    
+    std::vector<std::string> instruments(universe.begin(), universe.end());
+    size_t loaded = 0;
+    
+    for (const auto& group : redis_router_->group_by_shard(instruments)) {
+        RedisWriter* writer = group.first;
+        std::map<std::string, std::string> values;
+        if (!writer->get_client()->mget(group.second, values)) {
+            log_warning("Warm start skipped for Redis " + writer->get_endpoint() + ": not connected");
+            continue;
+        }
+        
+        std::lock_guard<std::mutex> lock(market_data_cache_mutex_);
+        for (const auto& pair : values) {
+            rapidjson::Document snapshot;
+            snapshot.Parse(pair.second.c_str());
+            if (snapshot.HasParseError() || !snapshot.IsObject()) {
+                continue;
+            }
+            
+            // 快照中的instrument_id为带交易所前缀的显示格式，用于恢复映射表
+            if (snapshot.HasMember("instrument_id") && snapshot["instrument_id"].IsString()) {
+                std::string display_instrument = snapshot["instrument_id"].GetString();
+                if (display_instrument != pair.first) {
+                    noheadtohead_instruments_map_.emplace(pair.first, display_instrument);
+                }
+            }
+            
+            snapshot.RemoveMember("stale");
+            snapshot.AddMember("stale", true, snapshot.GetAllocator());
+            
+            rapidjson::StringBuffer buffer;
+            rapidjson::Writer<rapidjson::StringBuffer> writer_json(buffer);
+            snapshot.Accept(writer_json);
+            
+            // 不覆盖启动过程中已到达的实时行情
+            if (market_data_cache_.emplace(pair.first, buffer.GetString()).second) {
+                loaded++;
+                warm_instruments_.insert(pair.first);
+            }
+        }
+    }
+    
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    log_info("Warm start loaded " + std::to_string(loaded) + "/" + std::to_string(instruments.size()) +
+             " quotes from Redis in " + std::to_string(elapsed_ms) + " ms");
+}
+
 void MarketDataServer::start_websocket_server()
 {
     auto const address = net::ip::make_address("0.0.0.0");
@@ -1264,6 +1350,104 @@ void MarketDataServer::unsubscribe_instrument(const std::string& session_id, con
     }
 }
 
+void MarketDataServer::subscribe_instruments(const std::string& session_id, const std::vector<std::string>& instrument_ids)
+{
+    if (instrument_ids.empty()) {
+        return;
+    }
+    
+    if (use_multi_ctp_mode_) {
+        // 多CTP连接模式：订阅分发器按连接分组批量下发
+        if (subscription_dispatcher_) {
+            subscription_dispatcher_->add_subscriptions(session_id, instrument_ids);
+        }
+        
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        for (const auto& instrument_id : instrument_ids) {
+            instrument_subscribers_[instrument_id].insert(session_id);
+        }
+        return;
+    }
+    
+    // 单CTP连接模式：收集首次被订阅的合约，一次数组调用
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    std::vector<char*> new_instruments;
+    for (const auto& instrument_id : instrument_ids) {
+        auto& subscribers = instrument_subscribers_[instrument_id];
+        if (subscribers.insert(session_id).second && subscribers.size() == 1) {
+            new_instruments.push_back(const_cast<char*>(instrument_id.c_str()));
+        }
+    }
+    
+    if (new_instruments.empty() || !ctp_api_ || !ctp_logged_in_) {
+        return;
+    }
+    
+    int ret = ctp_api_->SubscribeMarketData(new_instruments.data(), static_cast<int>(new_instruments.size()));
+    if (ret == 0) {
+        log_info("Subscribed to CTP market data: " + std::to_string(new_instruments.size()) + " instruments");
+    } else {
+        log_error("Failed to subscribe to CTP market data: " + std::to_string(new_instruments.size()) +
+                 " instruments, return code: " + std::to_string(ret));
+    }
+}
+
+void MarketDataServer::unsubscribe_instruments(const std::string& session_id, const std::vector<std::string>& instrument_ids)
+{
+    if (instrument_ids.empty()) {
+        return;
+    }
+    
+    if (use_multi_ctp_mode_) {
+        if (subscription_dispatcher_) {
+            subscription_dispatcher_->remove_subscriptions(session_id, instrument_ids);
+        }
+        
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        for (const auto& instrument_id : instrument_ids) {
+            auto it = instrument_subscribers_.find(instrument_id);
+            if (it != instrument_subscribers_.end()) {
+                it->second.erase(session_id);
+                if (it->second.empty()) {
+                    instrument_subscribers_.erase(it);
+                }
+            }
+        }
+        return;
+    }
+    
+    // 单CTP连接模式：收集不再被订阅的合约，一次数组调用
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    std::vector<std::string> released;
+    for (const auto& instrument_id : instrument_ids) {
+        auto it = instrument_subscribers_.find(instrument_id);
+        if (it == instrument_subscribers_.end()) {
+            continue;
+        }
+        it->second.erase(session_id);
+        if (it->second.empty()) {
+            instrument_subscribers_.erase(it);
+            released.push_back(instrument_id);
+        }
+    }
+    
+    if (released.empty() || !ctp_api_ || !ctp_logged_in_) {
+        return;
+    }
+    
+    std::vector<char*> instruments;
+    for (const auto& instrument_id : released) {
+        instruments.push_back(const_cast<char*>(instrument_id.c_str()));
+    }
+    int ret = ctp_api_->UnSubscribeMarketData(instruments.data(), static_cast<int>(instruments.size()));
+    if (ret == 0) {
+        log_info("Unsubscribed from CTP market data: " + std::to_string(released.size()) + " instruments");
+    } else {
+        log_error("Failed to unsubscribe from CTP market data: " + std::to_string(released.size()) +
+                 " instruments, return code: " + std::to_string(ret));
+    }
+}
+
 void MarketDataServer::broadcast_market_data(const std::string& instrument_id, const std::string& json_data)
 {
     // 不再立即广播，而是缓存行情数据
@@ -1274,7 +1458,16 @@ void MarketDataServer::cache_market_data(const std::string& instrument_id, const
 {
     {
         std::lock_guard<std::mutex> lock(market_data_cache_mutex_);
-        market_data_cache_[instrument_id] = json_data;
+        if (!warm_instruments_.empty() && !json_data.empty() && json_data.back() == '}' &&
+            warm_instruments_.erase(instrument_id)) {
+            // 预热快照带有"stale":true，首条实时行情显式置为false，保证增量推送能覆盖客户端状态；
+            // 之后的行情不再复制JSON追加该字段
+            std::string live_json = json_data;
+            live_json.insert(live_json.size() - 1, ",\"stale\":false");
+            market_data_cache_[instrument_id] = std::move(live_json);
+        } else {
+            market_data_cache_[instrument_id] = json_data;
+        }
     }
     
     // 检查是否有挂起的session需要被唤醒
@@ -1489,34 +1682,35 @@ void MarketDataServer::send_to_session(const std::string& session_id, const std:
 }
 
 void MarketDataServer::store_market_data_to_redis(const std::string& instrument_id,
+                                                  const std::string& display_instrument,
                                                   const std::string& json_data,
-                                                  long long& timestamp_ms)
+                                                  const NormalizedQuote& quote)
 {
-    auto& redis_client = get_redis_client();
-    if (!redis_client || !redis_client->is_connected()) {
+    if (!redis_router_) {
         return;
     }
 
-    // 最新
-    if (!redis_client->set(instrument_id, json_data)) {
-        log_warning("Failed to store latest market data to Redis for instrument: " + instrument_id);
+    // 发布频道：按合约或按交易所（取显示格式的交易所前缀）
+    std::string publish_channel;
+    const std::string& prefix = multi_ctp_config_.redis_publish_prefix;
+    switch (multi_ctp_config_.redis_publish_mode) {
+        case RedisPublishMode::INSTRUMENT:
+            publish_channel = prefix + display_instrument;
+            break;
+        case RedisPublishMode::EXCHANGE: {
+            size_t dot_pos = display_instrument.find('.');
+            publish_channel = prefix + (dot_pos != std::string::npos ? display_instrument.substr(0, dot_pos) : "UNKNOWN");
+            break;
+        }
+        case RedisPublishMode::NONE:
+            break;
     }
 
-    // 历史
-    if (timestamp_ms > 0) {
-        std::string history_key = "history:" + instrument_id;
-        if (!redis_client->zadd(history_key, timestamp_ms, json_data)) {
-            log_warning("Failed to store historical market data to Redis for instrument: " + instrument_id);
-        }
-        const long long history_size = redis_client->zcard(history_key);
-        if (history_size >= 100000) {
-            const long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::system_clock::now().time_since_epoch()).count();
-            const long long expire_before_ms = now_ms - static_cast<long long>(2) * 24 * 3600 * 1000; // 保留最近2天
-            if (!redis_client->zremrangebyscore(history_key, 0, expire_before_ms)) {
-                log_warning("Failed to remove historical market data from Redis for instrument: " + instrument_id);
-            }
-        }
+    // 历史tick按配置选择JSON或紧凑二进制编码，最新行情始终为JSON
+    if (multi_ctp_config_.history_format == HistoryFormat::BINARY) {
+        redis_router_->write_tick(instrument_id, json_data, quote.timestamp_ms, QuoteCodec::encode(quote), publish_channel);
+    } else {
+        redis_router_->write_tick(instrument_id, json_data, quote.timestamp_ms, json_data, publish_channel);
     }
 }
 
@@ -1524,7 +1718,13 @@ std::vector<std::string> MarketDataServer::get_all_instruments()
 {
     std::vector<std::string> instruments;
     
-    if (ins_map_) {
+    if (instrument_index_.is_attached()) {
+        uint32_t count = instrument_index_.size();
+        instruments.reserve(count);
+        for (uint32_t slot = 0; slot < count; ++slot) {
+            instruments.emplace_back(instrument_index_.instrument_id(static_cast<int>(slot)));
+        }
+    } else if (ins_map_) {
         for (auto it = ins_map_->begin(); it != ins_map_->end(); ++it) {
             std::string key(it->first.data());
             // 移除末尾的空字符
@@ -1538,30 +1738,58 @@ std::vector<std::string> MarketDataServer::get_all_instruments()
     return instruments;
 }
 
-std::vector<std::string> MarketDataServer::search_instruments(const std::string& pattern)
+std::vector<std::string> MarketDataServer::search_instruments(const std::string& pattern, size_t offset, size_t limit,
+                                                              size_t* total)
 {
-    std::vector<std::string> matching_instruments;
-    
-    if (ins_map_) {
-        std::string lower_pattern = pattern;
-        std::transform(lower_pattern.begin(), lower_pattern.end(), lower_pattern.begin(), ::tolower);
-        
-        for (auto it = ins_map_->begin(); it != ins_map_->end(); ++it) {
-            std::string key(it->first.data());
-            key.erase(std::find(key.begin(), key.end(), '\0'), key.end());
-            
-            if (!key.empty()) {
-                std::string lower_key = key;
-                std::transform(lower_key.begin(), lower_key.end(), lower_key.begin(), ::tolower);
-                
-                if (lower_key.find(lower_pattern) != std::string::npos) {
-                    matching_instruments.push_back(key);
-                }
-            }
+    // 其他进程可能向共享内存合约表追加合约，条目数变化时在后台重建索引，本次仍按旧快照返回
+    if (get_instrument_universe_size() != search_index_universe_size_.load(std::memory_order_relaxed)) {
+        request_search_index_rebuild();
+    }
+    return search_index_.search(pattern, offset, limit, total);
+}
+
+void MarketDataServer::request_search_index_rebuild()
+{
+    // 只有取得重建标志的线程启动重建，其余请求直接返回；重建完成后条目数仍有变化时由下一次搜索再触发
+    if (search_index_rebuilding_.exchange(true)) {
+        return;
+    }
+    if (search_index_thread_.joinable()) {
+        search_index_thread_.join();   // 上一次重建已结束
+    }
+    search_index_thread_ = boost::thread([this]() {
+        try {
+            refresh_search_index(false);
+        } catch (const std::exception& e) {
+            log_error("Instrument search index rebuild failed: " + std::string(e.what()));
         }
+        search_index_rebuilding_.store(false);
+    });
+}
+
+size_t MarketDataServer::get_instrument_universe_size() const
+{
+    if (instrument_index_.is_attached()) {
+        return instrument_index_.size();
     }
+    return ins_map_ ? ins_map_->size() : 0;
+}
+
+void MarketDataServer::refresh_search_index(bool force)
+{
+    size_t universe_size = get_instrument_universe_size();
+    if (!force && universe_size == search_index_universe_size_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    
+    auto start_time = std::chrono::steady_clock::now();
+    search_index_.rebuild(get_all_instruments());
+    search_index_universe_size_.store(universe_size, std::memory_order_relaxed);
     
-    return matching_instruments;
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    log_info("Instrument search index rebuilt: " + std::to_string(search_index_.size()) + " instruments in " +
+             std::to_string(elapsed_ms) + " ms");
 }
 
 void MarketDataServer::log_info(const std::string& message)
@@ -1614,6 +1842,14 @@ bool MarketDataServer::init_multi_ctp_system()
         
         // 设置负载均衡策略
         subscription_dispatcher_->set_load_balance_strategy(multi_ctp_config_.load_balance_strategy);
+        subscription_dispatcher_->set_redundancy(multi_ctp_config_.redundancy_mode, multi_ctp_config_.redundant_instruments);
+        subscription_dispatcher_->set_rate_balance(multi_ctp_config_.rate_balance_interval,
+                                                   multi_ctp_config_.rate_balance_max_moves,
+                                                   multi_ctp_config_.rate_balance_tolerance);
+        subscription_dispatcher_->set_rebalance(multi_ctp_config_.rebalance_interval,
+                                                multi_ctp_config_.rebalance_moves_per_second);
+        subscription_dispatcher_->set_linger(multi_ctp_config_.subscription_linger_seconds,
+                                             multi_ctp_config_.subscription_linger_max_per_connection);
         
         // 添加所有连接配置
         for (const auto& conn_config : multi_ctp_config_.connections) {
@@ -1629,6 +1865,15 @@ bool MarketDataServer::init_multi_ctp_system()
             }
         }
         
+        // 读取上次保存的订阅集合，各前置登录后批量恢复
+        subscription_dispatcher_->set_universe(multi_ctp_config_.subscription_universe_file,
+                                               multi_ctp_config_.subscription_universe_save_interval,
+                                               multi_ctp_config_.subscription_universe_grace);
+        subscription_dispatcher_->load_universe();
+        
+        // 行情静默检测随健康检查启动
+        connection_manager_->set_watchdog(multi_ctp_config_);
+        
         // 启动所有连接
         if (!connection_manager_->start_all_connections()) {
             log_warning("Some CTP connections failed to start");
@@ -1710,8 +1955,28 @@ std::vector<std::string> MarketDataServer::get_connection_status() const
                 case CTPConnectionStatus::ERROR:
                     status += "ERROR";
                     break;
+                case CTPConnectionStatus::DEGRADED:
+                    status += "DEGRADED (" + std::to_string(conn->get_subscription_count()) + " subs)";
+                    break;
             }
             status += " [Quality: " + std::to_string(conn->get_connection_quality()) + "%]";
+            
+            auto cmd_stats = conn->get_command_stats();
+            std::ostringstream cmd_oss;
+            cmd_oss << std::fixed << std::setprecision(1)
+                    << " [Cmd: queued " << cmd_stats.queued << ", issued " << cmd_stats.issued
+                    << " in " << cmd_stats.api_calls << " calls, cancelled " << cmd_stats.cancelled
+                    << ", throttled " << cmd_stats.throttled << ", queue avg/max " << cmd_stats.avg_queue_latency_ms
+                    << "/" << cmd_stats.max_queue_latency_ms << " ms, ack avg/max " << cmd_stats.avg_ack_latency_ms
+                    << "/" << cmd_stats.max_ack_latency_ms << " ms]";
+            status += cmd_oss.str();
+            
+            auto latency = conn->get_latency_snapshot();
+            std::ostringstream lat_oss;
+            lat_oss << std::fixed << std::setprecision(1)
+                    << " [Latency: ewma " << latency.ewma_ms << " ms, p50/p90/p99 " << latency.p50_ms
+                    << "/" << latency.p90_ms << "/" << latency.p99_ms << " ms, samples " << latency.samples << "]";
+            status += lat_oss.str();
             status_list.push_back(status);
         }
     } else {
@@ -1729,6 +1994,102 @@ std::vector<std::string> MarketDataServer::get_connection_status() const
     return status_list;
 }
 
+int64_t MarketDataServer::get_startup_login_ms() const
+{
+    return (use_multi_ctp_mode_ && connection_manager_) ? connection_manager_->get_startup_login_ms() : -1;
+}
+
+rapidjson::Value MarketDataServer::get_dispatcher_metrics(rapidjson::Document::AllocatorType& allocator) const
+{
+    rapidjson::Value dispatcher(rapidjson::kObjectType);
+    if (!use_multi_ctp_mode_ || !subscription_dispatcher_) {
+        return dispatcher;
+    }
+    
+    auto stats = subscription_dispatcher_->get_loop_statistics();
+    dispatcher.AddMember("commands_processed", static_cast<uint64_t>(stats.commands_processed), allocator);
+    dispatcher.AddMember("queue_depth", static_cast<uint64_t>(stats.queue_depth), allocator);
+    dispatcher.AddMember("avg_wait_us", stats.avg_wait_us, allocator);
+    dispatcher.AddMember("max_wait_us", stats.max_wait_us, allocator);
+    dispatcher.AddMember("commands_per_second", stats.commands_per_second, allocator);
+    return dispatcher;
+}
+
+rapidjson::Value MarketDataServer::get_tick_ring_metrics(rapidjson::Document::AllocatorType& allocator) const
+{
+    rapidjson::Value ring(rapidjson::kObjectType);
+    if (!tick_ring_) {
+        return ring;
+    }
+    
+    ring.AddMember("capacity", tick_ring_->get_capacity(), allocator);
+    ring.AddMember("write_cursor", tick_ring_->get_write_cursor(), allocator);
+    
+    rapidjson::Value readers(rapidjson::kArrayType);
+    for (const auto& info : tick_ring_->get_readers()) {
+        rapidjson::Value item(rapidjson::kObjectType);
+        item.AddMember("name", rapidjson::Value(info.name.c_str(), allocator), allocator);
+        item.AddMember("pid", info.pid, allocator);
+        item.AddMember("position", info.position, allocator);
+        item.AddMember("lag", info.lag, allocator);
+        item.AddMember("overruns", info.overruns, allocator);
+        item.AddMember("lost", info.lost, allocator);
+        readers.PushBack(item, allocator);
+    }
+    ring.AddMember("readers", readers, allocator);
+    return ring;
+}
+
+rapidjson::Value MarketDataServer::get_connection_metrics(rapidjson::Document::AllocatorType& allocator) const
+{
+    rapidjson::Value connections(rapidjson::kArrayType);
+    if (!use_multi_ctp_mode_ || !connection_manager_) {
+        return connections;
+    }
+    
+    std::map<std::string, TickArbiterStats> arbitration;
+    if (subscription_dispatcher_) {
+        arbitration = subscription_dispatcher_->get_arbitration_stats();
+    }
+    
+    for (const auto& conn : connection_manager_->get_all_connections()) {
+        rapidjson::Value item(rapidjson::kObjectType);
+        item.AddMember("connection_id", rapidjson::Value(conn->get_connection_id().c_str(), allocator), allocator);
+        item.AddMember("status", static_cast<int>(conn->get_status()), allocator);
+        item.AddMember("subscriptions", static_cast<uint64_t>(conn->get_subscription_count()), allocator);
+        item.AddMember("max_subscriptions", static_cast<uint64_t>(conn->get_max_subscriptions()), allocator);
+        item.AddMember("quality", conn->get_connection_quality(), allocator);
+        
+        auto latency = conn->get_latency_snapshot();
+        rapidjson::Value latency_obj(rapidjson::kObjectType);
+        latency_obj.AddMember("samples", static_cast<uint64_t>(latency.samples), allocator);
+        latency_obj.AddMember("discarded", static_cast<uint64_t>(latency.discarded), allocator);
+        latency_obj.AddMember("ewma_ms", latency.ewma_ms, allocator);
+        latency_obj.AddMember("p50_ms", latency.p50_ms, allocator);
+        latency_obj.AddMember("p90_ms", latency.p90_ms, allocator);
+        latency_obj.AddMember("p99_ms", latency.p99_ms, allocator);
+        latency_obj.AddMember("max_ms", latency.max_ms, allocator);
+        if (subscription_dispatcher_) {
+            latency_obj.AddMember("relative_lag_ms",
+                                  subscription_dispatcher_->get_relative_lag_ms(conn->get_connection_id()), allocator);
+        }
+        item.AddMember("latency", latency_obj, allocator);
+        
+        auto arb_it = arbitration.find(conn->get_connection_id());
+        if (arb_it != arbitration.end()) {
+            rapidjson::Value arb_obj(rapidjson::kObjectType);
+            arb_obj.AddMember("first_arrivals", static_cast<uint64_t>(arb_it->second.first_arrivals), allocator);
+            arb_obj.AddMember("duplicates", static_cast<uint64_t>(arb_it->second.duplicates), allocator);
+            arb_obj.AddMember("stale", static_cast<uint64_t>(arb_it->second.stale), allocator);
+            arb_obj.AddMember("avg_lag_ms", arb_it->second.avg_lag_ms, allocator);
+            item.AddMember("arbitration", arb_obj, allocator);
+        }
+        
+        connections.PushBack(item, allocator);
+    }
+    return connections;
+}
+
 void MarketDataServer::send_empty_rtn_data(const std::string& session_id)
 {
     auto session_it = sessions_.find(session_id);
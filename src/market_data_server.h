@@ -21,9 +21,15 @@
 #include <atomic>
 #include <mutex>
 #include <queue>
+#include <unordered_set>
 // 使用项目中的类型定义，其中包含了rapidjson的正确配置
 #include "../include/open-trade-common/types.h"
-#include "redis_client.h"
+#include "redis_shard_router.h"
+#include "quote_codec.h"
+#include "instrument_index.h"
+#include "instrument_search_index.h"
+#include "quote_board.h"
+#include "tick_ring.h"
 #include "ctp_connection_manager.h"
 #include "subscription_dispatcher.h"
 #include "multi_ctp_config.h"
@@ -118,6 +124,8 @@ public:
     void remove_session(const std::string& session_id);
     void subscribe_instrument(const std::string& session_id, const std::string& instrument_id);
     void unsubscribe_instrument(const std::string& session_id, const std::string& instrument_id);
+    void subscribe_instruments(const std::string& session_id, const std::vector<std::string>& instrument_ids);
+    void unsubscribe_instruments(const std::string& session_id, const std::vector<std::string>& instrument_ids);
     
     // 行情数据推送
     void broadcast_market_data(const std::string& instrument_id, const std::string& json_data);
@@ -133,7 +141,9 @@ public:
     
     // 合约管理
     std::vector<std::string> get_all_instruments();
-    std::vector<std::string> search_instruments(const std::string& pattern);
+    // 按档次排序后返回第offset条起最多limit条（limit为0表示全部），total返回匹配总数
+    std::vector<std::string> search_instruments(const std::string& pattern, size_t offset = 0, size_t limit = 0,
+                                                size_t* total = nullptr);
     
     // CTP连接状态（多连接版本）
     bool is_ctp_connected() const;
@@ -141,6 +151,18 @@ public:
     size_t get_active_connections_count() const;
     std::vector<std::string> get_connection_status() const;
     
+    // 各连接的延迟分布与仲裁统计
+    rapidjson::Value get_connection_metrics(rapidjson::Document::AllocatorType& allocator) const;
+    
+    // 启动到所有前置登录成功的耗时(毫秒)，未全部登录时为-1
+    int64_t get_startup_login_ms() const;
+    
+    // 订阅分发器事件循环的吞吐与排队等待
+    rapidjson::Value get_dispatcher_metrics(rapidjson::Document::AllocatorType& allocator) const;
+    
+    // tick广播环的写位置与各读取端的落后量、覆盖次数
+    rapidjson::Value get_tick_ring_metrics(rapidjson::Document::AllocatorType& allocator) const;
+    
     // 多连接管理接口
     CTPConnectionManager* get_connection_manager() { return connection_manager_.get(); }
     SubscriptionDispatcher* get_subscription_dispatcher() { return subscription_dispatcher_.get(); }
@@ -150,20 +172,32 @@ public:
     
     // Redis存储相关
     void store_market_data_to_redis(const std::string& instrument_id, 
+                                   const std::string& display_instrument,
                                    const std::string& json_data, 
-                                   long long& timestamp_ms);
+                                   const NormalizedQuote& quote);
+    
+    // 写入tick广播环和共享内存行情看板，并同步共享内存合约表中的最新价字段
+    void publish_quote(const std::string& display_instrument, const NormalizedQuote& quote);
 
     // 日志函数
     void log_info(const std::string& message);
     void log_error(const std::string& message);
     void log_warning(const std::string& message);
     
-    // Redis客户端访问（供MarketDataSpi使用）
-    std::unique_ptr<RedisClient>& get_redis_client() { return redis_client_; }
+    // Redis写入器访问
+    RedisShardRouter* get_redis_router() { return redis_router_.get(); }
     
 private:
     void init_shared_memory();
     void cleanup_shared_memory();
+    void attach_instrument_index();
+    void load_instrument_table();
+    void refresh_search_index(bool force);
+    void request_search_index_rebuild();
+    size_t get_instrument_universe_size() const;
+    void open_quote_board();
+    void open_tick_ring();
+    void warm_start_from_redis();
     void start_websocket_server();
     void handle_accept(beast::error_code ec, tcp::socket socket);
 public:
@@ -195,6 +229,7 @@ private:
     std::map<std::string, std::shared_ptr<WebSocketSession>> sessions_;
     std::map<std::string, std::set<std::string>> instrument_subscribers_; // instrument_id -> session_ids
     std::map<std::string, std::string> market_data_cache_; // instrument_id -> latest_market_data_json
+    std::unordered_set<std::string> warm_instruments_;    // 由Redis预热、尚未收到实时行情的合约，首条实时行情带"stale":false后移除
     std::mutex market_data_cache_mutex_;
     
     // 客户端上次发送的完整消息json缓存: session_id -> last_sent_json
@@ -219,6 +254,24 @@ private:
     // 请求ID管理
     std::atomic<int> request_id_;
     
-    // Redis客户端
-    std::unique_ptr<RedisClient> redis_client_;
+    // Redis写入器（含故障溢出与恢复回放）
+    std::unique_ptr<RedisShardRouter> redis_router_;
+    
+    // 共享内存合约哈希索引，未能挂载时退回InsMap
+    InstrumentIndex instrument_index_;
+    
+    // 合约搜索索引；search_index_universe_size_为构建时的合约表条目数。
+    // 搜索发现条目数变化时在后台线程重建，查询继续使用旧快照；search_index_rebuilding_保证同一时刻只有一个重建
+    InstrumentSearchIndex search_index_;
+    std::atomic<size_t> search_index_universe_size_;
+    std::atomic<bool> search_index_rebuilding_;
+    boost::thread search_index_thread_;
+    
+    // 共享内存行情看板；quote_board_instruments_为槽号 -> 合约索引中的合约，quote_board_legacy_instruments_为InsMap中的同一合约（首次写入槽位时解析）
+    std::unique_ptr<QuoteBoard> quote_board_;
+    std::unique_ptr<std::atomic<Instrument*>[]> quote_board_instruments_;
+    std::unique_ptr<std::atomic<Instrument*>[]> quote_board_legacy_instruments_;
+    
+    // 共享内存tick广播环
+    std::unique_ptr<TickRing> tick_ring_;
 };
\ No newline at end of file
@@ -5,9 +5,11 @@
 /////////////////////////////////////////////////////////////////////////
 
 #include "multi_ctp_config.h"
+#include "tick_watchdog.h"
 #include "../include/open-trade-common/types.h"
 #include <fstream>
 #include <iostream>
+#include <cstdlib>
 
 bool ConfigLoader::load_from_file(const std::string& config_file, MultiCTPConfig& config)
 {
@@ -48,6 +50,106 @@ bool ConfigLoader::load_from_json(const std::string& json_content, MultiCTPConfi
             config.redis_port = doc["redis_port"].GetInt();
         }
         
+        if (doc.HasMember("redis_endpoints") && doc["redis_endpoints"].IsArray()) {
+            config.redis_endpoints.clear();
+            for (const auto& endpoint_json : doc["redis_endpoints"].GetArray()) {
+                RedisEndpointConfig endpoint;
+                if (endpoint_json.IsString()) {
+                    // "host:port" 简写
+                    std::string addr = endpoint_json.GetString();
+                    size_t pos = addr.rfind(':');
+                    endpoint.host = addr.substr(0, pos);
+                    if (pos != std::string::npos) {
+                        endpoint.port = std::atoi(addr.substr(pos + 1).c_str());
+                    }
+                } else if (endpoint_json.IsObject()) {
+                    if (endpoint_json.HasMember("host") && endpoint_json["host"].IsString()) {
+                        endpoint.host = endpoint_json["host"].GetString();
+                    }
+                    if (endpoint_json.HasMember("port") && endpoint_json["port"].IsInt()) {
+                        endpoint.port = endpoint_json["port"].GetInt();
+                    }
+                    if (endpoint_json.HasMember("weight") && endpoint_json["weight"].IsInt()) {
+                        endpoint.weight = endpoint_json["weight"].GetInt();
+                    }
+                } else {
+                    continue;
+                }
+                config.redis_endpoints.push_back(endpoint);
+            }
+        }
+        
+        if (doc.HasMember("redis_pipeline_batch") && doc["redis_pipeline_batch"].IsInt()) {
+            config.redis_pipeline_batch = doc["redis_pipeline_batch"].GetInt();
+        }
+        
+        if (doc.HasMember("redis_queue_limit") && doc["redis_queue_limit"].IsInt()) {
+            config.redis_queue_limit = doc["redis_queue_limit"].GetInt();
+        }
+        
+        if (doc.HasMember("redis_spill_dir") && doc["redis_spill_dir"].IsString()) {
+            config.redis_spill_dir = doc["redis_spill_dir"].GetString();
+        }
+        
+        if (doc.HasMember("redis_spill_size_mb") && doc["redis_spill_size_mb"].IsInt()) {
+            config.redis_spill_size_mb = doc["redis_spill_size_mb"].GetInt();
+        }
+        
+        if (doc.HasMember("redis_replay_rate") && doc["redis_replay_rate"].IsInt()) {
+            config.redis_replay_rate = doc["redis_replay_rate"].GetInt();
+        }
+        
+        if (doc.HasMember("redis_reconnect_max_backoff") && doc["redis_reconnect_max_backoff"].IsInt()) {
+            config.redis_reconnect_max_backoff = doc["redis_reconnect_max_backoff"].GetInt();
+        }
+        
+        if (doc.HasMember("history_format") && doc["history_format"].IsString()) {
+            std::string format = doc["history_format"].GetString();
+            if (format == "json") {
+                config.history_format = HistoryFormat::JSON;
+            } else if (format == "binary") {
+                config.history_format = HistoryFormat::BINARY;
+            } else {
+                std::cerr << "Invalid history_format: " << format << std::endl;
+                return false;
+            }
+        }
+        
+        if (doc.HasMember("redis_publish_mode") && doc["redis_publish_mode"].IsString()) {
+            std::string mode = doc["redis_publish_mode"].GetString();
+            if (mode == "none") {
+                config.redis_publish_mode = RedisPublishMode::NONE;
+            } else if (mode == "instrument") {
+                config.redis_publish_mode = RedisPublishMode::INSTRUMENT;
+            } else if (mode == "exchange") {
+                config.redis_publish_mode = RedisPublishMode::EXCHANGE;
+            } else {
+                std::cerr << "Invalid redis_publish_mode: " << mode << std::endl;
+                return false;
+            }
+        }
+        
+        if (doc.HasMember("redis_publish_prefix") && doc["redis_publish_prefix"].IsString()) {
+            config.redis_publish_prefix = doc["redis_publish_prefix"].GetString();
+        }
+        
+        if (doc.HasMember("redis_publish_conflation_ms") && doc["redis_publish_conflation_ms"].IsInt()) {
+            config.redis_publish_conflation_ms = doc["redis_publish_conflation_ms"].GetInt();
+        }
+        
+        if (doc.HasMember("warm_start") && doc["warm_start"].IsBool()) {
+            config.warm_start = doc["warm_start"].GetBool();
+        }
+        
+        if (doc.HasMember("warm_start_instruments") && doc["warm_start_instruments"].IsArray()) {
+            config.warm_start_instruments.clear();
+            for (const auto& instrument : doc["warm_start_instruments"].GetArray()) {
+                if (instrument.IsString()) {
+                    config.warm_start_instruments.push_back(instrument.GetString());
+                }
+            }
+        }
+        
         // 解析负载均衡策略
         if (doc.HasMember("load_balance_strategy") && doc["load_balance_strategy"].IsString()) {
             std::string strategy = doc["load_balance_strategy"].GetString();
@@ -59,6 +161,8 @@ bool ConfigLoader::load_from_json(const std::string& json_content, MultiCTPConfi
                 config.load_balance_strategy = LoadBalanceStrategy::CONNECTION_QUALITY;
             } else if (strategy == "hash_based") {
                 config.load_balance_strategy = LoadBalanceStrategy::HASH_BASED;
+            } else if (strategy == "latency") {
+                config.load_balance_strategy = LoadBalanceStrategy::LATENCY;
             }
         }
         
@@ -79,6 +183,223 @@ bool ConfigLoader::load_from_json(const std::string& json_content, MultiCTPConfi
             config.auto_failover = doc["auto_failover"].GetBool();
         }
         
+        // 解析冗余订阅配置
+        if (doc.HasMember("redundancy_mode") && doc["redundancy_mode"].IsString()) {
+            std::string mode = doc["redundancy_mode"].GetString();
+            if (mode == "none") {
+                config.redundancy_mode = RedundancyMode::NONE;
+            } else if (mode == "all") {
+                config.redundancy_mode = RedundancyMode::ALL;
+            } else if (mode == "hot_set") {
+                config.redundancy_mode = RedundancyMode::HOT_SET;
+            } else {
+                std::cerr << "Invalid redundancy_mode: " << mode << std::endl;
+                return false;
+            }
+        }
+        
+        if (doc.HasMember("redundant_instruments") && doc["redundant_instruments"].IsArray()) {
+            config.redundant_instruments.clear();
+            for (const auto& instrument : doc["redundant_instruments"].GetArray()) {
+                if (instrument.IsString()) {
+                    config.redundant_instruments.push_back(instrument.GetString());
+                }
+            }
+        }
+        
+        // 解析保留订阅配置
+        if (doc.HasMember("subscription_linger_seconds") && doc["subscription_linger_seconds"].IsInt()) {
+            config.subscription_linger_seconds = doc["subscription_linger_seconds"].GetInt();
+        }
+        
+        if (doc.HasMember("subscription_linger_max_per_connection") && doc["subscription_linger_max_per_connection"].IsInt()) {
+            config.subscription_linger_max_per_connection = doc["subscription_linger_max_per_connection"].GetInt();
+        }
+        
+        // 解析订阅集合持久化配置
+        if (doc.HasMember("subscription_universe_file") && doc["subscription_universe_file"].IsString()) {
+            config.subscription_universe_file = doc["subscription_universe_file"].GetString();
+        }
+        
+        if (doc.HasMember("subscription_universe_save_interval") && doc["subscription_universe_save_interval"].IsInt()) {
+            config.subscription_universe_save_interval = doc["subscription_universe_save_interval"].GetInt();
+        }
+        
+        if (doc.HasMember("subscription_universe_grace") && doc["subscription_universe_grace"].IsInt()) {
+            config.subscription_universe_grace = doc["subscription_universe_grace"].GetInt();
+        }
+        
+        // 解析行情静默检测配置
+        if (doc.HasMember("watchdog_enabled") && doc["watchdog_enabled"].IsBool()) {
+            config.watchdog_enabled = doc["watchdog_enabled"].GetBool();
+        }
+        
+        if (doc.HasMember("watchdog_interval_ms") && doc["watchdog_interval_ms"].IsInt()) {
+            config.watchdog_interval_ms = doc["watchdog_interval_ms"].GetInt();
+        }
+        
+        if (doc.HasMember("watchdog_min_silence_ms") && doc["watchdog_min_silence_ms"].IsInt()) {
+            config.watchdog_min_silence_ms = doc["watchdog_min_silence_ms"].GetInt();
+        }
+        
+        if (doc.HasMember("watchdog_max_silence_ms") && doc["watchdog_max_silence_ms"].IsInt()) {
+            config.watchdog_max_silence_ms = doc["watchdog_max_silence_ms"].GetInt();
+        }
+        
+        if (doc.HasMember("watchdog_silence_factor") && doc["watchdog_silence_factor"].IsNumber()) {
+            config.watchdog_silence_factor = doc["watchdog_silence_factor"].GetDouble();
+        }
+        
+        if (doc.HasMember("watchdog_min_rate") && doc["watchdog_min_rate"].IsNumber()) {
+            config.watchdog_min_rate = doc["watchdog_min_rate"].GetDouble();
+        }
+        
+        if (doc.HasMember("watchdog_restart_after") && doc["watchdog_restart_after"].IsInt()) {
+            config.watchdog_restart_after = doc["watchdog_restart_after"].GetInt();
+        }
+        
+        if (doc.HasMember("watchdog_sessions") && doc["watchdog_sessions"].IsArray()) {
+            config.watchdog_sessions.clear();
+            for (const auto& session : doc["watchdog_sessions"].GetArray()) {
+                if (session.IsString()) {
+                    config.watchdog_sessions.push_back(session.GetString());
+                }
+            }
+        }
+        
+        // 解析行情频率均衡配置
+        if (doc.HasMember("rate_balance_interval") && doc["rate_balance_interval"].IsInt()) {
+            config.rate_balance_interval = doc["rate_balance_interval"].GetInt();
+        }
+        
+        if (doc.HasMember("rate_balance_max_moves") && doc["rate_balance_max_moves"].IsInt()) {
+            config.rate_balance_max_moves = doc["rate_balance_max_moves"].GetInt();
+        }
+        
+        if (doc.HasMember("rate_balance_tolerance") && doc["rate_balance_tolerance"].IsNumber()) {
+            config.rate_balance_tolerance = doc["rate_balance_tolerance"].GetDouble();
+        }
+        
+        if (doc.HasMember("rebalance_interval") && doc["rebalance_interval"].IsInt()) {
+            config.rebalance_interval = doc["rebalance_interval"].GetInt();
+        }
+        
+        if (doc.HasMember("rebalance_moves_per_second") && doc["rebalance_moves_per_second"].IsInt()) {
+            config.rebalance_moves_per_second = doc["rebalance_moves_per_second"].GetInt();
+        }
+        
+        // 解析前置探测配置
+        if (doc.HasMember("probe_fronts") && doc["probe_fronts"].IsBool()) {
+            config.probe_fronts = doc["probe_fronts"].GetBool();
+        }
+        
+        if (doc.HasMember("probe_broker_file") && doc["probe_broker_file"].IsString()) {
+            config.probe_broker_file = doc["probe_broker_file"].GetString();
+        }
+        
+        if (doc.HasMember("probe_brokers") && doc["probe_brokers"].IsArray()) {
+            config.probe_brokers.clear();
+            for (const auto& broker : doc["probe_brokers"].GetArray()) {
+                if (broker.IsString()) {
+                    config.probe_brokers.push_back(broker.GetString());
+                }
+            }
+        }
+        
+        if (doc.HasMember("probe_top_k") && doc["probe_top_k"].IsInt()) {
+            config.probe_top_k = doc["probe_top_k"].GetInt();
+        }
+        
+        if (doc.HasMember("probe_timeout_ms") && doc["probe_timeout_ms"].IsInt()) {
+            config.probe_timeout_ms = doc["probe_timeout_ms"].GetInt();
+        }
+        
+        if (doc.HasMember("probe_ctp_login") && doc["probe_ctp_login"].IsBool()) {
+            config.probe_ctp_login = doc["probe_ctp_login"].GetBool();
+        }
+        
+        if (doc.HasMember("probe_instrument") && doc["probe_instrument"].IsString()) {
+            config.probe_instrument = doc["probe_instrument"].GetString();
+        }
+        
+        if (doc.HasMember("probe_report_file") && doc["probe_report_file"].IsString()) {
+            config.probe_report_file = doc["probe_report_file"].GetString();
+        }
+        
+        // 解析合约表加载配置
+        if (doc.HasMember("instrument_query_enabled") && doc["instrument_query_enabled"].IsBool()) {
+            config.instrument_query_enabled = doc["instrument_query_enabled"].GetBool();
+        }
+        
+        if (doc.HasMember("instrument_trade_front") && doc["instrument_trade_front"].IsString()) {
+            config.instrument_trade_front = doc["instrument_trade_front"].GetString();
+        }
+        
+        if (doc.HasMember("instrument_broker_id") && doc["instrument_broker_id"].IsString()) {
+            config.instrument_broker_id = doc["instrument_broker_id"].GetString();
+        }
+        
+        if (doc.HasMember("instrument_user_id") && doc["instrument_user_id"].IsString()) {
+            config.instrument_user_id = doc["instrument_user_id"].GetString();
+        }
+        
+        if (doc.HasMember("instrument_password") && doc["instrument_password"].IsString()) {
+            config.instrument_password = doc["instrument_password"].GetString();
+        }
+        
+        if (doc.HasMember("instrument_app_id") && doc["instrument_app_id"].IsString()) {
+            config.instrument_app_id = doc["instrument_app_id"].GetString();
+        }
+        
+        if (doc.HasMember("instrument_auth_code") && doc["instrument_auth_code"].IsString()) {
+            config.instrument_auth_code = doc["instrument_auth_code"].GetString();
+        }
+        
+        if (doc.HasMember("instrument_cache_file") && doc["instrument_cache_file"].IsString()) {
+            config.instrument_cache_file = doc["instrument_cache_file"].GetString();
+        }
+        
+        if (doc.HasMember("instrument_cache_max_age_hours") && doc["instrument_cache_max_age_hours"].IsInt()) {
+            config.instrument_cache_max_age_hours = doc["instrument_cache_max_age_hours"].GetInt();
+        }
+        
+        if (doc.HasMember("instrument_query_timeout_ms") && doc["instrument_query_timeout_ms"].IsInt()) {
+            config.instrument_query_timeout_ms = doc["instrument_query_timeout_ms"].GetInt();
+        }
+        
+        if (doc.HasMember("instrument_index_capacity") && doc["instrument_index_capacity"].IsInt()) {
+            config.instrument_index_capacity = doc["instrument_index_capacity"].GetInt();
+        }
+        
+        if (doc.HasMember("instrument_index_legacy_map") && doc["instrument_index_legacy_map"].IsBool()) {
+            config.instrument_index_legacy_map = doc["instrument_index_legacy_map"].GetBool();
+        }
+        
+        // 解析行情看板配置
+        if (doc.HasMember("quote_board_enabled") && doc["quote_board_enabled"].IsBool()) {
+            config.quote_board_enabled = doc["quote_board_enabled"].GetBool();
+        }
+        
+        if (doc.HasMember("quote_board_name") && doc["quote_board_name"].IsString()) {
+            config.quote_board_name = doc["quote_board_name"].GetString();
+        }
+        
+        if (doc.HasMember("quote_board_capacity") && doc["quote_board_capacity"].IsInt()) {
+            config.quote_board_capacity = doc["quote_board_capacity"].GetInt();
+        }
+        
+        if (doc.HasMember("tick_ring_enabled") && doc["tick_ring_enabled"].IsBool()) {
+            config.tick_ring_enabled = doc["tick_ring_enabled"].GetBool();
+        }
+        
+        if (doc.HasMember("tick_ring_name") && doc["tick_ring_name"].IsString()) {
+            config.tick_ring_name = doc["tick_ring_name"].GetString();
+        }
+        
+        if (doc.HasMember("tick_ring_capacity") && doc["tick_ring_capacity"].IsInt()) {
+            config.tick_ring_capacity = doc["tick_ring_capacity"].GetInt();
+        }
+        
         // 解析连接配置
         if (doc.HasMember("connections") && doc["connections"].IsArray()) {
             const auto& connections_array = doc["connections"].GetArray();
@@ -113,6 +434,14 @@ bool ConfigLoader::load_from_json(const std::string& json_content, MultiCTPConfi
                     conn_config.enabled = conn_json["enabled"].GetBool();
                 }
                 
+                if (conn_json.HasMember("request_rate") && conn_json["request_rate"].IsInt()) {
+                    conn_config.request_rate = conn_json["request_rate"].GetInt();
+                }
+                
+                if (conn_json.HasMember("request_burst") && conn_json["request_burst"].IsInt()) {
+                    conn_config.request_burst = conn_json["request_burst"].GetInt();
+                }
+                
                 config.connections.push_back(conn_config);
             }
         }
@@ -151,11 +480,100 @@ bool ConfigLoader::validate_config(const MultiCTPConfig& config)
         return false;
     }
     
-    if (config.connections.empty()) {
+    // 检查Redis分片配置
+    std::set<std::string> redis_endpoints;
+    for (const auto& endpoint : config.redis_endpoints) {
+        if (endpoint.host.empty() || endpoint.port <= 0 || endpoint.port > 65535) {
+            std::cerr << "Invalid Redis endpoint: " << endpoint.host << ":" << endpoint.port << std::endl;
+            return false;
+        }
+        
+        std::string name = endpoint.host + ":" + std::to_string(endpoint.port);
+        if (!redis_endpoints.insert(name).second) {
+            std::cerr << "Duplicate Redis endpoint: " << name << std::endl;
+            return false;
+        }
+        
+        if (endpoint.weight <= 0) {
+            std::cerr << "Invalid weight for Redis endpoint: " << name << std::endl;
+            return false;
+        }
+    }
+    
+    // 开启前置探测时连接集合由探测结果生成，配置中可以不写连接
+    if (config.connections.empty() && !config.probe_fronts) {
         std::cerr << "No CTP connections configured" << std::endl;
         return false;
     }
     
+    if (config.rate_balance_interval < 0 || config.rate_balance_max_moves <= 0 || config.rate_balance_tolerance < 0) {
+        std::cerr << "Invalid rate_balance_interval/rate_balance_max_moves/rate_balance_tolerance" << std::endl;
+        return false;
+    }
+    
+    if (config.subscription_linger_seconds < 0 || config.subscription_linger_max_per_connection < 0) {
+        std::cerr << "Invalid subscription linger configuration" << std::endl;
+        return false;
+    }
+    
+    if (config.subscription_universe_save_interval <= 0 || config.subscription_universe_grace < 0) {
+        std::cerr << "Invalid subscription universe configuration" << std::endl;
+        return false;
+    }
+    
+    if (config.watchdog_interval_ms <= 0 || config.watchdog_min_silence_ms <= 0 ||
+        config.watchdog_max_silence_ms < config.watchdog_min_silence_ms || config.watchdog_silence_factor <= 0) {
+        std::cerr << "Invalid watchdog configuration" << std::endl;
+        return false;
+    }
+    
+    for (const auto& session : config.watchdog_sessions) {
+        int start_minute = 0, end_minute = 0;
+        if (!TickWatchdog::parse_session(session, start_minute, end_minute)) {
+            std::cerr << "Invalid watchdog session: " << session << std::endl;
+            return false;
+        }
+    }
+    
+    if (config.rebalance_interval < 0 || config.rebalance_moves_per_second <= 0) {
+        std::cerr << "Invalid rebalance_interval/rebalance_moves_per_second" << std::endl;
+        return false;
+    }
+    
+    if (config.probe_fronts && (config.probe_top_k <= 0 || config.probe_timeout_ms <= 0)) {
+        std::cerr << "Invalid probe_top_k/probe_timeout_ms" << std::endl;
+        return false;
+    }
+    
+    if (config.instrument_query_enabled) {
+        if (config.instrument_trade_front.empty() || config.instrument_broker_id.empty()) {
+            std::cerr << "instrument_trade_front and instrument_broker_id are required for instrument query" << std::endl;
+            return false;
+        }
+        if (config.instrument_cache_max_age_hours < 0 || config.instrument_query_timeout_ms <= 0) {
+            std::cerr << "Invalid instrument_cache_max_age_hours/instrument_query_timeout_ms" << std::endl;
+            return false;
+        }
+    }
+    
+    if (config.instrument_index_capacity <= 0 || config.instrument_index_capacity > (1 << 24)) {
+        std::cerr << "Invalid instrument_index_capacity" << std::endl;
+        return false;
+    }
+    
+    if (config.quote_board_enabled && (config.quote_board_name.empty() || config.quote_board_capacity <= 0)) {
+        std::cerr << "Invalid quote_board_name/quote_board_capacity" << std::endl;
+        return false;
+    }
+    
+    if (config.tick_ring_enabled) {
+        if (config.tick_ring_name.empty() || config.tick_ring_capacity <= 0 ||
+            (config.tick_ring_capacity & (config.tick_ring_capacity - 1)) != 0) {
+            std::cerr << "Invalid tick_ring_name/tick_ring_capacity (capacity must be a power of two)" << std::endl;
+            return false;
+        }
+    }
+    
     // 检查连接配置
     std::set<std::string> connection_ids;
     for (const auto& conn : config.connections) {
@@ -184,6 +602,11 @@ bool ConfigLoader::validate_config(const MultiCTPConfig& config)
             std::cerr << "Invalid max_subscriptions for connection: " << conn.connection_id << std::endl;
             return false;
         }
+        
+        if (conn.request_rate <= 0 || conn.request_burst <= 0) {
+            std::cerr << "Invalid request_rate/request_burst for connection: " << conn.connection_id << std::endl;
+            return false;
+        }
     }
     
     return true;
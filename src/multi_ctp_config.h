@@ -18,6 +18,8 @@ struct CTPConnectionConfig {
     int max_subscriptions = 500;  // 每个连接最大订阅数
     int priority = 1;             // 连接优先级（1-10，数字越小优先级越高）
     bool enabled = true;          // 是否启用此连接
+    int request_rate = 10;        // 每秒最多下发的订阅请求数（一次数组调用计一次）
+    int request_burst = 10;       // 令牌桶容量
 };
 
 // 负载均衡策略
@@ -25,7 +27,35 @@ enum class LoadBalanceStrategy {
     ROUND_ROBIN = 0,    // 轮询
     LEAST_CONNECTIONS,  // 最少连接数
     CONNECTION_QUALITY, // 连接质量优先
-    HASH_BASED         // 基于合约ID的哈希
+    HASH_BASED,        // 基于合约ID的哈希
+    LATENCY            // 实测行情延迟最低优先
+};
+
+// 冗余订阅模式
+enum class RedundancyMode {
+    NONE = 0,   // 每个合约只在一个前置订阅
+    ALL,        // 所有合约同时在主、备两个前置订阅
+    HOT_SET     // 仅redundant_instruments中的合约双前置订阅
+};
+
+// Redis节点配置（分片）
+struct RedisEndpointConfig {
+    std::string host;
+    int port = 6379;
+    int weight = 1;               // 一致性哈希权重
+};
+
+// Redis发布模式
+enum class RedisPublishMode {
+    NONE = 0,     // 不发布
+    INSTRUMENT,   // 每个合约一个频道: {prefix}{SHFE.rb2501}
+    EXCHANGE      // 每个交易所一个频道: {prefix}{SHFE}
+};
+
+// 历史tick存储格式
+enum class HistoryFormat {
+    JSON = 0,   // 完整JSON（与推送格式一致）
+    BINARY      // 紧凑二进制编码（见QuoteCodec）
 };
 
 // 多CTP连接配置
@@ -34,6 +64,25 @@ struct MultiCTPConfig {
     int websocket_port = 7799;
     std::string redis_host = "192.168.2.27";
     int redis_port = 6379;
+    std::vector<RedisEndpointConfig> redis_endpoints; // 多节点分片，为空时使用redis_host/redis_port
+    int redis_pipeline_batch = 500;               // 每次管道写入的最大tick数
+    int redis_queue_limit = 100000;               // 每个节点写队列上限，超出后转入溢出文件
+    
+    // Redis故障溢出配置
+    std::string redis_spill_dir = "./redis_spill"; // 本地溢出文件目录（按交易日分文件）
+    int redis_spill_size_mb = 256;                 // 单个溢出文件大小上限(MB)
+    int redis_replay_rate = 5000;                  // 恢复后回放速率(条/秒)
+    int redis_reconnect_max_backoff = 30;          // 重连最大退避间隔(秒)
+    HistoryFormat history_format = HistoryFormat::JSON; // 历史tick存储格式
+    
+    // 发布配置：与历史写入同一管道批次PUBLISH
+    RedisPublishMode redis_publish_mode = RedisPublishMode::NONE;
+    std::string redis_publish_prefix = "md:";     // 频道前缀
+    int redis_publish_conflation_ms = 0;          // 合并窗口(毫秒)，0表示逐笔发布
+    
+    // 预热配置：启动时从Redis加载最新行情
+    bool warm_start = true;
+    std::vector<std::string> warm_start_instruments; // 额外预热的合约（共享内存合约表之外）
     
     // 连接配置列表
     std::vector<CTPConnectionConfig> connections;
@@ -46,6 +95,76 @@ struct MultiCTPConfig {
     int maintenance_interval = 60;      // 维护间隔(秒)  
     int max_retry_count = 3;           // 最大重试次数
     bool auto_failover = true;         // 是否开启自动故障转移
+    
+    // 行情静默检测：连接未断开但不再推送行情时判定为降级并故障转移
+    bool watchdog_enabled = true;
+    int watchdog_interval_ms = 50;                   // 检测周期(毫秒)
+    int watchdog_min_silence_ms = 300;               // 静默阈值下限(毫秒)
+    int watchdog_max_silence_ms = 10000;             // 静默阈值上限(毫秒)
+    double watchdog_silence_factor = 20.0;           // 阈值 = factor * 平均到达间隔
+    double watchdog_min_rate = 0.5;                  // 行情频率低于该值(条/秒)的连接不检测
+    int watchdog_restart_after = 30;                 // 降级超过该时间(秒)后重启连接
+    std::vector<std::string> watchdog_sessions = {   // 检测的交易时段（本地时间）
+        "09:00-10:15", "10:30-11:30", "13:30-15:00", "21:00-23:00"
+    };
+    
+    // 双前置热备：同一合约在两个前置同时订阅，行情先到先转发
+    RedundancyMode redundancy_mode = RedundancyMode::NONE;
+    std::vector<std::string> redundant_instruments;  // HOT_SET模式下的热点合约
+    
+    // 按行情频率均衡：定期把订阅从高频负载的连接迁往低负载连接（先订阅新连接再退订旧连接）
+    int rate_balance_interval = 0;                   // 规划间隔(秒)，0表示关闭
+    int rate_balance_max_moves = 20;                 // 每次规划最多迁移的合约数
+    double rate_balance_tolerance = 0.2;             // 最高与最低负载之差不超过平均负载的该比例时不迁移
+    
+    // 重新均衡：前置恢复时及定时把订阅迁回配置的分布（哈希环归属 / 按max_subscriptions比例）
+    int rebalance_interval = 0;                      // 定时均衡间隔(秒)，0表示只在恢复时均衡
+    int rebalance_moves_per_second = 20;             // 迁移限速
+    
+    // 保留订阅：最后一个客户端退订后继续订阅一段时间，期间重新订阅无需CTP请求
+    int subscription_linger_seconds = 300;            // 保留时间(秒)，0为关闭
+    int subscription_linger_max_per_connection = 200; // 每个前置最多保留的合约数
+    
+    // 订阅集合持久化：重启后各前置登录即批量恢复，不等客户端重连
+    std::string subscription_universe_file = "subscription_universe.json";  // 为空时关闭
+    int subscription_universe_save_interval = 60;     // 保存间隔(秒)
+    int subscription_universe_grace = 600;            // 恢复的订阅等待客户端的时间(秒)
+    
+    // 前置探测：启动时从broker_data.json探测候选前置，取最快的前K个作为连接集合
+    bool probe_fronts = false;
+    std::string probe_broker_file = "config/broker_data.json";
+    std::vector<std::string> probe_brokers;          // 只探测指定brokerid，为空时探测全部
+    int probe_top_k = 3;
+    int probe_timeout_ms = 3000;                     // 整体截止时间(毫秒)
+    bool probe_ctp_login = false;                    // 是否对TCP可达的前置执行CTP登录
+    std::string probe_instrument;                    // 登录后订阅该合约，按首个tick新鲜度排序
+    std::string probe_report_file = "front_probe_report.json";
+    
+    // 合约表加载：启动时通过交易前置ReqQryInstrument查询全部合约写入共享内存合约表，结果缓存到本地文件
+    bool instrument_query_enabled = false;
+    std::string instrument_trade_front;              // 交易前置地址，如tcp://180.168.146.187:10201
+    std::string instrument_broker_id;
+    std::string instrument_user_id;
+    std::string instrument_password;
+    std::string instrument_app_id;                   // 看穿式监管认证，auth_code为空时不认证
+    std::string instrument_auth_code;
+    std::string instrument_cache_file = "instrument_cache.json";  // 为空时不缓存
+    int instrument_cache_max_age_hours = 12;         // 缓存有效期(小时)，超过后重新查询
+    int instrument_query_timeout_ms = 30000;         // 登录加查询的整体截止时间(毫秒)
+    
+    // 合约哈希索引：qamddata段中的定容开放寻址表，槽号可作为稠密合约编号
+    int instrument_index_capacity = 20000;           // 最多容纳的合约数，段中已有索引时沿用其容量
+    bool instrument_index_legacy_map = true;         // 迁移期间同时维护InsMap，供尚未切换的读取进程使用
+    
+    // 行情看板：每个合约的最新标准化行情写入定长共享内存数组（每槽seqlock），同机进程用quote_board_reader.h读取
+    bool quote_board_enabled = false;
+    std::string quote_board_name = "qamdquote";
+    int quote_board_capacity = 20000;                // 最多容纳的合约数
+    
+    // tick广播环：全部tick按序写入共享内存环形缓冲区，同机多个进程用tick_ring_reader.h各自按序读取
+    bool tick_ring_enabled = false;
+    std::string tick_ring_name = "qamdticks";
+    int tick_ring_capacity = 32768;                  // 环中保留的tick条数，须为2的幂
 };
 
 // 配置加载器
@@ -0,0 +1,61 @@
+/////////////////////////////////////////////////////////////////////////
+///@file normalized_quote.h
+///@brief	标准化行情结构（定长POD，可直接用于磁盘和共享内存）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+// 价格字段存在位：对应JSON中非null的价格字段
+enum NormalizedQuoteField : uint32_t {
+    kQuoteAskPrice1 = 1u << 0,   // ask_price1..5 依次为 bit0..bit4
+    kQuoteBidPrice1 = 1u << 5,   // bid_price1..5 依次为 bit5..bit9
+    kQuoteLastPrice = 1u << 10,
+    kQuoteHighest = 1u << 11,
+    kQuoteLowest = 1u << 12,
+    kQuoteOpen = 1u << 13,
+    kQuoteClose = 1u << 14,
+    kQuoteSettlement = 1u << 15,
+    kQuoteUpperLimit = 1u << 16,
+    kQuoteLowerLimit = 1u << 17,
+    kQuotePreSettlement = 1u << 18,
+    kQuotePreClose = 1u << 19
+};
+
+const int kQuoteDepthLevels = 5;
+
+// 标准化行情：价格已按0.01取整，无效价格对应位为0
+struct NormalizedQuote {
+    char instrument_id[32];     // CTP合约代码（不带交易所前缀）
+    char trading_day[9];        // YYYYMMDD
+    char update_time[9];        // HH:MM:SS
+    int32_t update_millisec;
+    int64_t timestamp_ms;       // TradingDay + UpdateTime 对应的毫秒时间戳
+
+    uint32_t present_mask;      // NormalizedQuoteField 组合
+
+    double ask_price[kQuoteDepthLevels];
+    int32_t ask_volume[kQuoteDepthLevels];
+    double bid_price[kQuoteDepthLevels];
+    int32_t bid_volume[kQuoteDepthLevels];
+
+    double last_price;
+    double highest;
+    double lowest;
+    double open;
+    double close;
+    double settlement;
+    double upper_limit;
+    double lower_limit;
+    double pre_settlement;
+    double pre_close;
+
+    int64_t volume;
+    double amount;
+    int64_t open_interest;
+    int64_t pre_open_interest;
+
+    bool has(uint32_t field) const { return (present_mask & field) != 0; }
+};
@@ -0,0 +1,207 @@
+/////////////////////////////////////////////////////////////////////////
+///@file quote_board.cpp
+///@brief	共享内存行情看板写入端实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "quote_board.h"
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <new>
+
+QuoteBoard::QuoteBoard()
+    : header_(nullptr)
+    , slots_(nullptr)
+    , slot_bucket_mask_(0)
+{
+}
+
+QuoteBoard::~QuoteBoard()
+{
+    close();
+}
+
+bool QuoteBoard::open(const std::string& name, uint32_t capacity, std::string& error)
+{
+    close();
+    namespace bip = boost::interprocess;
+    
+    bool reusable = false;
+    try {
+        shm_ = std::make_unique<bip::shared_memory_object>(bip::open_or_create, name.c_str(), bip::read_write);
+        bip::offset_t current_size = 0;
+        shm_->get_size(current_size);
+        if (static_cast<size_t>(current_size) >= sizeof(QuoteBoardHeader)) {
+            // 先按原大小映射校验头部，有效的看板不截断也不清零，已映射的读取端继续可用
+            region_ = std::make_unique<bip::mapped_region>(*shm_, bip::read_write);
+            const QuoteBoardHeader* existing = static_cast<const QuoteBoardHeader*>(region_->get_address());
+            reusable = existing->magic == kQuoteBoardMagic && existing->version == kQuoteBoardVersion &&
+                       existing->slot_size == sizeof(QuoteBoardSlot) && existing->capacity > 0 &&
+                       quote_board_size(existing->capacity) <= region_->get_size() &&
+                       existing->instrument_count.load() <= existing->capacity;
+        }
+        if (!reusable) {
+            region_.reset();
+            shm_->truncate(quote_board_size(capacity));
+            region_ = std::make_unique<bip::mapped_region>(*shm_, bip::read_write);
+        }
+    } catch (const bip::interprocess_exception& e) {
+        error = e.what();
+        region_.reset();
+        shm_.reset();
+        return false;
+    }
+    
+    header_ = static_cast<QuoteBoardHeader*>(region_->get_address());
+    slots_ = quote_board_slots(header_);
+    if (!reusable) {
+        initialize(capacity);
+    }
+    
+    uint32_t bucket_count = 1;
+    while (bucket_count < header_->capacity * 2u) {
+        bucket_count <<= 1;
+    }
+    slot_buckets_.reset(new std::atomic<uint32_t>[bucket_count]);
+    for (uint32_t i = 0; i < bucket_count; ++i) {
+        slot_buckets_[i].store(0, std::memory_order_relaxed);
+    }
+    slot_bucket_mask_ = bucket_count - 1;
+    
+    // 沿用已有槽位：重建索引，上次退出时写到一半的槽位恢复为偶数
+    uint32_t count = header_->instrument_count.load();
+    for (uint32_t i = 0; i < count; ++i) {
+        slots_[i].instrument_id[sizeof(slots_[i].instrument_id) - 1] = '\0';
+        index_slot(std::hash<std::string_view>()(slots_[i].instrument_id), i);
+        uint64_t sequence = slots_[i].sequence.load();
+        if (sequence & 1) {
+            slots_[i].sequence.store(sequence + 1, std::memory_order_release);
+        }
+    }
+    return true;
+}
+
+void QuoteBoard::initialize(uint32_t capacity)
+{
+    // 新建或布局不符：清零后重新初始化，magic最后写入
+    memset(static_cast<void*>(header_), 0, quote_board_size(capacity));
+    new (&header_->instrument_count) std::atomic<uint32_t>(0);
+    for (uint32_t i = 0; i < capacity; ++i) {
+        new (&slots_[i].sequence) std::atomic<uint64_t>(0);
+    }
+    header_->version = kQuoteBoardVersion;
+    header_->capacity = capacity;
+    header_->slot_size = sizeof(QuoteBoardSlot);
+    header_->created_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = kQuoteBoardMagic;
+}
+
+void QuoteBoard::close()
+{
+    region_.reset();
+    shm_.reset();
+    header_ = nullptr;
+    slots_ = nullptr;
+    slot_buckets_.reset();
+    slot_bucket_mask_ = 0;
+}
+
+uint32_t QuoteBoard::get_instrument_count() const
+{
+    return header_ ? header_->instrument_count.load(std::memory_order_relaxed) : 0;
+}
+
+// 槽位中的合约代码最多保存31个字符，查找和哈希都按同样截断后的代码进行
+static std::string_view slot_key(const std::string& instrument_id)
+{
+    return std::string_view(instrument_id).substr(0, sizeof(QuoteBoardSlot::instrument_id) - 1);
+}
+
+int QuoteBoard::find_slot(size_t hash, std::string_view key) const
+{
+    uint32_t pos = static_cast<uint32_t>(hash) & slot_bucket_mask_;
+    while (true) {
+        uint32_t slot = slot_buckets_[pos].load(std::memory_order_acquire);
+        if (slot == 0) {
+            return -1;
+        }
+        if (key == slots_[slot - 1].instrument_id) {
+            return static_cast<int>(slot - 1);
+        }
+        pos = (pos + 1) & slot_bucket_mask_;
+    }
+}
+
+void QuoteBoard::index_slot(size_t hash, uint32_t slot)
+{
+    uint32_t pos = static_cast<uint32_t>(hash) & slot_bucket_mask_;
+    while (slot_buckets_[pos].load(std::memory_order_relaxed) != 0) {
+        pos = (pos + 1) & slot_bucket_mask_;
+    }
+    slot_buckets_[pos].store(slot + 1, std::memory_order_release);
+}
+
+int QuoteBoard::find_or_allocate_slot(const std::string& instrument_id, bool& created)
+{
+    std::string_view key = slot_key(instrument_id);
+    size_t hash = std::hash<std::string_view>()(key);
+    int index = find_slot(hash, key);
+    if (index >= 0) {
+        return index;
+    }
+    
+    // 首次出现的合约：加锁后复查，避免两个前置线程为同一合约各分配一个槽位
+    std::lock_guard<std::mutex> lock(allocate_mutex_);
+    index = find_slot(hash, key);
+    if (index >= 0) {
+        return index;
+    }
+    
+    uint32_t count = header_->instrument_count.load(std::memory_order_relaxed);
+    if (count >= header_->capacity) {
+        return -1;
+    }
+    
+    // 合约代码先写入槽位，再发布计数和索引桶，读取端扫描时总能看到完整的代码
+    QuoteBoardSlot& slot = slots_[count];
+    memset(slot.instrument_id, 0, sizeof(slot.instrument_id));
+    memcpy(slot.instrument_id, key.data(), key.size());
+    header_->instrument_count.store(count + 1, std::memory_order_release);
+    index_slot(hash, count);
+    
+    created = true;
+    return static_cast<int>(count);
+}
+
+int QuoteBoard::publish(const std::string& instrument_id, const NormalizedQuote& quote, bool& created)
+{
+    created = false;
+    if (!header_) {
+        return -1;
+    }
+    
+    int index = find_or_allocate_slot(instrument_id, created);
+    if (index < 0) {
+        return -1;
+    }
+    
+    // 多个前置线程可能同时写同一合约：以CAS把序号置为奇数取得写权，写完加一回到偶数
+    QuoteBoardSlot& slot = slots_[index];
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    while ((sequence & 1) ||
+           !slot.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire,
+                                                std::memory_order_relaxed)) {
+        sequence = slot.sequence.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    memcpy(&slot.quote, &quote, sizeof(quote));
+    slot.update_count++;
+    
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    return index;
+}
@@ -0,0 +1,52 @@
+/////////////////////////////////////////////////////////////////////////
+///@file quote_board.h
+///@brief	共享内存行情看板写入端
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "quote_board_layout.h"
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// 行情看板：每个合约一个定长槽位保存最新的标准化行情，同机进程通过quote_board_reader.h只读映射。
+// 网关重启时沿用已有的共享内存对象和槽位分配，已映射的读取端不需要重新查找槽号。
+// 合约到槽号的解析走本进程的只增开放寻址表，行情线程查找不加锁；只有首次分配槽位时加锁。
+class QuoteBoard
+{
+public:
+    QuoteBoard();
+    ~QuoteBoard();
+
+    // 创建或打开共享内存对象；已有对象头部有效时原样沿用（容量以已有对象为准），否则按capacity初始化
+    bool open(const std::string& name, uint32_t capacity, std::string& error);
+    void close();
+    bool is_open() const { return header_ != nullptr; }
+
+    // 写入一个合约的最新行情，返回槽号；看板已满时返回-1。created表示本次新分配了槽位
+    int publish(const std::string& instrument_id, const NormalizedQuote& quote, bool& created);
+
+    uint32_t get_capacity() const { return header_ ? header_->capacity : 0; }
+    uint32_t get_instrument_count() const;
+
+private:
+    int find_slot(size_t hash, std::string_view key) const;
+    int find_or_allocate_slot(const std::string& instrument_id, bool& created);
+    void index_slot(size_t hash, uint32_t slot);
+    void initialize(uint32_t capacity);
+
+    std::unique_ptr<boost::interprocess::shared_memory_object> shm_;
+    std::unique_ptr<boost::interprocess::mapped_region> region_;
+    QuoteBoardHeader* header_;
+    QuoteBoardSlot* slots_;
+
+    // 合约 -> 槽号的开放寻址桶，存槽号+1，0为空桶；只在分配新槽位时写入
+    std::unique_ptr<std::atomic<uint32_t>[]> slot_buckets_;
+    uint32_t slot_bucket_mask_;
+    std::mutex allocate_mutex_;
+};
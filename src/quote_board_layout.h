@@ -0,0 +1,55 @@
+/////////////////////////////////////////////////////////////////////////
+///@file quote_board_layout.h
+///@brief	共享内存行情看板布局（网关与本地读取端共用）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "normalized_quote.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// 共享内存对象布局：QuoteBoardHeader 后紧跟 capacity 个 QuoteBoardSlot，偏移固定。
+// 槽位按合约首次出现的顺序分配，分配后合约不变，读取端查到一次槽号即可一直使用。
+// 每个槽位一个seqlock：sequence为奇数表示正在写入，读取端在前后两次读到相同的偶数时数据有效。
+
+const uint64_t kQuoteBoardMagic = 0x31304251444d4151ULL;   // "QAMDQB01"
+const uint32_t kQuoteBoardVersion = 1;
+const char* const kQuoteBoardDefaultName = "qamdquote";
+
+struct alignas(64) QuoteBoardHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t slot_size;
+    uint32_t reserved;
+    std::atomic<uint32_t> instrument_count;   // 已分配的槽位数，槽位的合约代码先于计数写入
+    int64_t created_ms;
+};
+
+struct alignas(64) QuoteBoardSlot {
+    std::atomic<uint64_t> sequence;
+    uint64_t update_count;
+    char instrument_id[32];                   // 带交易所前缀的显示格式，如SHFE.rb2501
+    NormalizedQuote quote;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "seqlock requires lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "quote board requires lock-free 32-bit atomics");
+
+inline size_t quote_board_size(uint32_t capacity)
+{
+    return sizeof(QuoteBoardHeader) + static_cast<size_t>(capacity) * sizeof(QuoteBoardSlot);
+}
+
+inline QuoteBoardSlot* quote_board_slots(QuoteBoardHeader* header)
+{
+    return reinterpret_cast<QuoteBoardSlot*>(reinterpret_cast<char*>(header) + sizeof(QuoteBoardHeader));
+}
+
+inline const QuoteBoardSlot* quote_board_slots(const QuoteBoardHeader* header)
+{
+    return reinterpret_cast<const QuoteBoardSlot*>(reinterpret_cast<const char*>(header) + sizeof(QuoteBoardHeader));
+}
@@ -0,0 +1,132 @@
+/////////////////////////////////////////////////////////////////////////
+///@file quote_board_reader.h
+///@brief	共享内存行情看板读取端（仅头文件，供同机策略进程使用）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// 用法：
+//   QuoteBoardReader board;
+//   if (board.open()) {
+//       int slot = board.find("SHFE.rb2501");      // 查一次，之后复用槽号
+//       NormalizedQuote quote;
+//       if (slot >= 0 && board.read(slot, quote)) { ... }
+//   }
+// 读取不经过socket和JSON，不加锁，只在写入恰好发生时重试。链接时需要 -lrt（旧版glibc）。
+
+#include "quote_board_layout.h"
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class QuoteBoardReader
+{
+public:
+    QuoteBoardReader() : header_(nullptr), mapped_size_(0) {}
+    ~QuoteBoardReader() { close(); }
+
+    QuoteBoardReader(const QuoteBoardReader&) = delete;
+    QuoteBoardReader& operator=(const QuoteBoardReader&) = delete;
+
+    // 只读映射网关创建的看板，网关未启动或版本不符时返回false
+    bool open(const char* name = kQuoteBoardDefaultName)
+    {
+        close();
+        std::string shm_name = std::string("/") + name;
+        int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(QuoteBoardHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return false;
+        }
+
+        header_ = static_cast<const QuoteBoardHeader*>(addr);
+        mapped_size_ = st.st_size;
+        if (header_->magic != kQuoteBoardMagic || header_->version != kQuoteBoardVersion ||
+            header_->slot_size != sizeof(QuoteBoardSlot) ||
+            quote_board_size(header_->capacity) > mapped_size_) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if (header_) {
+            munmap(const_cast<QuoteBoardHeader*>(header_), mapped_size_);
+            header_ = nullptr;
+            mapped_size_ = 0;
+        }
+    }
+
+    bool is_open() const { return header_ != nullptr; }
+
+    // 已分配的槽位数（随新合约出现增长）
+    uint32_t size() const
+    {
+        return header_ ? header_->instrument_count.load(std::memory_order_acquire) : 0;
+    }
+
+    // 按显示格式合约代码查找槽号，未找到返回-1；线性扫描，只应在初始化时调用
+    int find(const char* instrument_id) const
+    {
+        uint32_t count = size();
+        const QuoteBoardSlot* slots = header_ ? quote_board_slots(header_) : nullptr;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (strncmp(slots[i].instrument_id, instrument_id, sizeof(slots[i].instrument_id)) == 0) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    const char* instrument_at(int slot) const
+    {
+        return (slot >= 0 && static_cast<uint32_t>(slot) < size()) ? quote_board_slots(header_)[slot].instrument_id : nullptr;
+    }
+
+    // 读取一个槽位的最新行情；update_count返回该槽位累计写入次数，可用于判断是否有新行情
+    bool read(int slot, NormalizedQuote& quote, uint64_t* update_count = nullptr) const
+    {
+        if (slot < 0 || static_cast<uint32_t>(slot) >= size()) {
+            return false;
+        }
+        // 写入端写一个槽位只需几十纳秒；一直为奇数说明网关写到一半时退出，不再等待
+        const QuoteBoardSlot& entry = quote_board_slots(header_)[slot];
+        for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+            uint64_t before = entry.sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            memcpy(&quote, &entry.quote, sizeof(quote));
+            uint64_t count = entry.update_count;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry.sequence.load(std::memory_order_relaxed) == before) {
+                if (update_count) {
+                    *update_count = count;
+                }
+                return before != 0;
+            }
+        }
+        return false;
+    }
+
+private:
+    static const int kMaxReadAttempts = 100000;
+
+    const QuoteBoardHeader* header_;
+    size_t mapped_size_;
+};
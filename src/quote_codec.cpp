@@ -0,0 +1,413 @@
+/////////////////////////////////////////////////////////////////////////
+///@file quote_codec.cpp
+///@brief	行情标准化与紧凑二进制编解码实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "quote_codec.h"
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+// 价格有效性检查：大于1e-6且小于1e300
+bool is_valid_price(double price)
+{
+    return price > 1e-6 && price < 1e300;
+}
+
+// 定长CTP字段拷贝到定长数组，截断并补结尾'\0'
+template <size_t N, size_t M>
+void copy_field(char (&dest)[N], const char (&src)[M])
+{
+    size_t len = strnlen(src, M);
+    len = std::min(len, N - 1);
+    memcpy(dest, src, len);
+    dest[len] = '\0';
+}
+
+double round_price(double price)
+{
+    return round(price * 100.0) / 100.0;
+}
+
+int64_t to_fixed(double price)
+{
+    return llround(price * 100.0);
+}
+
+uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void put_varint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool get_varint(const char*& cursor, const char* end, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*cursor++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 除昨结算外的标量价格字段，编码顺序固定
+struct ScalarPriceField {
+    uint32_t bit;
+    double NormalizedQuote::*member;
+};
+
+const ScalarPriceField kScalarPriceFields[] = {
+    {kQuoteLastPrice, &NormalizedQuote::last_price},
+    {kQuoteHighest, &NormalizedQuote::highest},
+    {kQuoteLowest, &NormalizedQuote::lowest},
+    {kQuoteOpen, &NormalizedQuote::open},
+    {kQuoteClose, &NormalizedQuote::close},
+    {kQuoteSettlement, &NormalizedQuote::settlement},
+    {kQuoteUpperLimit, &NormalizedQuote::upper_limit},
+    {kQuoteLowerLimit, &NormalizedQuote::lower_limit},
+    {kQuotePreClose, &NormalizedQuote::pre_close},
+};
+
+void add_price(rapidjson::Value& obj, const char* name, bool present, double price,
+               rapidjson::Document::AllocatorType& allocator)
+{
+    if (present) {
+        obj.AddMember(rapidjson::StringRef(name), price, allocator);
+    } else {
+        obj.AddMember(rapidjson::StringRef(name), rapidjson::Value().SetNull(), allocator);
+    }
+}
+
+} // namespace
+
+void QuoteCodec::normalize(const CThostFtdcDepthMarketDataField& md, NormalizedQuote& quote)
+{
+    memset(&quote, 0, sizeof(quote));
+
+    copy_field(quote.instrument_id, md.InstrumentID);
+    copy_field(quote.trading_day, md.TradingDay);
+    copy_field(quote.update_time, md.UpdateTime);
+    quote.update_millisec = md.UpdateMillisec;
+
+    // 计算毫秒时间戳
+    std::string trading_day = quote.trading_day;
+    std::string update_time = quote.update_time;
+    try {
+        if (trading_day.size() >= 8 && update_time.size() >= 8) {
+            std::tm tm_struct = {};
+            tm_struct.tm_year = std::stoi(trading_day.substr(0, 4)) - 1900;
+            tm_struct.tm_mon = std::stoi(trading_day.substr(4, 2)) - 1;
+            tm_struct.tm_mday = std::stoi(trading_day.substr(6, 2));
+            tm_struct.tm_hour = std::stoi(update_time.substr(0, 2));
+            tm_struct.tm_min = std::stoi(update_time.substr(3, 2));
+            tm_struct.tm_sec = std::stoi(update_time.substr(6, 2));
+
+            std::time_t time_t_val = std::mktime(&tm_struct);
+            auto time_point = std::chrono::system_clock::from_time_t(time_t_val);
+            quote.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                time_point.time_since_epoch()).count() + md.UpdateMillisec;
+        } else {
+            // 解析失败时使用当前时间戳
+            quote.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    } catch (const std::exception& e) {
+        // 异常时使用当前时间戳
+        quote.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    const double ask_prices[kQuoteDepthLevels] = {md.AskPrice1, md.AskPrice2, md.AskPrice3, md.AskPrice4, md.AskPrice5};
+    const int ask_volumes[kQuoteDepthLevels] = {md.AskVolume1, md.AskVolume2, md.AskVolume3, md.AskVolume4, md.AskVolume5};
+    const double bid_prices[kQuoteDepthLevels] = {md.BidPrice1, md.BidPrice2, md.BidPrice3, md.BidPrice4, md.BidPrice5};
+    const int bid_volumes[kQuoteDepthLevels] = {md.BidVolume1, md.BidVolume2, md.BidVolume3, md.BidVolume4, md.BidVolume5};
+
+    for (int i = 0; i < kQuoteDepthLevels; ++i) {
+        if (is_valid_price(ask_prices[i])) {
+            quote.present_mask |= kQuoteAskPrice1 << i;
+            quote.ask_price[i] = round_price(ask_prices[i]);
+            quote.ask_volume[i] = ask_volumes[i];
+        }
+        if (is_valid_price(bid_prices[i])) {
+            quote.present_mask |= kQuoteBidPrice1 << i;
+            quote.bid_price[i] = round_price(bid_prices[i]);
+            quote.bid_volume[i] = bid_volumes[i];
+        }
+    }
+
+    const double scalar_prices[] = {
+        md.LastPrice, md.HighestPrice, md.LowestPrice, md.OpenPrice, md.ClosePrice,
+        md.SettlementPrice, md.UpperLimitPrice, md.LowerLimitPrice, md.PreClosePrice
+    };
+    for (size_t i = 0; i < sizeof(kScalarPriceFields) / sizeof(kScalarPriceFields[0]); ++i) {
+        if (is_valid_price(scalar_prices[i])) {
+            quote.present_mask |= kScalarPriceFields[i].bit;
+            quote.*(kScalarPriceFields[i].member) = round_price(scalar_prices[i]);
+        }
+    }
+
+    if (is_valid_price(md.PreSettlementPrice)) {
+        quote.present_mask |= kQuotePreSettlement;
+        quote.pre_settlement = round_price(md.PreSettlementPrice);
+    }
+
+    quote.volume = md.Volume;
+    quote.amount = md.Turnover;
+    quote.open_interest = static_cast<int64_t>(md.OpenInterest);
+    quote.pre_open_interest = static_cast<int64_t>(md.PreOpenInterest);
+}
+
+rapidjson::Value QuoteCodec::to_json(const NormalizedQuote& quote,
+                                     const std::string& display_instrument,
+                                     rapidjson::Document::AllocatorType& allocator)
+{
+    rapidjson::Value inst_data(rapidjson::kObjectType);
+
+    // 1. instrument_id
+    inst_data.AddMember("instrument_id", rapidjson::Value(display_instrument.c_str(), allocator), allocator);
+
+    // 2. datetime - 合并trading_day和update_time，格式 YYYY-MM-DD HH:MM:SS.xxxxx （秒后5位）
+    {
+        std::string trading_day = quote.trading_day;
+        std::string update_time = quote.update_time;
+        if (update_time.empty()) {
+            update_time = "00:00:00";
+        }
+
+        std::string date_part;
+        if (trading_day.size() >= 8) {
+            date_part = trading_day.substr(0, 4) + "-" +
+                        trading_day.substr(4, 2) + "-" +
+                        trading_day.substr(6, 2);
+        } else {
+            date_part = trading_day; // 保留原始值，避免越界
+        }
+
+        std::ostringstream oss;
+        oss << date_part << " " << update_time << ".";
+        oss << std::setw(5) << std::setfill('0') << quote.update_millisec * 100; // ms -> 5位小数
+        inst_data.AddMember("datetime", rapidjson::Value(oss.str().c_str(), allocator), allocator);
+    }
+
+    // 3. 卖价和卖量（ask_price10到ask_price1，从高到低），CTP只提供5档
+    static const char* const kAskPriceNames[] = {"ask_price1", "ask_price2", "ask_price3", "ask_price4", "ask_price5",
+                                                 "ask_price6", "ask_price7", "ask_price8", "ask_price9", "ask_price10"};
+    static const char* const kAskVolumeNames[] = {"ask_volume1", "ask_volume2", "ask_volume3", "ask_volume4", "ask_volume5",
+                                                  "ask_volume6", "ask_volume7", "ask_volume8", "ask_volume9", "ask_volume10"};
+    static const char* const kBidPriceNames[] = {"bid_price1", "bid_price2", "bid_price3", "bid_price4", "bid_price5",
+                                                 "bid_price6", "bid_price7", "bid_price8", "bid_price9", "bid_price10"};
+    static const char* const kBidVolumeNames[] = {"bid_volume1", "bid_volume2", "bid_volume3", "bid_volume4", "bid_volume5",
+                                                  "bid_volume6", "bid_volume7", "bid_volume8", "bid_volume9", "bid_volume10"};
+
+    for (int level = 9; level >= 0; --level) {
+        bool present = level < kQuoteDepthLevels && quote.has(kQuoteAskPrice1 << level);
+        add_price(inst_data, kAskPriceNames[level], present, present ? quote.ask_price[level] : 0.0, allocator);
+        if (present) {
+            inst_data.AddMember(rapidjson::StringRef(kAskVolumeNames[level]), quote.ask_volume[level], allocator);
+        } else {
+            inst_data.AddMember(rapidjson::StringRef(kAskVolumeNames[level]), rapidjson::Value().SetNull(), allocator);
+        }
+    }
+
+    // 4. 买价和买量（bid_price1到bid_price10）
+    for (int level = 0; level < 10; ++level) {
+        bool present = level < kQuoteDepthLevels && quote.has(kQuoteBidPrice1 << level);
+        add_price(inst_data, kBidPriceNames[level], present, present ? quote.bid_price[level] : 0.0, allocator);
+        if (present) {
+            inst_data.AddMember(rapidjson::StringRef(kBidVolumeNames[level]), quote.bid_volume[level], allocator);
+        } else {
+            inst_data.AddMember(rapidjson::StringRef(kBidVolumeNames[level]), rapidjson::Value().SetNull(), allocator);
+        }
+    }
+
+    // 5. 其他字段
+    add_price(inst_data, "last_price", quote.has(kQuoteLastPrice), quote.last_price, allocator);
+    add_price(inst_data, "highest", quote.has(kQuoteHighest), quote.highest, allocator);
+    add_price(inst_data, "lowest", quote.has(kQuoteLowest), quote.lowest, allocator);
+    add_price(inst_data, "open", quote.has(kQuoteOpen), quote.open, allocator);
+
+    if (quote.has(kQuoteClose)) {
+        inst_data.AddMember("close", quote.close, allocator);
+    } else {
+        inst_data.AddMember("close", rapidjson::Value("-", allocator), allocator);
+    }
+
+    inst_data.AddMember("average", rapidjson::Value().SetNull(), allocator);
+
+    inst_data.AddMember("volume", quote.volume, allocator);
+    inst_data.AddMember("amount", quote.amount, allocator);
+    inst_data.AddMember("open_interest", quote.open_interest, allocator);
+
+    if (quote.has(kQuoteSettlement)) {
+        inst_data.AddMember("settlement", quote.settlement, allocator);
+    } else {
+        inst_data.AddMember("settlement", rapidjson::Value("-", allocator), allocator);
+    }
+
+    add_price(inst_data, "upper_limit", quote.has(kQuoteUpperLimit), quote.upper_limit, allocator);
+    add_price(inst_data, "lower_limit", quote.has(kQuoteLowerLimit), quote.lower_limit, allocator);
+
+    inst_data.AddMember("pre_open_interest", quote.pre_open_interest, allocator);
+
+    add_price(inst_data, "pre_settlement", quote.has(kQuotePreSettlement), quote.pre_settlement, allocator);
+    add_price(inst_data, "pre_close", quote.has(kQuotePreClose), quote.pre_close, allocator);
+
+    return inst_data;
+}
+
+std::string QuoteCodec::encode(const NormalizedQuote& quote)
+{
+    std::string out;
+    out.reserve(128);
+
+    out.push_back(static_cast<char>(kBinaryVersion));
+    put_varint(out, quote.present_mask);
+    put_varint(out, zigzag(quote.timestamp_ms));
+
+    // 价格以昨结算为基准的定点差值编码
+    int64_t base = 0;
+    if (quote.has(kQuotePreSettlement)) {
+        base = to_fixed(quote.pre_settlement);
+        put_varint(out, zigzag(base));
+    }
+
+    for (int i = 0; i < kQuoteDepthLevels; ++i) {
+        if (quote.has(kQuoteAskPrice1 << i)) {
+            put_varint(out, zigzag(to_fixed(quote.ask_price[i]) - base));
+        }
+    }
+    for (int i = 0; i < kQuoteDepthLevels; ++i) {
+        if (quote.has(kQuoteBidPrice1 << i)) {
+            put_varint(out, zigzag(to_fixed(quote.bid_price[i]) - base));
+        }
+    }
+    for (const auto& field : kScalarPriceFields) {
+        if (quote.has(field.bit)) {
+            put_varint(out, zigzag(to_fixed(quote.*(field.member)) - base));
+        }
+    }
+
+    for (int i = 0; i < kQuoteDepthLevels; ++i) {
+        if (quote.has(kQuoteAskPrice1 << i)) {
+            put_varint(out, zigzag(quote.ask_volume[i]));
+        }
+    }
+    for (int i = 0; i < kQuoteDepthLevels; ++i) {
+        if (quote.has(kQuoteBidPrice1 << i)) {
+            put_varint(out, zigzag(quote.bid_volume[i]));
+        }
+    }
+
+    put_varint(out, zigzag(quote.volume));
+    put_varint(out, zigzag(quote.open_interest));
+    put_varint(out, zigzag(quote.pre_open_interest));
+
+    char amount_bytes[sizeof(double)];
+    memcpy(amount_bytes, &quote.amount, sizeof(double));
+    out.append(amount_bytes, sizeof(double));
+
+    return out;
+}
+
+bool QuoteCodec::decode(const char* data, size_t len, NormalizedQuote& quote)
+{
+    memset(&quote, 0, sizeof(quote));
+
+    const char* cursor = data;
+    const char* end = data + len;
+    if (len == 0 || static_cast<uint8_t>(*cursor++) != kBinaryVersion) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    if (!get_varint(cursor, end, value)) return false;
+    quote.present_mask = static_cast<uint32_t>(value);
+
+    if (!get_varint(cursor, end, value)) return false;
+    quote.timestamp_ms = unzigzag(value);
+
+    int64_t base = 0;
+    if (quote.has(kQuotePreSettlement)) {
+        if (!get_varint(cursor, end, value)) return false;
+        base = unzigzag(value);
+        quote.pre_settlement = base / 100.0;
+    }
+
+    for (int i = 0; i < kQuoteDepthLevels; ++i) {
+        if (quote.has(kQuoteAskPrice1 << i)) {
+            if (!get_varint(cursor, end, value)) return false;
+            quote.ask_price[i] = (unzigzag(value) + base) / 100.0;
+        }
+    }
+    for (int i = 0; i < kQuoteDepthLevels; ++i) {
+        if (quote.has(kQuoteBidPrice1 << i)) {
+            if (!get_varint(cursor, end, value)) return false;
+            quote.bid_price[i] = (unzigzag(value) + base) / 100.0;
+        }
+    }
+    for (const auto& field : kScalarPriceFields) {
+        if (quote.has(field.bit)) {
+            if (!get_varint(cursor, end, value)) return false;
+            quote.*(field.member) = (unzigzag(value) + base) / 100.0;
+        }
+    }
+
+    for (int i = 0; i < kQuoteDepthLevels; ++i) {
+        if (quote.has(kQuoteAskPrice1 << i)) {
+            if (!get_varint(cursor, end, value)) return false;
+            quote.ask_volume[i] = static_cast<int32_t>(unzigzag(value));
+        }
+    }
+    for (int i = 0; i < kQuoteDepthLevels; ++i) {
+        if (quote.has(kQuoteBidPrice1 << i)) {
+            if (!get_varint(cursor, end, value)) return false;
+            quote.bid_volume[i] = static_cast<int32_t>(unzigzag(value));
+        }
+    }
+
+    if (!get_varint(cursor, end, value)) return false;
+    quote.volume = unzigzag(value);
+    if (!get_varint(cursor, end, value)) return false;
+    quote.open_interest = unzigzag(value);
+    if (!get_varint(cursor, end, value)) return false;
+    quote.pre_open_interest = unzigzag(value);
+
+    if (end - cursor < static_cast<ptrdiff_t>(sizeof(double))) {
+        return false;
+    }
+    memcpy(&quote.amount, cursor, sizeof(double));
+
+    // 由时间戳还原交易日和更新时间
+    std::time_t seconds = static_cast<std::time_t>(quote.timestamp_ms / 1000);
+    struct tm result_tm;
+    if (localtime_r(&seconds, &result_tm) != nullptr) {
+        strftime(quote.trading_day, sizeof(quote.trading_day), "%Y%m%d", &result_tm);
+        strftime(quote.update_time, sizeof(quote.update_time), "%H:%M:%S", &result_tm);
+    }
+    quote.update_millisec = static_cast<int32_t>(quote.timestamp_ms % 1000);
+
+    return true;
+}
@@ -0,0 +1,49 @@
+/////////////////////////////////////////////////////////////////////////
+///@file quote_codec.h
+///@brief	行情标准化与紧凑二进制编解码
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../libs/ThostFtdcUserApiStruct.h"
+#include "../include/open-trade-common/types.h"
+#include "normalized_quote.h"
+#include <string>
+#include <cstdint>
+
+// 行情编解码器
+//
+// 二进制格式（版本1）:
+//   [u8 版本号=1]
+//   [varint 字段存在位 present_mask]
+//   [zigzag varint timestamp_ms]
+//   [zigzag varint 昨结算定点价]            仅当存在 kQuotePreSettlement
+//   [zigzag varint 价格 - 昨结算]           按 ask1..5, bid1..5, last, highest, lowest,
+//                                           open, close, settlement, upper, lower, pre_close 顺序，仅存在的字段
+//   [zigzag varint 挂单量]                  ask1..5, bid1..5 中价格存在的档位
+//   [zigzag varint volume, open_interest, pre_open_interest]
+//   [f64 amount]
+// 价格为0.01定点（与JSON输出的取整精度一致），trading_day/update_time由timestamp_ms还原。
+class QuoteCodec
+{
+public:
+    static const uint8_t kBinaryVersion = 1;
+
+    // CTP深度行情 -> 标准化行情
+    static void normalize(const CThostFtdcDepthMarketDataField& md, NormalizedQuote& quote);
+
+    // 标准化行情 -> 标准JSON（字段顺序与推送格式一致）
+    static rapidjson::Value to_json(const NormalizedQuote& quote,
+                                    const std::string& display_instrument,
+                                    rapidjson::Document::AllocatorType& allocator);
+
+    // 二进制编解码，decode不还原instrument_id（由历史key提供）
+    static std::string encode(const NormalizedQuote& quote);
+    static bool decode(const char* data, size_t len, NormalizedQuote& quote);
+
+    // 判断历史成员是否为二进制格式（JSON成员以'{'开头）
+    static bool is_binary(const std::string& member) {
+        return !member.empty() && static_cast<uint8_t>(member[0]) == kBinaryVersion;
+    }
+};
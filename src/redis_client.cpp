@@ -9,9 +9,10 @@
 #include <cstring>
 #include <iostream>
 #include <map>
+#include <algorithm>
 
 RedisClient::RedisClient(const std::string& host, int port)
-    : host_(host), port_(port), context_(nullptr)
+    : host_(host), port_(port), context_(nullptr), connected_(false)
 {
 }
 
@@ -26,7 +27,9 @@ bool RedisClient::connect()
     
     if (context_) {
         redisFree(context_);
+        context_ = nullptr;
     }
+    connected_ = false;
     
     // 设置连接超时
     struct timeval timeout = { 3, 0 }; // 3秒超时
@@ -43,6 +46,10 @@ bool RedisClient::connect()
         return false;
     }
     
+    // 命令超时，避免Redis卡死时阻塞行情线程
+    redisSetTimeout(context_, timeout);
+    
+    connected_ = true;
     std::cout << "Connected to Redis server " << host_ << ":" << port_ << std::endl;
     return true;
 }
@@ -51,6 +58,7 @@ void RedisClient::disconnect()
 {
     std::lock_guard<std::mutex> lock(mutex_);
     
+    connected_ = false;
     if (context_) {
         redisFree(context_);
         context_ = nullptr;
@@ -58,6 +66,15 @@ void RedisClient::disconnect()
     }
 }
 
+void RedisClient::mark_broken()
+{
+    // 调用方已持有mutex_；hiredis上下文出错后不可复用，等待重连
+    if (connected_) {
+        std::cerr << "Redis connection lost: " << (context_ && context_->err ? context_->errstr : "unknown error") << std::endl;
+    }
+    connected_ = false;
+}
+
 std::string RedisClient::get_error() const
 {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -81,6 +98,7 @@ redisReply* RedisClient::execute_command(const char* format, ...)
     
     if (reply == nullptr) {
         std::cerr << "Redis command failed: " << (context_->err ? context_->errstr : "unknown error") << std::endl;
+        mark_broken();
     }
     
     return reply;
@@ -231,7 +249,8 @@ bool RedisClient::zadd(const std::string& key, long long score, const std::strin
 {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    redisReply* reply = execute_command("ZADD %s %lld %s", key.c_str(), score, member.c_str());
+    // member可能为二进制编码，使用%b保证二进制安全
+    redisReply* reply = execute_command("ZADD %s %lld %b", key.c_str(), score, member.data(), member.size());
     if (reply == nullptr) {
         return false;
     }
@@ -271,4 +290,99 @@ long long RedisClient::zcard(const std::string& key)
     
     free_reply(reply);
     return count;
-}
\ No newline at end of file
+}
+
+int RedisClient::pipeline(const std::vector<std::vector<std::string>>& commands)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (!is_connected()) {
+        return -1;
+    }
+    
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+    for (const auto& command : commands) {
+        argv.clear();
+        argvlen.clear();
+        for (const auto& arg : command) {
+            argv.push_back(arg.data());
+            argvlen.push_back(arg.size());
+        }
+        if (redisAppendCommandArgv(context_, static_cast<int>(argv.size()), argv.data(), argvlen.data()) != REDIS_OK) {
+            mark_broken();
+            return -1;
+        }
+    }
+    
+    int succeeded = 0;
+    for (size_t i = 0; i < commands.size(); ++i) {
+        void* raw_reply = nullptr;
+        if (redisGetReply(context_, &raw_reply) != REDIS_OK) {
+            mark_broken();
+            return -1;
+        }
+        redisReply* reply = static_cast<redisReply*>(raw_reply);
+        if (reply && reply->type != REDIS_REPLY_ERROR) {
+            succeeded++;
+        }
+        free_reply(reply);
+    }
+    
+    return succeeded;
+}
+
+bool RedisClient::mget(const std::vector<std::string>& keys, std::map<std::string, std::string>& values,
+                       size_t chunk_size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (!is_connected()) {
+        return false;
+    }
+    if (keys.empty()) {
+        return true;
+    }
+    if (chunk_size == 0) {
+        chunk_size = keys.size();
+    }
+    
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+    size_t chunk_count = 0;
+    for (size_t begin = 0; begin < keys.size(); begin += chunk_size) {
+        size_t end = std::min(keys.size(), begin + chunk_size);
+        argv.assign(1, "MGET");
+        argvlen.assign(1, 4);
+        for (size_t i = begin; i < end; ++i) {
+            argv.push_back(keys[i].data());
+            argvlen.push_back(keys[i].size());
+        }
+        if (redisAppendCommandArgv(context_, static_cast<int>(argv.size()), argv.data(), argvlen.data()) != REDIS_OK) {
+            mark_broken();
+            return false;
+        }
+        chunk_count++;
+    }
+    
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+        void* raw_reply = nullptr;
+        if (redisGetReply(context_, &raw_reply) != REDIS_OK) {
+            mark_broken();
+            return false;
+        }
+        redisReply* reply = static_cast<redisReply*>(raw_reply);
+        if (reply && reply->type == REDIS_REPLY_ARRAY) {
+            size_t begin = chunk * chunk_size;
+            for (size_t i = 0; i < reply->elements && begin + i < keys.size(); ++i) {
+                redisReply* element = reply->element[i];
+                if (element && element->type == REDIS_REPLY_STRING) {
+                    values[keys[begin + i]] = std::string(element->str, element->len);
+                }
+            }
+        }
+        free_reply(reply);
+    }
+    
+    return true;
+}
@@ -11,6 +11,8 @@
 #include <memory>
 #include <mutex>
 #include <map>
+#include <vector>
+#include <atomic>
 
 class RedisClient {
 public:
@@ -19,7 +21,8 @@ public:
     
     bool connect();
     void disconnect();
-    bool is_connected() const { return context_ != nullptr && !context_->err; }
+    // 连接状态在连接/命令失败时更新，可被行情线程无锁读取
+    bool is_connected() const { return connected_.load(std::memory_order_acquire); }
     
     // 设置键值对
     bool set(const std::string& key, const std::string& value);
@@ -55,6 +58,15 @@ public:
     // 获取有序集合成员数量
     long long zcard(const std::string& key);
     
+    // 管道批量执行命令（每条命令为参数数组，二进制安全）
+    // 返回成功的命令数量，连接失败时返回-1
+    int pipeline(const std::vector<std::vector<std::string>>& commands);
+    
+    // 批量读取：按chunk_size拆分为多条MGET并以管道方式发送
+    // values中只包含存在的key，连接失败时返回false
+    bool mget(const std::vector<std::string>& keys, std::map<std::string, std::string>& values,
+              size_t chunk_size = 500);
+    
     // 获取连接错误信息
     std::string get_error() const;
 
@@ -62,9 +74,11 @@ private:
     std::string host_;
     int port_;
     redisContext* context_;
+    std::atomic<bool> connected_;
     mutable std::mutex mutex_;
     
     // 执行Redis命令的通用方法
     redisReply* execute_command(const char* format, ...);
     void free_reply(redisReply* reply);
+    void mark_broken();
 };
\ No newline at end of file
@@ -0,0 +1,115 @@
+/////////////////////////////////////////////////////////////////////////
+///@file redis_shard_router.cpp
+///@brief	多节点Redis分片路由实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "redis_shard_router.h"
+#include "market_data_server.h"
+
+RedisShardRouter::RedisShardRouter(MarketDataServer* server, const MultiCTPConfig& config)
+    : server_(server)
+{
+    std::vector<RedisEndpointConfig> endpoints = config.redis_endpoints;
+    if (endpoints.empty()) {
+        RedisEndpointConfig endpoint;
+        endpoint.host = config.redis_host;
+        endpoint.port = config.redis_port;
+        endpoints.push_back(endpoint);
+    }
+
+    for (const auto& endpoint : endpoints) {
+        std::string name = endpoint.host + ":" + std::to_string(endpoint.port);
+        // 单节点沿用原溢出目录，多节点时每个节点独立子目录，避免回放到错误的节点
+        std::string spill_dir = config.redis_spill_dir;
+        if (endpoints.size() > 1) {
+            spill_dir += "/" + endpoint.host + "_" + std::to_string(endpoint.port);
+        }
+
+        writers_.push_back(std::make_unique<RedisWriter>(server, endpoint.host, endpoint.port, spill_dir, config));
+        ring_.add_node(name, writers_.back().get(), endpoint.weight);
+    }
+}
+
+RedisShardRouter::~RedisShardRouter()
+{
+    stop();
+}
+
+void RedisShardRouter::start()
+{
+    for (auto& writer : writers_) {
+        writer->start();
+    }
+
+    if (writers_.size() > 1) {
+        server_->log_info("Redis output sharded across " + std::to_string(writers_.size()) + " nodes");
+    }
+}
+
+void RedisShardRouter::stop()
+{
+    for (auto& writer : writers_) {
+        writer->stop();
+    }
+}
+
+void RedisShardRouter::write_tick(const std::string& instrument_id, const std::string& json_data,
+                                  long long timestamp_ms, const std::string& history_member,
+                                  const std::string& publish_channel)
+{
+    RedisWriter* writer = get_writer(instrument_id);
+    if (!writer) {
+        return;
+    }
+
+    RedisWriter* publisher = publish_channel.empty() ? writer : get_publish_writer(publish_channel);
+    if (publisher == writer) {
+        writer->write_tick(instrument_id, json_data, timestamp_ms, history_member, publish_channel);
+        return;
+    }
+
+    writer->write_tick(instrument_id, json_data, timestamp_ms, history_member);
+    if (publisher) {
+        publisher->publish(instrument_id, json_data, publish_channel);
+    }
+}
+
+RedisWriter* RedisShardRouter::get_publish_writer(const std::string& publish_channel)
+{
+    // 频道与合约用同一个哈希环，节点数为1时两者相同
+    return get_writer(publish_channel);
+}
+
+RedisWriter* RedisShardRouter::get_writer(const std::string& instrument_id)
+{
+    if (writers_.size() == 1) {
+        return writers_.front().get();
+    }
+
+    RedisWriter* const* writer = ring_.get(instrument_id);
+    return writer ? *writer : nullptr;
+}
+
+std::map<RedisWriter*, std::vector<std::string>> RedisShardRouter::group_by_shard(const std::vector<std::string>& instruments)
+{
+    std::map<RedisWriter*, std::vector<std::string>> groups;
+    for (const auto& instrument_id : instruments) {
+        RedisWriter* writer = get_writer(instrument_id);
+        if (writer) {
+            groups[writer].push_back(instrument_id);
+        }
+    }
+    return groups;
+}
+
+size_t RedisShardRouter::get_healthy_shard_count() const
+{
+    size_t count = 0;
+    for (const auto& writer : writers_) {
+        if (writer->is_healthy()) {
+            count++;
+        }
+    }
+    return count;
+}
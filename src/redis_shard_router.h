@@ -0,0 +1,54 @@
+/////////////////////////////////////////////////////////////////////////
+///@file redis_shard_router.h
+///@brief	多节点Redis分片路由
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "redis_writer.h"
+#include "consistent_hash_ring.h"
+#include "multi_ctp_config.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <map>
+
+class MarketDataServer;
+
+// Redis分片路由
+// 按合约ID一致性哈希把行情分配到多个Redis节点，每个节点独立的连接、写队列、
+// 管道写线程和溢出文件，写入吞吐随节点数水平扩展。
+// 未配置redis_endpoints时退化为redis_host/redis_port单节点。
+// PUBLISH按频道名在同一哈希环上选节点：同一频道（如按交易所发布的md:SHFE）的消息总在同一节点，
+// 订阅者连接ring中该频道所在的节点即可收到全部消息；频道与合约落在同一节点时随行情批次一起发出。
+class RedisShardRouter
+{
+public:
+    RedisShardRouter(MarketDataServer* server, const MultiCTPConfig& config);
+    ~RedisShardRouter();
+
+    void start();
+    void stop();
+
+    void write_tick(const std::string& instrument_id, const std::string& json_data,
+                    long long timestamp_ms, const std::string& history_member,
+                    const std::string& publish_channel = "");
+
+    // 合约所在分片
+    RedisWriter* get_writer(const std::string& instrument_id);
+    // 发布频道所在分片
+    RedisWriter* get_publish_writer(const std::string& publish_channel);
+
+    // 按分片归组合约（用于批量读取）
+    std::map<RedisWriter*, std::vector<std::string>> group_by_shard(const std::vector<std::string>& instruments);
+
+    const std::vector<std::unique_ptr<RedisWriter>>& get_writers() const { return writers_; }
+    size_t get_shard_count() const { return writers_.size(); }
+    size_t get_healthy_shard_count() const;
+
+private:
+    MarketDataServer* server_;
+    std::vector<std::unique_ptr<RedisWriter>> writers_;
+    ConsistentHashRing<RedisWriter*> ring_;
+};
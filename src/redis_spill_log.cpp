@@ -0,0 +1,214 @@
+/////////////////////////////////////////////////////////////////////////
+///@file redis_spill_log.cpp
+///@brief	Redis不可用时的本地追加写溢出文件实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "redis_spill_log.h"
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+RedisSpillLog::RedisSpillLog()
+    : fd_(-1)
+    , base_(nullptr)
+    , capacity_(0)
+    , header_(nullptr)
+{
+}
+
+RedisSpillLog::~RedisSpillLog()
+{
+    close();
+}
+
+bool RedisSpillLog::open(const std::string& path, size_t capacity_bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (base_) {
+        return true;
+    }
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open Redis spill file: " << path << ", " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    // 已存在的文件沿用原大小，保证偏移有效
+    bool existing = st.st_size >= static_cast<off_t>(sizeof(Header));
+    size_t file_size = existing ? static_cast<size_t>(st.st_size) : capacity_bytes;
+
+    if (!existing && ftruncate(fd_, static_cast<off_t>(file_size)) != 0) {
+        std::cerr << "Failed to size Redis spill file: " << path << ", " << strerror(errno) << std::endl;
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to mmap Redis spill file: " << path << ", " << strerror(errno) << std::endl;
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    base_ = static_cast<char*>(mapped);
+    capacity_ = file_size;
+    header_ = reinterpret_cast<Header*>(base_);
+    path_ = path;
+
+    if (!existing || header_->magic != kMagic || header_->version != kVersion ||
+        header_->capacity != capacity_ || header_->write_offset > capacity_ ||
+        header_->replay_offset > header_->write_offset) {
+        header_->magic = kMagic;
+        header_->version = kVersion;
+        header_->capacity = capacity_;
+        header_->write_offset = sizeof(Header);
+        header_->replay_offset = sizeof(Header);
+        header_->dropped_records = 0;
+    }
+
+    return true;
+}
+
+void RedisSpillLog::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (base_) {
+        msync(base_, capacity_, MS_ASYNC);
+        munmap(base_, capacity_);
+        base_ = nullptr;
+        header_ = nullptr;
+    }
+
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool RedisSpillLog::append(const std::string& key, long long score, const std::string& member)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!base_) {
+        return false;
+    }
+
+    const uint32_t key_len = static_cast<uint32_t>(key.size());
+    const uint32_t member_len = static_cast<uint32_t>(member.size());
+    const int64_t record_score = score;
+    const size_t record_size = sizeof(key_len) + sizeof(member_len) + sizeof(record_score) + key_len + member_len;
+
+    if (header_->write_offset + record_size > capacity_) {
+        header_->dropped_records++;
+        return false;
+    }
+
+    char* dst = base_ + header_->write_offset;
+    memcpy(dst, &key_len, sizeof(key_len));
+    dst += sizeof(key_len);
+    memcpy(dst, &member_len, sizeof(member_len));
+    dst += sizeof(member_len);
+    memcpy(dst, &record_score, sizeof(record_score));
+    dst += sizeof(record_score);
+    memcpy(dst, key.data(), key_len);
+    dst += key_len;
+    memcpy(dst, member.data(), member_len);
+
+    // 记录体写完后再推进偏移，崩溃时最多丢失最后一条
+    header_->write_offset += record_size;
+    return true;
+}
+
+uint64_t RedisSpillLog::read_pending(size_t max_records, std::vector<RedisSpillRecord>& records)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!base_) {
+        return 0;
+    }
+
+    uint64_t offset = header_->replay_offset;
+    const uint64_t end = header_->write_offset;
+    const size_t fixed_size = sizeof(uint32_t) * 2 + sizeof(int64_t);
+
+    while (records.size() < max_records && offset + fixed_size <= end) {
+        const char* src = base_ + offset;
+        uint32_t key_len;
+        uint32_t member_len;
+        int64_t score;
+        memcpy(&key_len, src, sizeof(key_len));
+        memcpy(&member_len, src + sizeof(key_len), sizeof(member_len));
+        memcpy(&score, src + sizeof(key_len) + sizeof(member_len), sizeof(score));
+
+        if (offset + fixed_size + key_len + member_len > end) {
+            break;
+        }
+
+        src += fixed_size;
+        RedisSpillRecord record;
+        record.key.assign(src, key_len);
+        record.member.assign(src + key_len, member_len);
+        record.score = score;
+        records.push_back(std::move(record));
+
+        offset += fixed_size + key_len + member_len;
+    }
+
+    return offset;
+}
+
+void RedisSpillLog::commit_replay(uint64_t offset)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!base_ || offset < header_->replay_offset || offset > header_->write_offset) {
+        return;
+    }
+
+    header_->replay_offset = offset;
+
+    // 全部回放完毕，回收文件空间
+    if (header_->replay_offset == header_->write_offset) {
+        header_->write_offset = sizeof(Header);
+        header_->replay_offset = sizeof(Header);
+    }
+}
+
+bool RedisSpillLog::has_pending() const
+{
+    return pending_bytes() > 0;
+}
+
+uint64_t RedisSpillLog::pending_bytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!base_) {
+        return 0;
+    }
+    return header_->write_offset - header_->replay_offset;
+}
+
+uint64_t RedisSpillLog::get_dropped_records() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return base_ ? header_->dropped_records : 0;
+}
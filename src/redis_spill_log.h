@@ -0,0 +1,68 @@
+/////////////////////////////////////////////////////////////////////////
+///@file redis_spill_log.h
+///@brief	Redis不可用时的本地追加写溢出文件
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// 溢出记录：一条历史tick（ZADD key score member）
+struct RedisSpillRecord {
+    std::string key;
+    long long score;
+    std::string member;
+};
+
+// 单个交易日的内存映射溢出文件
+// 文件布局: [Header][Record...]，Record = [u32 key_len][u32 member_len][i64 score][key][member]
+// Header中记录写入偏移和回放偏移，进程重启后可继续回放
+class RedisSpillLog {
+public:
+    RedisSpillLog();
+    ~RedisSpillLog();
+
+    // 打开（或创建）指定路径的溢出文件，capacity_bytes为文件大小上限
+    bool open(const std::string& path, size_t capacity_bytes);
+    void close();
+    bool is_open() const { return base_ != nullptr; }
+
+    const std::string& get_path() const { return path_; }
+
+    // 追加一条记录，文件已满时返回false
+    bool append(const std::string& key, long long score, const std::string& member);
+
+    // 从回放偏移处读取最多max_records条记录，返回读取后的新偏移
+    // 调用方回放成功后再调用commit_replay提交偏移
+    uint64_t read_pending(size_t max_records, std::vector<RedisSpillRecord>& records);
+    void commit_replay(uint64_t offset);
+
+    bool has_pending() const;
+    uint64_t pending_bytes() const;
+    uint64_t get_dropped_records() const;
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t capacity;
+        uint64_t write_offset;
+        uint64_t replay_offset;
+        uint64_t dropped_records;
+    };
+
+    static const uint32_t kMagic = 0x51415350; // "QASP"
+    static const uint32_t kVersion = 1;
+
+    std::string path_;
+    int fd_;
+    char* base_;
+    size_t capacity_;
+    Header* header_;
+    mutable std::mutex mutex_;
+};
@@ -0,0 +1,567 @@
+/////////////////////////////////////////////////////////////////////////
+///@file redis_writer.cpp
+///@brief	行情Redis写入器实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "redis_writer.h"
+#include "market_data_server.h"
+#include <chrono>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+RedisWriter::RedisWriter(MarketDataServer* server, const std::string& host, int port,
+                         const std::string& spill_dir, const MultiCTPConfig& config)
+    : server_(server)
+    , client_(std::make_unique<RedisClient>(host, port))
+    , endpoint_(host + ":" + std::to_string(port))
+    , spill_dir_(spill_dir)
+    , spill_capacity_(static_cast<size_t>(std::max(1, config.redis_spill_size_mb)) * 1024 * 1024)
+    , replay_rate_(std::max(1, config.redis_replay_rate))
+    , max_backoff_seconds_(std::max(1, config.redis_reconnect_max_backoff))
+    , queue_limit_(static_cast<size_t>(std::max(1, config.redis_queue_limit)))
+    , pipeline_batch_(static_cast<size_t>(std::max(1, config.redis_pipeline_batch)))
+    , publish_conflation_ms_(std::max(0, config.redis_publish_conflation_ms))
+    , next_sequence_(0)
+    , running_(false)
+    , spilled_records_(0)
+    , replayed_records_(0)
+    , written_records_(0)
+    , published_records_(0)
+    , overflow_records_(0)
+{
+}
+
+RedisWriter::~RedisWriter()
+{
+    stop();
+}
+
+bool RedisWriter::start()
+{
+    if (running_) {
+        return true;
+    }
+
+    load_existing_spill_logs();
+
+    if (client_->connect()) {
+        server_->log_info("Connected to Redis server at " + endpoint_);
+    } else {
+        server_->log_error("Failed to connect to Redis server at " + endpoint_);
+        server_->log_warning("Market data will be spilled to " + spill_dir_ + " until Redis recovers");
+    }
+
+    running_ = true;
+    writer_thread_ = std::make_unique<std::thread>(&RedisWriter::writer_loop, this);
+    recovery_thread_ = std::make_unique<std::thread>(&RedisWriter::recovery_loop, this);
+    return true;
+}
+
+void RedisWriter::stop()
+{
+    running_ = false;
+    queue_cv_.notify_all();
+
+    // 写线程退出前会清空队列
+    if (writer_thread_ && writer_thread_->joinable()) {
+        writer_thread_->join();
+    }
+    writer_thread_.reset();
+
+    if (recovery_thread_ && recovery_thread_->joinable()) {
+        recovery_thread_->join();
+    }
+    recovery_thread_.reset();
+
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    for (auto& pair : spill_logs_) {
+        pair.second->close();
+    }
+}
+
+void RedisWriter::write_tick(const std::string& instrument_id, const std::string& json_data,
+                             long long timestamp_ms, const std::string& history_member,
+                             const std::string& publish_channel)
+{
+    const uint64_t sequence = next_sequence_.fetch_add(1, std::memory_order_relaxed);
+    if (!running_ || !client_->is_connected()) {
+        spill_tick(instrument_id, json_data, timestamp_ms, history_member, sequence);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (queue_.size() < queue_limit_) {
+            queue_.push_back(RedisPendingTick{instrument_id, json_data, timestamp_ms, history_member, publish_channel,
+                                              sequence, false});
+            if (queue_.size() >= pipeline_batch_) {
+                queue_cv_.notify_one();
+            }
+            return;
+        }
+    }
+
+    // 队列积压（Redis写入跟不上），直接转入溢出文件，由恢复线程限速回放
+    if (overflow_records_++ % 10000 == 0) {
+        server_->log_warning("Redis " + endpoint_ + " write queue full, spilling market data");
+    }
+    spill_tick(instrument_id, json_data, timestamp_ms, history_member, sequence);
+}
+
+void RedisWriter::publish(const std::string& instrument_id, const std::string& json_data,
+                          const std::string& publish_channel)
+{
+    // 发布只面向实时订阅者：不可用或积压时直接丢弃，不溢出
+    if (!running_ || !client_->is_connected()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (queue_.size() < queue_limit_) {
+        queue_.push_back(RedisPendingTick{instrument_id, json_data, 0, std::string(), publish_channel, 0, true});
+        if (queue_.size() >= pipeline_batch_) {
+            queue_cv_.notify_one();
+        }
+    }
+}
+
+size_t RedisWriter::get_queue_size() const
+{
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    return queue_.size();
+}
+
+void RedisWriter::writer_loop()
+{
+    std::vector<RedisPendingTick> batch;
+    batch.reserve(pipeline_batch_);
+
+    while (true) {
+        // 恢复后补写故障期间的最新行情：与实时SET由同一线程按序发出，补写值不会覆盖更新的实时值
+        if (client_->is_connected()) {
+            replay_pending_latest();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            // 攒满一批或最多等待10ms，兼顾吞吐和延迟
+            queue_cv_.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+                return !running_ || queue_.size() >= pipeline_batch_;
+            });
+
+            if (queue_.empty()) {
+                if (!running_) {
+                    break;
+                }
+                // 合并窗口内还有待发布的行情时继续处理
+                if (pending_publish_.empty()) {
+                    continue;
+                }
+            }
+
+            const size_t count = std::min(queue_.size(), pipeline_batch_);
+            for (size_t i = 0; i < count; ++i) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+
+        flush_batch(batch);
+        batch.clear();
+    }
+}
+
+void RedisWriter::flush_batch(std::vector<RedisPendingTick>& batch)
+{
+    if (!client_->is_connected()) {
+        for (const auto& tick : batch) {
+            if (tick.publish_only) {
+                continue;
+            }
+            spill_tick(tick.instrument_id, tick.json_data, tick.timestamp_ms, tick.history_member, tick.sequence);
+        }
+        // 发布只面向实时订阅者，不可用期间的行情不补发
+        pending_publish_.clear();
+        return;
+    }
+
+    // 最新 + 历史 + 发布 合并为一次管道往返
+    std::vector<std::vector<std::string>> commands;
+    commands.reserve(batch.size() * 3);
+    size_t data_ticks = 0;
+    for (const auto& tick : batch) {
+        if (tick.publish_only) {
+            continue;
+        }
+        data_ticks++;
+        commands.push_back({"SET", tick.instrument_id, tick.json_data});
+        if (tick.timestamp_ms > 0) {
+            commands.push_back({"ZADD", "history:" + tick.instrument_id,
+                                std::to_string(tick.timestamp_ms), tick.history_member});
+        }
+    }
+
+    const size_t data_commands = commands.size();
+    const long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    collect_publish(batch, now_ms, commands);
+    if (commands.empty()) {
+        return;
+    }
+
+    int succeeded = client_->pipeline(commands);
+    if (succeeded < 0) {
+        // 写入过程中连接断开，整批转入溢出（ZADD幂等，重复回放无副作用）
+        for (const auto& tick : batch) {
+            if (tick.publish_only) {
+                continue;
+            }
+            spill_tick(tick.instrument_id, tick.json_data, tick.timestamp_ms, tick.history_member, tick.sequence);
+        }
+        pending_publish_.clear();
+        return;
+    }
+    published_records_ += commands.size() - data_commands;
+
+    if (static_cast<size_t>(succeeded) < commands.size()) {
+        server_->log_warning("Failed to store " + std::to_string(commands.size() - succeeded) +
+                             " market data commands to Redis " + endpoint_);
+    }
+    written_records_ += data_ticks;
+
+    {
+        // 只清除不比本批更新的待补写值；批次在途期间溢出进来的更新值保留，由补写写入
+        std::lock_guard<std::mutex> lock(pending_latest_mutex_);
+        for (const auto& tick : batch) {
+            if (tick.publish_only) {
+                continue;
+            }
+            uint64_t& live_sequence = live_latest_sequence_[tick.instrument_id];
+            live_sequence = std::max(live_sequence, tick.sequence);
+            if (!pending_latest_.empty()) {
+                auto it = pending_latest_.find(tick.instrument_id);
+                if (it != pending_latest_.end() && it->second.sequence <= tick.sequence) {
+                    pending_latest_.erase(it);
+                }
+            }
+        }
+    }
+
+    // 每个合约每1000条检查一次历史长度
+    for (const auto& tick : batch) {
+        if (tick.timestamp_ms <= 0) {
+            continue;
+        }
+        std::string history_key = "history:" + tick.instrument_id;
+        if (history_write_counts_[history_key]++ % 1000 == 0) {
+            trim_history(history_key);
+        }
+    }
+}
+
+void RedisWriter::collect_publish(const std::vector<RedisPendingTick>& batch, long long now_ms,
+                                  std::vector<std::vector<std::string>>& commands)
+{
+    if (publish_conflation_ms_ <= 0) {
+        // 逐笔发布
+        for (const auto& tick : batch) {
+            if (!tick.publish_channel.empty()) {
+                commands.push_back({"PUBLISH", tick.publish_channel, tick.json_data});
+            }
+        }
+        return;
+    }
+
+    // 合并发布：每个合约在窗口内只发布最新一笔
+    for (const auto& tick : batch) {
+        if (!tick.publish_channel.empty()) {
+            pending_publish_[tick.instrument_id] = RedisPendingPublish{tick.publish_channel, tick.json_data};
+        }
+    }
+
+    for (auto it = pending_publish_.begin(); it != pending_publish_.end();) {
+        long long& last_ms = last_publish_ms_[it->first];
+        if (now_ms - last_ms >= publish_conflation_ms_) {
+            commands.push_back({"PUBLISH", it->second.channel, std::move(it->second.payload)});
+            last_ms = now_ms;
+            it = pending_publish_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RedisWriter::trim_history(const std::string& history_key)
+{
+    const long long history_size = client_->zcard(history_key);
+    if (history_size >= 100000) {
+        const long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        const long long expire_before_ms = now_ms - static_cast<long long>(2) * 24 * 3600 * 1000; // 保留最近2天
+        if (!client_->zremrangebyscore(history_key, 0, expire_before_ms)) {
+            server_->log_warning("Failed to remove historical market data from Redis for key: " + history_key);
+        }
+    }
+}
+
+void RedisWriter::spill_tick(const std::string& instrument_id, const std::string& json_data,
+                             long long timestamp_ms, const std::string& history_member, uint64_t sequence)
+{
+    {
+        // 整批转入溢出时批内可能有比已保存值更旧的tick，不覆盖；已有更新的实时写入时不再补写
+        std::lock_guard<std::mutex> lock(pending_latest_mutex_);
+        auto live = live_latest_sequence_.find(instrument_id);
+        if (live == live_latest_sequence_.end() || live->second < sequence) {
+            auto it = pending_latest_.find(instrument_id);
+            if (it == pending_latest_.end()) {
+                pending_latest_.emplace(instrument_id, RedisPendingLatest{json_data, sequence});
+            } else if (it->second.sequence < sequence) {
+                it->second = RedisPendingLatest{json_data, sequence};
+            }
+        }
+    }
+
+    if (timestamp_ms <= 0) {
+        return;
+    }
+
+    std::shared_ptr<RedisSpillLog> spill_log = get_spill_log(trading_day_of(timestamp_ms));
+    if (spill_log && spill_log->append("history:" + instrument_id, timestamp_ms, history_member)) {
+        spilled_records_++;
+    }
+}
+
+void RedisWriter::recovery_loop()
+{
+    int backoff_seconds = 1;
+    bool outage_reported = false;
+    const auto slice = std::chrono::milliseconds(100);
+    // 每100ms时间片的回放配额
+    const size_t replay_budget = std::max(1, replay_rate_ / 10);
+
+    while (running_) {
+        if (!client_->is_connected()) {
+            if (!outage_reported) {
+                server_->log_warning("Redis " + endpoint_ + " unavailable, spilling market data to " + spill_dir_);
+                outage_reported = true;
+            }
+
+            if (!try_reconnect()) {
+                // 指数退避，可被stop()及时打断
+                for (int i = 0; i < backoff_seconds * 10 && running_; ++i) {
+                    std::this_thread::sleep_for(slice);
+                }
+                backoff_seconds = std::min(backoff_seconds * 2, max_backoff_seconds_);
+                continue;
+            }
+
+            server_->log_info("Redis " + endpoint_ + " recovered, replaying spilled market data");
+            backoff_seconds = 1;
+            outage_reported = false;
+        }
+
+        // 最新行情由写线程补写，这里只限速回放历史
+        if (has_spill_pending()) {
+            replay_spill(replay_budget);
+            if (!has_spill_pending()) {
+                server_->log_info("Redis spill replay completed, total replayed: " +
+                                  std::to_string(replayed_records_.load()));
+            }
+        }
+        // 跨过交易日后，已回放完的往日文件即使本次没有回放也要释放
+        retire_replayed_spill_logs();
+
+        std::this_thread::sleep_for(slice);
+    }
+}
+
+bool RedisWriter::try_reconnect()
+{
+    return client_->connect();
+}
+
+size_t RedisWriter::replay_pending_latest()
+{
+    std::map<std::string, RedisPendingLatest> latest;
+    {
+        std::lock_guard<std::mutex> lock(pending_latest_mutex_);
+        if (pending_latest_.empty()) {
+            return 0;
+        }
+        latest.swap(pending_latest_);
+    }
+
+    std::vector<std::vector<std::string>> commands;
+    commands.reserve(latest.size());
+    for (const auto& pair : latest) {
+        commands.push_back({"SET", pair.first, pair.second.json_data});
+    }
+
+    if (client_->pipeline(commands) < 0) {
+        // 回放失败，放回（不覆盖期间新到的值）
+        std::lock_guard<std::mutex> lock(pending_latest_mutex_);
+        for (auto& pair : latest) {
+            pending_latest_.insert(std::move(pair));
+        }
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(pending_latest_mutex_);
+    for (const auto& pair : latest) {
+        uint64_t& live_sequence = live_latest_sequence_[pair.first];
+        live_sequence = std::max(live_sequence, pair.second.sequence);
+    }
+    return latest.size();
+}
+
+size_t RedisWriter::replay_spill(size_t budget)
+{
+    std::vector<std::shared_ptr<RedisSpillLog>> logs;
+    {
+        std::lock_guard<std::mutex> lock(spill_mutex_);
+        for (auto& pair : spill_logs_) {
+            logs.push_back(pair.second);
+        }
+    }
+
+    const size_t kPipelineBatch = 200;
+    size_t replayed = 0;
+
+    for (const auto& spill_log : logs) {
+        while (replayed < budget && spill_log->has_pending()) {
+            std::vector<RedisSpillRecord> records;
+            uint64_t next_offset = spill_log->read_pending(std::min(kPipelineBatch, budget - replayed), records);
+            if (records.empty()) {
+                break;
+            }
+
+            std::vector<std::vector<std::string>> commands;
+            commands.reserve(records.size());
+            for (const auto& record : records) {
+                commands.push_back({"ZADD", record.key, std::to_string(record.score), record.member});
+            }
+
+            if (client_->pipeline(commands) < 0) {
+                return replayed;
+            }
+
+            spill_log->commit_replay(next_offset);
+            replayed += records.size();
+            replayed_records_ += records.size();
+        }
+    }
+
+    return replayed;
+}
+
+void RedisWriter::retire_replayed_spill_logs()
+{
+    // 交易日早于今天日历日的文件不会再有新的溢出（夜盘行情属于下一交易日），回放完即可删除；
+    // 今天及以后交易日的文件留给仍在进行的溢出继续追加
+    const std::string today = trading_day_of(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    for (auto it = spill_logs_.begin(); it != spill_logs_.end() && it->first < today;) {
+        // 未能打开的文件保留在磁盘上，不删除无法回放的数据
+        if (!it->second->is_open() || it->second->has_pending()) {
+            ++it;
+            continue;
+        }
+        std::string path = it->second->get_path();
+        it->second->close();
+        std::error_code ec;
+        fs::remove(path, ec);
+        server_->log_info("Redis spill file for " + it->first + " fully replayed, removed " + path);
+        it = spill_logs_.erase(it);
+    }
+}
+
+bool RedisWriter::has_spill_pending()
+{
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    for (const auto& pair : spill_logs_) {
+        if (pair.second->has_pending()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<RedisSpillLog> RedisWriter::get_spill_log(const std::string& trading_day)
+{
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+
+    auto it = spill_logs_.find(trading_day);
+    if (it != spill_logs_.end()) {
+        return it->second->is_open() ? it->second : nullptr;
+    }
+
+    std::error_code ec;
+    fs::create_directories(spill_dir_, ec);
+
+    auto spill_log = std::make_shared<RedisSpillLog>();
+    std::string path = (fs::path(spill_dir_) / ("redis_spill_" + trading_day + ".dat")).string();
+    if (!spill_log->open(path, spill_capacity_)) {
+        server_->log_error("Failed to open Redis spill file: " + path);
+    } else {
+        server_->log_info("Opened Redis spill file: " + path);
+    }
+
+    std::shared_ptr<RedisSpillLog> result = spill_log->is_open() ? spill_log : nullptr;
+    spill_logs_[trading_day] = std::move(spill_log);
+    return result;
+}
+
+void RedisWriter::load_existing_spill_logs()
+{
+    std::error_code ec;
+    if (!fs::is_directory(spill_dir_, ec)) {
+        return;
+    }
+
+    const std::string prefix = "redis_spill_";
+    const std::string suffix = ".dat";
+
+    for (const auto& entry : fs::directory_iterator(spill_dir_, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= prefix.size() + suffix.size() ||
+            name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            continue;
+        }
+
+        std::string trading_day = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        auto spill_log = std::make_shared<RedisSpillLog>();
+        if (!spill_log->open(entry.path().string(), spill_capacity_)) {
+            continue;
+        }
+
+        if (spill_log->has_pending()) {
+            server_->log_info("Found Redis spill file with " + std::to_string(spill_log->pending_bytes()) +
+                              " pending bytes: " + entry.path().string());
+            std::lock_guard<std::mutex> lock(spill_mutex_);
+            spill_logs_[trading_day] = std::move(spill_log);
+        } else {
+            spill_log->close();
+            fs::remove(entry.path(), ec);
+        }
+    }
+}
+
+std::string RedisWriter::trading_day_of(long long timestamp_ms)
+{
+    // timestamp_ms由TradingDay + UpdateTime生成，其本地日期即交易日
+    std::time_t seconds = static_cast<std::time_t>(timestamp_ms / 1000);
+    struct tm result_tm;
+    localtime_r(&seconds, &result_tm);
+
+    char buffer[16];
+    strftime(buffer, sizeof(buffer), "%Y%m%d", &result_tm);
+    return buffer;
+}
@@ -0,0 +1,153 @@
+/////////////////////////////////////////////////////////////////////////
+///@file redis_writer.h
+///@brief	行情Redis写入器（故障溢出与恢复回放）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "redis_client.h"
+#include "redis_spill_log.h"
+#include "multi_ctp_config.h"
+#include <memory>
+#include <map>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <condition_variable>
+
+class MarketDataServer;
+
+// 待写入的一条tick
+struct RedisPendingTick {
+    std::string instrument_id;
+    std::string json_data;
+    long long timestamp_ms;
+    std::string history_member;
+    std::string publish_channel;  // 为空时不发布
+    uint64_t sequence;            // 写入器内的到达序号，用于判断最新行情的先后
+    bool publish_only;            // 仅PUBLISH：频道落在本节点而行情数据在其他节点
+};
+
+// 故障期间某个合约待补写的最新行情
+struct RedisPendingLatest {
+    std::string json_data;
+    uint64_t sequence;
+};
+
+// 合并窗口内待发布的最新行情
+struct RedisPendingPublish {
+    std::string channel;
+    std::string payload;
+};
+
+// Redis写入器（对应一个Redis节点）
+// Redis健康时tick进入写队列，由写线程按批次以管道方式写入；不健康时历史tick追加到
+// 本地溢出文件（按交易日），最新行情只保留内存中的最后一条。后台线程按退避策略重连，
+// 恢复后按限速把溢出数据回放到Redis，行情线程不等待写入、重连和回放。
+class RedisWriter
+{
+public:
+    RedisWriter(MarketDataServer* server, const std::string& host, int port,
+                const std::string& spill_dir, const MultiCTPConfig& config);
+    ~RedisWriter();
+
+    // 尝试首次连接并启动恢复线程，首次连接失败不影响启动
+    bool start();
+    void stop();
+
+    // 写入一条行情：最新行情(JSON) + 历史tick（history_member为JSON或二进制编码），只入队不阻塞
+    // publish_channel非空时在同一管道批次中PUBLISH该行情（Redis不可用期间不补发）
+    void write_tick(const std::string& instrument_id, const std::string& json_data,
+                    long long timestamp_ms, const std::string& history_member,
+                    const std::string& publish_channel = "");
+
+    // 只发布不存储：分片时频道按频道名落在固定节点，可能与行情数据不在同一节点
+    void publish(const std::string& instrument_id, const std::string& json_data, const std::string& publish_channel);
+
+    bool is_healthy() const { return client_->is_connected(); }
+    RedisClient* get_client() { return client_.get(); }
+    const std::string& get_endpoint() const { return endpoint_; }
+
+    // 统计信息
+    size_t get_spilled_records() const { return spilled_records_; }
+    size_t get_replayed_records() const { return replayed_records_; }
+    size_t get_written_records() const { return written_records_; }
+    size_t get_published_records() const { return published_records_; }
+    size_t get_queue_size() const;
+
+private:
+    // 管道写线程
+    void writer_loop();
+    void flush_batch(std::vector<RedisPendingTick>& batch);
+    void collect_publish(const std::vector<RedisPendingTick>& batch, long long now_ms,
+                         std::vector<std::vector<std::string>>& commands);
+
+    void spill_tick(const std::string& instrument_id, const std::string& json_data,
+                    long long timestamp_ms, const std::string& history_member, uint64_t sequence);
+    void trim_history(const std::string& history_key);
+
+    // 后台重连与回放
+    void recovery_loop();
+    bool try_reconnect();
+    size_t replay_spill(size_t budget);
+    size_t replay_pending_latest();   // 仅写线程调用，与实时SET保持同一顺序
+    bool has_spill_pending();
+
+    std::shared_ptr<RedisSpillLog> get_spill_log(const std::string& trading_day);
+    void load_existing_spill_logs();
+    void retire_replayed_spill_logs();
+    static std::string trading_day_of(long long timestamp_ms);
+
+    MarketDataServer* server_;
+    std::unique_ptr<RedisClient> client_;
+    std::string endpoint_;
+
+    // 溢出文件配置
+    std::string spill_dir_;
+    size_t spill_capacity_;
+    int replay_rate_;
+    int max_backoff_seconds_;
+
+    // 写队列
+    std::deque<RedisPendingTick> queue_;
+    mutable std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    size_t queue_limit_;
+    size_t pipeline_batch_;
+    std::unique_ptr<std::thread> writer_thread_;
+
+    // 每个历史key的写入计数，用于降低ZCARD检查频率（仅写线程访问）
+    std::unordered_map<std::string, size_t> history_write_counts_;
+
+    // 发布合并（仅写线程访问）：instrument_id -> 窗口内最新行情 / 上次发布时间
+    int publish_conflation_ms_;
+    std::unordered_map<std::string, RedisPendingPublish> pending_publish_;
+    std::unordered_map<std::string, long long> last_publish_ms_;
+
+    // trading_day -> 溢出文件；往日的文件回放完后关闭、移出并删除，持有方用shared_ptr避免被移出时失效
+    std::map<std::string, std::shared_ptr<RedisSpillLog>> spill_logs_;
+    std::mutex spill_mutex_;
+
+    // 故障期间每个合约的最新行情，恢复后若未被实时写入覆盖则补写；只保留序号最大的一条
+    std::map<std::string, RedisPendingLatest> pending_latest_;
+    // 每个合约已实时写入的最大序号，比它旧的值不再进入pending_latest_
+    std::unordered_map<std::string, uint64_t> live_latest_sequence_;
+    std::mutex pending_latest_mutex_;
+    std::atomic<uint64_t> next_sequence_;
+
+    // 恢复线程
+    std::unique_ptr<std::thread> recovery_thread_;
+    std::atomic<bool> running_;
+
+    // 统计数据
+    std::atomic<size_t> spilled_records_;
+    std::atomic<size_t> replayed_records_;
+    std::atomic<size_t> written_records_;
+    std::atomic<size_t> published_records_;
+    std::atomic<size_t> overflow_records_;
+};
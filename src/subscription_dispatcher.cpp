@@ -10,13 +10,42 @@
 #include <algorithm>
 #include <random>
 #include <functional>
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <rapidjson/document.h>
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
 
 SubscriptionDispatcher::SubscriptionDispatcher(MarketDataServer* server)
     : server_(server)
     , connection_manager_(nullptr)
     , load_balance_strategy_(LoadBalanceStrategy::CONNECTION_QUALITY)
     , round_robin_counter_(0)
-    , maintenance_running_(false)
+    , redundancy_mode_(RedundancyMode::NONE)
+    , rate_balance_interval_(0)
+    , rate_balance_max_moves_(20)
+    , rate_balance_tolerance_(0.2)
+    , rebalance_interval_(0)
+    , rebalance_requested_(false)
+    , planner_ticks_(0)
+    , seconds_since_rate_plan_(0)
+    , seconds_since_rebalance_(0)
+    , move_limiter_(20, 20)
+    , moves_applied_(0)
+    , linger_seconds_(0)
+    , linger_max_per_connection_(0)
+    , lingering_revived_(0)
+    , lingering_evicted_(0)
+    , universe_save_interval_(60)
+    , universe_grace_seconds_(600)
+    , loop_running_(false)
+    , commands_processed_(0)
+    , wait_total_us_(0.0)
+    , wait_max_us_(0.0)
+    , snapshot_(std::make_shared<Snapshot>())
+    , snapshot_dirty_(false)
     , maintenance_interval_(60) // 60秒维护间隔
     , max_retry_count_(3)
     , total_subscriptions_processed_(0)
@@ -38,7 +67,7 @@ bool SubscriptionDispatcher::initialize(CTPConnectionManager* connection_manager
     }
     
     connection_manager_ = connection_manager;
-    start_maintenance_timer();
+    start_event_loop();
     
     server_->log_info("SubscriptionDispatcher initialized successfully");
     return true;
@@ -46,35 +75,279 @@ bool SubscriptionDispatcher::initialize(CTPConnectionManager* connection_manager
 
 void SubscriptionDispatcher::shutdown()
 {
-    stop_maintenance_timer();
+    if (!loop_thread_) {
+        return;
+    }
     
-    std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
-    std::lock_guard<std::mutex> sess_lock(sessions_mutex_);
-    std::lock_guard<std::mutex> conn_lock(connections_mutex_);
+    // 事件循环退出前执行完已投递的命令，之后状态只由当前线程访问
+    stop_event_loop();
+    
+    // 退出前保存一次订阅集合
+    if (!universe_file_.empty()) {
+        save_universe();
+    }
     
     global_subscriptions_.clear();
     session_subscriptions_.clear();
     connection_subscriptions_.clear();
+    lingering_lru_.clear();
     
     server_->log_info("SubscriptionDispatcher shutdown completed");
 }
 
-bool SubscriptionDispatcher::add_subscription(const std::string& session_id, const std::string& instrument_id)
+void SubscriptionDispatcher::post(std::function<void()> command)
+{
+    {
+        std::lock_guard<std::mutex> lock(commands_mutex_);
+        commands_.push_back(LoopCommand{std::move(command), std::chrono::steady_clock::now()});
+    }
+    commands_cv_.notify_one();
+}
+
+void SubscriptionDispatcher::start_event_loop()
+{
+    if (loop_running_) {
+        return;
+    }
+    
+    loop_running_ = true;
+    loop_started_ = std::chrono::steady_clock::now();
+    loop_thread_ = std::make_unique<std::thread>(&SubscriptionDispatcher::event_loop, this);
+    
+    server_->log_info("Started subscription dispatcher event loop");
+}
+
+void SubscriptionDispatcher::stop_event_loop()
+{
+    {
+        std::lock_guard<std::mutex> lock(commands_mutex_);
+        loop_running_ = false;
+    }
+    commands_cv_.notify_one();
+    
+    if (loop_thread_ && loop_thread_->joinable()) {
+        loop_thread_->join();
+    }
+    
+    loop_thread_.reset();
+    server_->log_info("Stopped subscription dispatcher event loop");
+}
+
+void SubscriptionDispatcher::event_loop()
+{
+    // 定时任务：规划每100ms一次，维护每maintenance_interval_一次，快照至多每20ms发布一次，
+    // 订阅集合按自己的保存间隔（可短于维护间隔）
+    const auto kPlannerPeriod = std::chrono::milliseconds(100);
+    const auto kSnapshotPeriod = std::chrono::milliseconds(20);
+    auto next_planner = std::chrono::steady_clock::now() + kPlannerPeriod;
+    auto next_maintenance = std::chrono::steady_clock::now() + maintenance_interval_;
+    
+    while (true) {
+        std::deque<LoopCommand> batch;
+        {
+            std::unique_lock<std::mutex> lock(commands_mutex_);
+            auto deadline = std::min(next_planner, next_maintenance);
+            if (snapshot_dirty_) {
+                deadline = std::min(deadline, last_snapshot_ + kSnapshotPeriod);
+            }
+            if (!universe_file_.empty()) {
+                deadline = std::min(deadline, next_universe_save_);
+            }
+            commands_cv_.wait_until(lock, deadline, [this]() { return !commands_.empty() || !loop_running_; });
+            batch.swap(commands_);
+            if (batch.empty() && !loop_running_) {
+                break;
+            }
+        }
+        
+        for (auto& command : batch) {
+            auto started = std::chrono::steady_clock::now();
+            double wait_us = std::chrono::duration<double, std::micro>(started - command.posted).count();
+            wait_total_us_ = wait_total_us_ + wait_us;
+            if (wait_us > wait_max_us_) {
+                wait_max_us_ = wait_us;
+            }
+            
+            try {
+                command.run();
+            } catch (const std::exception& e) {
+                server_->log_error("Subscription dispatcher command error: " + std::string(e.what()));
+            }
+            commands_processed_++;
+        }
+        if (!batch.empty()) {
+            snapshot_dirty_ = true;
+        }
+        
+        auto now = std::chrono::steady_clock::now();
+        try {
+            if (now >= next_planner) {
+                next_planner = now + kPlannerPeriod;
+                planner_tick();
+            }
+            if (now >= next_maintenance) {
+                next_maintenance = now + maintenance_interval_;
+                maintenance_task();
+                snapshot_dirty_ = true;
+            }
+            if (!universe_file_.empty() && now >= next_universe_save_) {
+                next_universe_save_ = now + std::chrono::seconds(universe_save_interval_);
+                save_universe();
+            }
+        } catch (const std::exception& e) {
+            server_->log_error("Subscription dispatcher timer error: " + std::string(e.what()));
+        }
+        
+        if (snapshot_dirty_ && now - last_snapshot_ >= kSnapshotPeriod) {
+            publish_snapshot();
+        }
+    }
+    
+    publish_snapshot();
+}
+
+void SubscriptionDispatcher::publish_snapshot()
 {
-    std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
-    std::lock_guard<std::mutex> sess_lock(sessions_mutex_);
+    auto snapshot = std::make_shared<Snapshot>();
+    for (const auto& pair : session_subscriptions_) {
+        snapshot->session_instruments[pair.first].assign(pair.second.begin(), pair.second.end());
+    }
+    
+    auto& stats = snapshot->statistics;
+    stats.total_instruments = global_subscriptions_.size();
+    stats.total_sessions = session_subscriptions_.size();
+    stats.lingering_subscriptions = lingering_lru_.size();
+    for (const auto& pair : global_subscriptions_) {
+        snapshot->instrument_status[pair.first] = pair.second->status;
+        if (!pair.second->requesting_sessions.empty()) {
+            snapshot->instrument_sessions[pair.first].assign(pair.second->requesting_sessions.begin(),
+                                                             pair.second->requesting_sessions.end());
+        }
+        switch (pair.second->status) {
+            case SubscriptionStatus::ACTIVE:
+                stats.active_subscriptions++;
+                break;
+            case SubscriptionStatus::PENDING:
+            case SubscriptionStatus::SUBSCRIBING:
+                stats.pending_subscriptions++;
+                break;
+            case SubscriptionStatus::FAILED:
+                stats.failed_subscriptions++;
+                break;
+            default:
+                break;
+        }
+    }
+    
+    // 连接分布统计
+    for (const auto& pair : connection_subscriptions_) {
+        stats.connection_distribution[pair.first] = pair.second.size();
+    }
+    snapshot->relative_lag_ms = relative_lag_ms_;
     
+    std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+    snapshot_dirty_ = false;
+    last_snapshot_ = std::chrono::steady_clock::now();
+}
+
+SubscriptionDispatcher::LoopStatistics SubscriptionDispatcher::get_loop_statistics() const
+{
+    LoopStatistics stats = {};
+    {
+        std::lock_guard<std::mutex> lock(commands_mutex_);
+        stats.queue_depth = commands_.size();
+    }
+    stats.commands_processed = commands_processed_;
+    stats.avg_wait_us = stats.commands_processed ? wait_total_us_ / stats.commands_processed : 0.0;
+    stats.max_wait_us = wait_max_us_;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - loop_started_).count();
+    stats.commands_per_second = elapsed > 0.0 ? stats.commands_processed / elapsed : 0.0;
+    return stats;
+}
+
+bool SubscriptionDispatcher::add_subscription(const std::string& session_id, const std::string& instrument_id)
+{
+    post([this, session_id, instrument_id]() { add_subscription_on_loop(session_id, instrument_id); });
+    return true;
+}
+
+bool SubscriptionDispatcher::remove_subscription(const std::string& session_id, const std::string& instrument_id)
+{
+    post([this, session_id, instrument_id]() { remove_subscription_on_loop(session_id, instrument_id); });
+    return true;
+}
+
+void SubscriptionDispatcher::remove_all_subscriptions_for_session(const std::string& session_id)
+{
+    post([this, session_id]() {
+        auto sess_it = session_subscriptions_.find(session_id);
+        if (sess_it != session_subscriptions_.end()) {
+            std::vector<std::string> instruments(sess_it->second.begin(), sess_it->second.end());
+            remove_subscriptions_on_loop(session_id, instruments);
+        }
+    });
+}
+
+size_t SubscriptionDispatcher::add_subscriptions(const std::string& session_id, const std::vector<std::string>& instrument_ids)
+{
+    if (instrument_ids.empty()) {
+        return 0;
+    }
+    post([this, session_id, instrument_ids]() { add_subscriptions_on_loop(session_id, instrument_ids); });
+    return instrument_ids.size();
+}
+
+size_t SubscriptionDispatcher::remove_subscriptions(const std::string& session_id, const std::vector<std::string>& instrument_ids)
+{
+    if (instrument_ids.empty()) {
+        return 0;
+    }
+    post([this, session_id, instrument_ids]() { remove_subscriptions_on_loop(session_id, instrument_ids); });
+    return instrument_ids.size();
+}
+
+void SubscriptionDispatcher::handle_connection_failure(const std::string& connection_id)
+{
+    post([this, connection_id]() { handle_connection_failure_on_loop(connection_id); });
+}
+
+void SubscriptionDispatcher::handle_connection_recovery(const std::string& connection_id)
+{
+    post([this, connection_id]() { handle_connection_recovery_on_loop(connection_id); });
+}
+
+void SubscriptionDispatcher::on_subscription_success(const std::string& connection_id, const std::string& instrument_id)
+{
+    post([this, connection_id, instrument_id]() { on_subscription_success_on_loop(connection_id, instrument_id); });
+}
+
+void SubscriptionDispatcher::on_subscription_failed(const std::string& connection_id, const std::string& instrument_id)
+{
+    post([this, connection_id, instrument_id]() { on_subscription_failed_on_loop(connection_id, instrument_id); });
+}
+
+void SubscriptionDispatcher::on_unsubscription_success(const std::string& connection_id, const std::string& instrument_id)
+{
+    post([this, connection_id, instrument_id]() { on_unsubscription_success_on_loop(connection_id, instrument_id); });
+}
+
+void SubscriptionDispatcher::add_subscription_on_loop(const std::string& session_id, const std::string& instrument_id)
+{
     total_subscriptions_processed_++;
     
     // 检查是否已经存在全局订阅
     auto global_it = global_subscriptions_.find(instrument_id);
     if (global_it != global_subscriptions_.end()) {
         // 添加session到现有订阅
+        if (global_it->second->lingering) {
+            revive_subscription(*global_it->second);
+            server_->log_info("Revived lingering subscription: " + instrument_id);
+        }
         global_it->second->requesting_sessions.insert(session_id);
         session_subscriptions_[session_id].insert(instrument_id);
         
         server_->log_info("Added session " + session_id + " to existing subscription: " + instrument_id);
-        return true;
+        return;
     }
     
     // 创建新的订阅
@@ -82,6 +355,7 @@ bool SubscriptionDispatcher::add_subscription(const std::string& session_id, con
     subscription_info->requesting_sessions.insert(session_id);
     global_subscriptions_[instrument_id] = subscription_info;
     session_subscriptions_[session_id].insert(instrument_id);
+    track_instrument_rate(instrument_id);
     
     // 选择最佳连接  
     std::shared_ptr<CTPConnection> best_connection = nullptr;
@@ -98,6 +372,9 @@ bool SubscriptionDispatcher::add_subscription(const std::string& session_id, con
         case LoadBalanceStrategy::HASH_BASED:
             best_connection = select_connection_by_hash(instrument_id);
             break;
+        case LoadBalanceStrategy::LATENCY:
+            best_connection = select_connection_by_latency(connection_manager_->get_available_connections());
+            break;
         default:
             best_connection = select_connection_by_quality();
             break;
@@ -106,7 +383,7 @@ bool SubscriptionDispatcher::add_subscription(const std::string& session_id, con
         server_->log_error("No available connection for subscription: " + instrument_id);
         subscription_info->status = SubscriptionStatus::FAILED;
         failed_subscriptions_++;
-        return false;
+        return;
     }
     
     subscription_info->assigned_connection_id = best_connection->get_connection_id();
@@ -117,18 +394,20 @@ bool SubscriptionDispatcher::add_subscription(const std::string& session_id, con
     if (!result) {
         subscription_info->status = SubscriptionStatus::FAILED;
         failed_subscriptions_++;
+    } else if (needs_standby(instrument_id)) {
+        // 冗余模式：同时在另一个前置订阅
+        auto standby = select_standby_connection({best_connection->get_connection_id()});
+        if (standby && execute_subscription(instrument_id, standby->get_connection_id())) {
+            subscription_info->standby_connection_id = standby->get_connection_id();
+        }
     }
     
     server_->log_info("Added new subscription: " + instrument_id + " on connection " + 
                      best_connection->get_connection_id());
-    return result;
 }
 
-bool SubscriptionDispatcher::remove_subscription(const std::string& session_id, const std::string& instrument_id)
+void SubscriptionDispatcher::remove_subscription_on_loop(const std::string& session_id, const std::string& instrument_id)
 {
-    std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
-    std::lock_guard<std::mutex> sess_lock(sessions_mutex_);
-    
     // 从session订阅中移除
     auto sess_it = session_subscriptions_.find(session_id);
     if (sess_it != session_subscriptions_.end()) {
@@ -141,55 +420,192 @@ bool SubscriptionDispatcher::remove_subscription(const std::string& session_id,
     // 检查全局订阅
     auto global_it = global_subscriptions_.find(instrument_id);
     if (global_it == global_subscriptions_.end()) {
-        return true; // 订阅不存在
+        return; // 订阅不存在
     }
     
     // 从请求session列表中移除
     global_it->second->requesting_sessions.erase(session_id);
     
-    // 如果没有session再需要此订阅，则取消CTP订阅
+    // 如果没有session再需要此订阅，则进入保留队列或取消CTP订阅
     if (global_it->second->requesting_sessions.empty()) {
-        std::string connection_id = global_it->second->assigned_connection_id;
+        std::map<std::string, std::vector<std::string>> releases;
+        retire_subscription(instrument_id, releases);
         
-        if (execute_unsubscription(instrument_id, connection_id)) {
-            server_->log_info("Removed subscription: " + instrument_id + " from connection " + connection_id);
+        for (const auto& pair : releases) {
+            for (const auto& released_id : pair.second) {
+                if (execute_unsubscription(released_id, pair.first)) {
+                    server_->log_info("Removed subscription: " + released_id + " from connection " + pair.first);
+                }
+            }
         }
-        
-        global_subscriptions_.erase(global_it);
     } else {
         server_->log_info("Kept subscription " + instrument_id + " (still needed by " + 
                          std::to_string(global_it->second->requesting_sessions.size()) + " sessions)");
     }
+}
+
+void SubscriptionDispatcher::add_subscriptions_on_loop(const std::string& session_id, const std::vector<std::string>& instrument_ids)
+{
+    auto start_time = std::chrono::steady_clock::now();
+    size_t existing_count = 0;
+    size_t revived_count = 0;
+    size_t failed_count = 0;
+    size_t standby_count = 0;
+    std::map<std::string, std::vector<std::string>> assignments;  // connection_id -> instruments
+    
+    // 可用连接在整个批次内只查询一次
+    auto available_connections = connection_manager_
+        ? connection_manager_->get_available_connections()
+        : std::vector<std::shared_ptr<CTPConnection>>();
+    std::map<std::string, size_t> planned;
+    
+    for (const auto& instrument_id : instrument_ids) {
+        total_subscriptions_processed_++;
+        session_subscriptions_[session_id].insert(instrument_id);
+        
+        auto global_it = global_subscriptions_.find(instrument_id);
+        if (global_it != global_subscriptions_.end()) {
+            if (global_it->second->lingering) {
+                revive_subscription(*global_it->second);
+                revived_count++;
+            }
+            global_it->second->requesting_sessions.insert(session_id);
+            existing_count++;
+            continue;
+        }
+        
+        auto subscription_info = std::make_shared<SubscriptionInfo>(instrument_id);
+        subscription_info->requesting_sessions.insert(session_id);
+        global_subscriptions_[instrument_id] = subscription_info;
+        track_instrument_rate(instrument_id);
+        
+        auto connection = select_connection_for_batch(instrument_id, available_connections, planned);
+        if (!connection) {
+            subscription_info->status = SubscriptionStatus::FAILED;
+            failed_subscriptions_++;
+            failed_count++;
+            continue;
+        }
+        
+        subscription_info->assigned_connection_id = connection->get_connection_id();
+        subscription_info->status = SubscriptionStatus::SUBSCRIBING;
+        planned[connection->get_connection_id()]++;
+        assignments[connection->get_connection_id()].push_back(instrument_id);
+        
+        // 冗余模式：在另一个前置上同时订阅
+        if (needs_standby(instrument_id)) {
+            std::vector<std::shared_ptr<CTPConnection>> standby_candidates;
+            for (const auto& conn : available_connections) {
+                if (conn != connection) {
+                    standby_candidates.push_back(conn);
+                }
+            }
+            auto standby = select_connection_for_batch(instrument_id, standby_candidates, planned);
+            if (standby) {
+                subscription_info->standby_connection_id = standby->get_connection_id();
+                planned[standby->get_connection_id()]++;
+                assignments[standby->get_connection_id()].push_back(instrument_id);
+                standby_count++;
+            }
+        }
+    }
     
-    return true;
+    // 每个连接一次数组订阅
+    size_t issued_count = 0;
+    for (const auto& pair : assignments) {
+        auto connection = connection_manager_->get_connection(pair.first);
+        std::vector<std::string> rejected;
+        if (connection) {
+            issued_count += connection->subscribe_instruments(pair.second, rejected);
+        } else {
+            rejected = pair.second;
+        }
+        
+        for (const auto& instrument_id : rejected) {
+            auto it = global_subscriptions_.find(instrument_id);
+            if (it == global_subscriptions_.end()) {
+                continue;
+            }
+            if (it->second->standby_connection_id == pair.first) {
+                // 热备订阅失败不影响主订阅
+                it->second->standby_connection_id.clear();
+                standby_count--;
+                continue;
+            }
+            it->second->status = SubscriptionStatus::FAILED;
+            it->second->retry_count++;
+            it->second->last_update_time = std::chrono::system_clock::now();
+            failed_subscriptions_++;
+            failed_count++;
+            
+            if (it->second->retry_count < max_retry_count_) {
+                retry_queue_.push(instrument_id);
+            }
+        }
+    }
+    
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    server_->log_info("Batch subscribe for session " + session_id + ": " + std::to_string(instrument_ids.size()) +
+                     " requested, " + std::to_string(existing_count) + " shared (" +
+                     std::to_string(revived_count) + " revived), " + std::to_string(issued_count) +
+                     " issued on " + std::to_string(assignments.size()) + " connections (" +
+                     std::to_string(standby_count) + " standby), " +
+                     std::to_string(failed_count) + " failed in " + std::to_string(elapsed_ms) + " ms");
 }
 
-void SubscriptionDispatcher::remove_all_subscriptions_for_session(const std::string& session_id)
+void SubscriptionDispatcher::remove_subscriptions_on_loop(const std::string& session_id, const std::vector<std::string>& instrument_ids)
 {
-    std::vector<std::string> instruments_to_remove;
+    size_t kept_count = 0;
+    size_t lingering_count = 0;
+    std::map<std::string, std::vector<std::string>> releases;  // connection_id -> instruments
     
-    {
-        std::lock_guard<std::mutex> sess_lock(sessions_mutex_);
-        auto sess_it = session_subscriptions_.find(session_id);
+    auto sess_it = session_subscriptions_.find(session_id);
+    for (const auto& instrument_id : instrument_ids) {
         if (sess_it != session_subscriptions_.end()) {
-            instruments_to_remove.assign(sess_it->second.begin(), sess_it->second.end());
+            sess_it->second.erase(instrument_id);
+        }
+        
+        auto global_it = global_subscriptions_.find(instrument_id);
+        if (global_it == global_subscriptions_.end()) {
+            continue;
+        }
+        
+        global_it->second->requesting_sessions.erase(session_id);
+        if (!global_it->second->requesting_sessions.empty()) {
+            kept_count++;
+            continue;
+        }
+        
+        retire_subscription(instrument_id, releases);
+        if (global_subscriptions_.count(instrument_id)) {
+            lingering_count++;
         }
     }
+    if (sess_it != session_subscriptions_.end() && sess_it->second.empty()) {
+        session_subscriptions_.erase(sess_it);
+    }
     
-    for (const auto& instrument_id : instruments_to_remove) {
-        remove_subscription(session_id, instrument_id);
+    size_t released_count = 0;
+    for (const auto& pair : releases) {
+        auto connection = connection_manager_ ? connection_manager_->get_connection(pair.first) : nullptr;
+        if (connection) {
+            released_count += connection->unsubscribe_instruments(pair.second);
+        }
     }
     
-    server_->log_info("Removed all subscriptions for session: " + session_id);
+    server_->log_info("Batch unsubscribe for session " + session_id + ": " + std::to_string(instrument_ids.size()) +
+                     " requested, " + std::to_string(kept_count) + " still shared, " + std::to_string(lingering_count) +
+                     " lingering, " + std::to_string(released_count) +
+                     " released on " + std::to_string(releases.size()) + " connections");
 }
 
 std::vector<std::string> SubscriptionDispatcher::get_subscriptions_for_session(const std::string& session_id)
 {
-    std::lock_guard<std::mutex> lock(sessions_mutex_);
-    
-    auto it = session_subscriptions_.find(session_id);
-    if (it != session_subscriptions_.end()) {
-        return std::vector<std::string>(it->second.begin(), it->second.end());
+    auto snapshot = std::atomic_load(&snapshot_);
+    auto it = snapshot->session_instruments.find(session_id);
+    if (it != snapshot->session_instruments.end()) {
+        return it->second;
     }
     
     return {};
@@ -197,12 +613,10 @@ std::vector<std::string> SubscriptionDispatcher::get_subscriptions_for_session(c
 
 std::vector<std::string> SubscriptionDispatcher::get_sessions_for_instrument(const std::string& instrument_id)
 {
-    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
-    
-    auto it = global_subscriptions_.find(instrument_id);
-    if (it != global_subscriptions_.end()) {
-        return std::vector<std::string>(it->second->requesting_sessions.begin(), 
-                                       it->second->requesting_sessions.end());
+    auto snapshot = std::atomic_load(&snapshot_);
+    auto it = snapshot->instrument_sessions.find(instrument_id);
+    if (it != snapshot->instrument_sessions.end()) {
+        return it->second;
     }
     
     return {};
@@ -210,11 +624,10 @@ std::vector<std::string> SubscriptionDispatcher::get_sessions_for_instrument(con
 
 SubscriptionStatus SubscriptionDispatcher::get_subscription_status(const std::string& instrument_id)
 {
-    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
-    
-    auto it = global_subscriptions_.find(instrument_id);
-    if (it != global_subscriptions_.end()) {
-        return it->second->status;
+    auto snapshot = std::atomic_load(&snapshot_);
+    auto it = snapshot->instrument_status.find(instrument_id);
+    if (it != snapshot->instrument_status.end()) {
+        return it->second;
     }
     
     return SubscriptionStatus::CANCELLED;
@@ -222,8 +635,7 @@ SubscriptionStatus SubscriptionDispatcher::get_subscription_status(const std::st
 
 size_t SubscriptionDispatcher::get_total_subscriptions() const
 {
-    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
-    return global_subscriptions_.size();
+    return std::atomic_load(&snapshot_)->statistics.total_instruments;
 }
 
 void SubscriptionDispatcher::set_load_balance_strategy(LoadBalanceStrategy strategy)
@@ -288,134 +700,564 @@ std::shared_ptr<CTPConnection> SubscriptionDispatcher::select_connection_by_qual
 
 std::shared_ptr<CTPConnection> SubscriptionDispatcher::select_connection_by_hash(const std::string& instrument_id)
 {
-    auto available_connections = connection_manager_->get_available_connections();
-    if (available_connections.empty()) {
-        return nullptr;
-    }
-    
-    // 使用instrument_id的哈希值来选择连接，保证相同合约总是分配到相同连接
-    std::hash<std::string> hasher;
-    size_t hash_value = hasher(instrument_id);
-    size_t index = hash_value % available_connections.size();
-    
-    return available_connections[index];
+    return select_connection_from_ring(instrument_id, connection_manager_->get_available_connections());
 }
 
-int SubscriptionDispatcher::calculate_connection_score(std::shared_ptr<CTPConnection> connection)
+std::shared_ptr<CTPConnection> SubscriptionDispatcher::select_connection_from_ring(
+    const std::string& instrument_id,
+    const std::vector<std::shared_ptr<CTPConnection>>& candidates)
 {
-    if (!connection) {
-        return 0;
+    if (candidates.empty()) {
+        return nullptr;
     }
     
-    int score = connection->get_connection_quality();
-    
-    // 考虑订阅负载
-    size_t sub_count = connection->get_subscription_count();
-    size_t max_subs = 500; // 假设最大订阅数
-    
-    if (sub_count < max_subs * 0.5) {
-        score += 20; // 轻载加分
-    } else if (sub_count > max_subs * 0.8) {
-        score -= 30; // 重载减分
+    // 使用一致性哈希，相同合约总是分配到相同连接；该连接不可用时顺延到环上的下一个候选连接
+    std::map<std::string, std::shared_ptr<CTPConnection>> eligible;
+    for (const auto& conn : candidates) {
+        eligible[conn->get_connection_id()] = conn;
     }
     
-    // 考虑错误率
-    int error_count = connection->get_error_count();
-    score -= std::min(error_count * 5, 40);
+    refresh_hash_ring();
+    std::string owner;
+    owner = hash_ring_.get_name_if(instrument_id, [&eligible](const std::string& name) {
+        return eligible.count(name) > 0;
+    });
     
-    return std::max(0, score);
+    auto it = eligible.find(owner);
+    return it != eligible.end() ? it->second : candidates[0];
 }
 
-void SubscriptionDispatcher::handle_connection_failure(const std::string& connection_id)
+void SubscriptionDispatcher::refresh_hash_ring()
 {
-    std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
-    std::lock_guard<std::mutex> conn_lock(connections_mutex_);
+    if (!connection_manager_) {
+        return;
+    }
     
-    server_->log_warning("Handling connection failure: " + connection_id);
+    // 虚拟节点权重：每100个订阅容量计1份，按优先级(1最高,10最低)折算
+    std::map<std::string, int> weights;
+    for (const auto& conn : connection_manager_->get_all_connections()) {
+        int priority = std::min(10, std::max(1, conn->get_priority()));
+        double capacity = static_cast<double>(conn->get_max_subscriptions()) / 100.0;
+        weights[conn->get_connection_id()] = std::max(1, static_cast<int>(capacity * (11 - priority) / 10.0 + 0.5));
+    }
     
-    // 找出所有使用失败连接的订阅
-    std::vector<std::string> affected_instruments;
+    if (weights == hash_ring_weights_) {
+        return;
+    }
     
-    for (const auto& pair : global_subscriptions_) {
-        if (pair.second->assigned_connection_id == connection_id && 
-            pair.second->status == SubscriptionStatus::ACTIVE) {
-            affected_instruments.push_back(pair.first);
-            pair.second->status = SubscriptionStatus::FAILED;
+    // 只增删变化的节点，其余节点的虚拟节点位置不变
+    for (const auto& pair : hash_ring_weights_) {
+        auto it = weights.find(pair.first);
+        if (it == weights.end() || it->second != pair.second) {
+            hash_ring_.remove_node(pair.first);
         }
     }
-    
-    // 将受影响的订阅迁移到其他连接
-    for (const auto& instrument_id : affected_instruments) {
-        std::shared_ptr<CTPConnection> new_connection = select_connection_by_quality();
-        if (new_connection && new_connection->get_connection_id() != connection_id) {
-            migrate_subscription(instrument_id, connection_id, new_connection->get_connection_id());
-        } else {
-            server_->log_error("No available connection to migrate subscription: " + instrument_id);
+    for (const auto& pair : weights) {
+        auto it = hash_ring_weights_.find(pair.first);
+        if (it == hash_ring_weights_.end() || it->second != pair.second) {
+            hash_ring_.add_node(pair.first, pair.first, pair.second);
         }
     }
-    
-    // 清理连接相关的订阅记录
-    connection_subscriptions_.erase(connection_id);
-    
-    server_->log_info("Connection failure handling completed for: " + connection_id);
+    hash_ring_weights_.swap(weights);
 }
 
-void SubscriptionDispatcher::handle_connection_recovery(const std::string& connection_id)
+std::shared_ptr<CTPConnection> SubscriptionDispatcher::select_failover_connection(const std::string& instrument_id,
+                                                                                 const std::string& failed_connection_id)
 {
-    server_->log_info("Connection recovered: " + connection_id);
+    if (load_balance_strategy_ != LoadBalanceStrategy::HASH_BASED) {
+        auto connection = select_connection_by_quality();
+        return (connection && connection->get_connection_id() != failed_connection_id) ? connection : nullptr;
+    }
     
-    // 处理待重试的订阅
-    process_pending_subscriptions();
+    std::vector<std::shared_ptr<CTPConnection>> candidates;
+    for (const auto& conn : connection_manager_->get_available_connections()) {
+        if (conn->get_connection_id() != failed_connection_id && conn->can_accept_more_subscriptions()) {
+            candidates.push_back(conn);
+        }
+    }
+    return select_connection_from_ring(instrument_id, candidates);
 }
 
-void SubscriptionDispatcher::migrate_subscription(const std::string& instrument_id, 
-                                                const std::string& from_connection_id, 
-                                                const std::string& to_connection_id)
+std::shared_ptr<CTPConnection> SubscriptionDispatcher::select_connection_by_latency(
+    const std::vector<std::shared_ptr<CTPConnection>>& candidates)
 {
-    server_->log_info("Migrating subscription " + instrument_id + " from " + 
-                     from_connection_id + " to " + to_connection_id);
+    if (candidates.empty()) {
+        return nullptr;
+    }
     
-    auto it = global_subscriptions_.find(instrument_id);
-    if (it == global_subscriptions_.end()) {
-        return;
+    std::vector<double> scores;
+    double measured_total = 0.0;
+    size_t measured_count = 0;
+    for (const auto& conn : candidates) {
+        double score = calculate_latency_score(conn);
+        scores.push_back(score);
+        if (score >= 0.0) {
+            measured_total += score;
+            measured_count++;
+        }
     }
     
-    // 更新订阅信息
-    it->second->assigned_connection_id = to_connection_id;
-    it->second->status = SubscriptionStatus::SUBSCRIBING;
-    it->second->retry_count = 0;
+    // 都没有足够样本时退化为连接质量优先
+    if (measured_count == 0) {
+        size_t best = 0;
+        int best_score = calculate_connection_score(candidates[0]);
+        for (size_t i = 1; i < candidates.size(); ++i) {
+            int score = calculate_connection_score(candidates[i]);
+            if (score > best_score) {
+                best_score = score;
+                best = i;
+            }
+        }
+        return candidates[best];
+    }
     
-    // 执行新订阅
-    if (execute_subscription(instrument_id, to_connection_id)) {
-        server_->log_info("Successfully migrated subscription: " + instrument_id);
-    } else {
-        server_->log_error("Failed to migrate subscription: " + instrument_id);
-        it->second->status = SubscriptionStatus::FAILED;
+    // 尚无样本的连接按已测连接的平均延迟参与比较，保证新连接也能分到订阅并积累样本
+    double neutral = measured_total / measured_count;
+    size_t best = 0;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (scores[i] < 0.0) {
+            scores[i] = neutral;
+        }
+        if (scores[i] < scores[best] ||
+            (scores[i] == scores[best] &&
+             candidates[i]->get_subscription_count() < candidates[best]->get_subscription_count())) {
+            best = i;
+        }
     }
+    return candidates[best];
 }
 
-void SubscriptionDispatcher::on_subscription_success(const std::string& connection_id, const std::string& instrument_id)
+std::shared_ptr<CTPConnection> SubscriptionDispatcher::select_connection_for_batch(
+    const std::string& instrument_id,
+    const std::vector<std::shared_ptr<CTPConnection>>& available_connections,
+    const std::map<std::string, size_t>& planned)
 {
-    std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
-    std::lock_guard<std::mutex> conn_lock(connections_mutex_);
-    
-    auto it = global_subscriptions_.find(instrument_id);
-    if (it != global_subscriptions_.end()) {
-        it->second->status = SubscriptionStatus::ACTIVE;
+    // 过滤本批次分配后已满的连接
+    std::vector<std::shared_ptr<CTPConnection>> candidates;
+    std::vector<size_t> pending;
+    for (const auto& conn : available_connections) {
+        auto it = planned.find(conn->get_connection_id());
+        size_t planned_count = (it != planned.end()) ? it->second : 0;
+        if (conn->get_subscription_count() + planned_count < conn->get_max_subscriptions()) {
+            candidates.push_back(conn);
+            pending.push_back(planned_count);
+        }
+    }
+    if (candidates.empty()) {
+        return nullptr;
+    }
+    
+    switch (load_balance_strategy_) {
+        case LoadBalanceStrategy::ROUND_ROBIN:
+            return candidates[round_robin_counter_++ % candidates.size()];
+        case LoadBalanceStrategy::LEAST_CONNECTIONS: {
+            size_t best = 0;
+            for (size_t i = 1; i < candidates.size(); ++i) {
+                if (candidates[i]->get_subscription_count() + pending[i] <
+                    candidates[best]->get_subscription_count() + pending[best]) {
+                    best = i;
+                }
+            }
+            return candidates[best];
+        }
+        case LoadBalanceStrategy::HASH_BASED:
+            return select_connection_from_ring(instrument_id, candidates);
+        case LoadBalanceStrategy::LATENCY:
+            return select_connection_by_latency(candidates);
+        case LoadBalanceStrategy::CONNECTION_QUALITY:
+        default: {
+            size_t best = 0;
+            int best_score = calculate_connection_score(candidates[0], pending[0]);
+            for (size_t i = 1; i < candidates.size(); ++i) {
+                int score = calculate_connection_score(candidates[i], pending[i]);
+                if (score > best_score) {
+                    best_score = score;
+                    best = i;
+                }
+            }
+            return candidates[best];
+        }
+    }
+}
+
+void SubscriptionDispatcher::set_redundancy(RedundancyMode mode, const std::vector<std::string>& instruments)
+{
+    std::set<std::string> normalized;
+    for (const auto& instrument : instruments) {
+        // 统一为不带交易所前缀的CTP合约代码
+        size_t dot_pos = instrument.find('.');
+        normalized.insert(dot_pos != std::string::npos ? instrument.substr(dot_pos + 1) : instrument);
+    }
+    
+    if (mode != RedundancyMode::NONE) {
+        server_->log_info("Dual-front redundancy enabled for " +
+                         (mode == RedundancyMode::ALL ? std::string("all instruments")
+                                                      : std::to_string(normalized.size()) + " hot instruments"));
+    }
+    
+    post([this, mode, normalized]() {
+        redundant_instruments_ = normalized;
+        redundancy_mode_ = mode;
+        tick_arbiter_.set_redundancy_enabled(mode != RedundancyMode::NONE);
+    });
+}
+
+bool SubscriptionDispatcher::needs_standby(const std::string& instrument_id) const
+{
+    switch (redundancy_mode_) {
+        case RedundancyMode::ALL:
+            return true;
+        case RedundancyMode::HOT_SET:
+            return redundant_instruments_.count(instrument_id) > 0;
+        case RedundancyMode::NONE:
+        default:
+            return false;
+    }
+}
+
+std::shared_ptr<CTPConnection> SubscriptionDispatcher::select_standby_connection(const std::set<std::string>& excluded)
+{
+    if (!connection_manager_) {
+        return nullptr;
+    }
+    
+    std::shared_ptr<CTPConnection> best_connection = nullptr;
+    int best_score = -1;
+    for (const auto& conn : connection_manager_->get_available_connections()) {
+        if (excluded.count(conn->get_connection_id())) {
+            continue;
+        }
+        int score = calculate_connection_score(conn);
+        if (score > best_score) {
+            best_score = score;
+            best_connection = conn;
+        }
+    }
+    return best_connection;
+}
+
+int SubscriptionDispatcher::calculate_connection_score(std::shared_ptr<CTPConnection> connection, size_t pending_subscriptions)
+{
+    if (!connection) {
+        return 0;
+    }
+    
+    int score = connection->get_connection_quality();
+    
+    // 考虑订阅负载（含本批次已分配的订阅）
+    size_t sub_count = connection->get_subscription_count() + pending_subscriptions;
+    size_t max_subs = connection->get_max_subscriptions();
+    
+    if (sub_count < max_subs * 0.5) {
+        score += 20; // 轻载加分
+    } else if (sub_count > max_subs * 0.8) {
+        score -= 30; // 重载减分
+    }
+    
+    // 考虑错误率
+    int error_count = connection->get_error_count();
+    score -= std::min(error_count * 5, 40);
+    
+    return std::max(0, score);
+}
+
+double SubscriptionDispatcher::calculate_latency_score(std::shared_ptr<CTPConnection> connection) const
+{
+    const size_t kMinSamples = 50;
+    if (!connection) {
+        return -1.0;
+    }
+    LatencySnapshot latency = connection->get_latency_snapshot();
+    if (latency.samples < kMinSamples) {
+        return -1.0;
+    }
+    // 不同前置承载的合约不同，交易所时间精度也不同（部分交易所毫秒恒为0），
+    // 叠加共享合约上的实测相对滞后修正这种偏差
+    auto it = relative_lag_ms_.find(connection->get_connection_id());
+    return latency.ewma_ms + (it != relative_lag_ms_.end() ? it->second : 0.0);
+}
+
+double SubscriptionDispatcher::get_relative_lag_ms(const std::string& connection_id) const
+{
+    auto snapshot = std::atomic_load(&snapshot_);
+    auto it = snapshot->relative_lag_ms.find(connection_id);
+    return it != snapshot->relative_lag_ms.end() ? it->second : 0.0;
+}
+
+void SubscriptionDispatcher::refresh_relative_lag()
+{
+    // 期望滞后 = 落后到达的比例 * 平均落后时间；只有首发的连接为0
+    std::map<std::string, double> lags;
+    for (const auto& pair : tick_arbiter_.get_stats()) {
+        size_t total = pair.second.first_arrivals + pair.second.duplicates;
+        lags[pair.first] = total ? pair.second.avg_lag_ms * pair.second.duplicates / total : 0.0;
+    }
+    
+    relative_lag_ms_.swap(lags);
+}
+
+void SubscriptionDispatcher::handle_connection_failure_on_loop(const std::string& connection_id)
+{
+    auto start_time = std::chrono::steady_clock::now();
+    
+    // 候选连接只查询一次，整个迁移计划共用
+    std::vector<std::shared_ptr<CTPConnection>> candidates;
+    if (connection_manager_) {
+        for (const auto& conn : connection_manager_->get_available_connections()) {
+            if (conn->get_connection_id() != connection_id) {
+                candidates.push_back(conn);
+            }
+        }
+    }
+    
+    std::map<std::string, std::vector<std::string>> assignments;  // connection_id -> 待订阅合约（含热备）
+    std::map<std::string, std::vector<std::string>> releases;
+    size_t affected_count = 0;
+    size_t unplaced_count = 0;
+    size_t promoted_count = 0;
+    size_t rearmed_count = 0;
+    size_t dropped_lingering_count = 0;
+    
+    server_->log_warning("Handling connection failure: " + connection_id);
+    
+    // 找出所有使用失败连接的订阅
+    std::vector<std::string> affected_instruments;
+    std::vector<std::string> lost_standby;        // 需要重新建立热备的合约
+    std::vector<std::string> dropped_lingering;   // 保留订阅不迁移，直接释放
+    
+    for (const auto& pair : global_subscriptions_) {
+        auto& info = pair.second;
+        
+        // 迁移中：原连接故障则迁移目标直接接管；目标连接故障则撤销迁移，原连接仍在订阅
+        if (!info->migrating_from_connection_id.empty()) {
+            if (info->migrating_from_connection_id == connection_id) {
+                finish_move(*info);
+                continue;
+            }
+            if (info->assigned_connection_id == connection_id) {
+                info->assigned_connection_id = info->migrating_from_connection_id;
+                finish_move(*info);
+                continue;
+            }
+        }
+        
+        if (info->lingering && info->assigned_connection_id == connection_id) {
+            dropped_lingering.push_back(pair.first);
+            continue;
+        }
+        
+        if (info->standby_connection_id == connection_id) {
+            info->standby_connection_id.clear();
+            lost_standby.push_back(pair.first);
+            continue;
+        }
+        
+        if (info->assigned_connection_id != connection_id) {
+            continue;
+        }
+        
+        // 热备已在另一个前置订阅，直接提升为主订阅，无数据间断
+        if (!info->standby_connection_id.empty()) {
+            auto standby = connection_manager_ ? connection_manager_->get_connection(info->standby_connection_id) : nullptr;
+            if (standby && standby->get_status() == CTPConnectionStatus::LOGGED_IN) {
+                info->assigned_connection_id = info->standby_connection_id;
+                info->standby_connection_id.clear();
+                promoted_count++;
+                lost_standby.push_back(pair.first);
+                continue;
+            }
+            info->standby_connection_id.clear();
+        }
+        
+        if (info->status == SubscriptionStatus::ACTIVE) {
+            affected_instruments.push_back(pair.first);
+            info->status = SubscriptionStatus::FAILED;
+        }
+    }
+    
+    for (const auto& instrument_id : dropped_lingering) {
+        release_subscription(instrument_id, releases);
+    }
+    dropped_lingering_count = dropped_lingering.size();
+    
+    // 迁移计划：按负载均衡策略逐个放置，计入本次已分配的数量，先只改状态不下发请求
+    std::map<std::string, size_t> planned;
+    for (const auto& instrument_id : affected_instruments) {
+        auto& info = global_subscriptions_[instrument_id];
+        auto target = select_connection_for_batch(instrument_id, candidates, planned);
+        if (!target) {
+            server_->log_error("No available connection to migrate subscription: " + instrument_id);
+            unplaced_count++;
+            continue;
+        }
+        info->assigned_connection_id = target->get_connection_id();
+        info->status = SubscriptionStatus::SUBSCRIBING;
+        info->retry_count = 0;
+        planned[target->get_connection_id()]++;
+        assignments[target->get_connection_id()].push_back(instrument_id);
+    }
+    affected_count = affected_instruments.size();
+    
+    // 重新建立热备
+    for (const auto& instrument_id : lost_standby) {
+        auto it = global_subscriptions_.find(instrument_id);
+        if (it == global_subscriptions_.end() || !needs_standby(instrument_id)) {
+            continue;
+        }
+        std::vector<std::shared_ptr<CTPConnection>> standby_candidates;
+        for (const auto& conn : candidates) {
+            if (conn->get_connection_id() != it->second->assigned_connection_id) {
+                standby_candidates.push_back(conn);
+            }
+        }
+        auto standby = select_connection_for_batch(instrument_id, standby_candidates, planned);
+        if (standby) {
+            it->second->standby_connection_id = standby->get_connection_id();
+            planned[standby->get_connection_id()]++;
+            assignments[standby->get_connection_id()].push_back(instrument_id);
+            rearmed_count++;
+        }
+    }
+    
+    // 清理连接相关的订阅记录
+    connection_subscriptions_.erase(connection_id);
+    
+    auto planned_time = std::chrono::steady_clock::now();
+    
+    // 统一下发：每个目标连接一次数组订阅
+    apply_releases(releases);
+    size_t issued_count = 0;
+    for (const auto& pair : assignments) {
+        issued_count += issue_batch_subscriptions(pair.first, pair.second);
+    }
+    
+    auto end_time = std::chrono::steady_clock::now();
+    auto plan_ms = std::chrono::duration_cast<std::chrono::milliseconds>(planned_time - start_time).count();
+    auto total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+    
+    server_->log_info("Connection failure handling completed for: " + connection_id +
+                     " (promoted standby: " + std::to_string(promoted_count) +
+                     ", migrated: " + std::to_string(affected_count - unplaced_count) + "/" + std::to_string(affected_count) +
+                     ", issued: " + std::to_string(issued_count) + " on " + std::to_string(assignments.size()) + " connections" +
+                     ", standby re-armed: " + std::to_string(rearmed_count) +
+                     ", lingering dropped: " + std::to_string(dropped_lingering_count) +
+                     ", plan " + std::to_string(plan_ms) + " ms, total " + std::to_string(total_ms) + " ms)");
+}
+
+size_t SubscriptionDispatcher::issue_batch_subscriptions(const std::string& connection_id,
+                                                         const std::vector<std::string>& instrument_ids)
+{
+    auto connection = connection_manager_ ? connection_manager_->get_connection(connection_id) : nullptr;
+    std::vector<std::string> rejected;
+    size_t issued = 0;
+    if (connection) {
+        issued = connection->subscribe_instruments(instrument_ids, rejected);
+    } else {
+        rejected = instrument_ids;
+    }
+    if (rejected.empty()) {
+        return issued;
+    }
+    
+    // 被拒绝的订阅：热备直接放弃，主订阅进入重试队列
+    for (const auto& instrument_id : rejected) {
+        auto it = global_subscriptions_.find(instrument_id);
+        if (it == global_subscriptions_.end()) {
+            continue;
+        }
+        if (it->second->standby_connection_id == connection_id) {
+            it->second->standby_connection_id.clear();
+            continue;
+        }
+        if (it->second->assigned_connection_id != connection_id) {
+            continue;
+        }
+        it->second->status = SubscriptionStatus::FAILED;
+        it->second->retry_count++;
+        it->second->last_update_time = std::chrono::system_clock::now();
+        failed_subscriptions_++;
+        
+        if (it->second->retry_count < max_retry_count_) {
+            retry_queue_.push(instrument_id);
+        }
+    }
+    return issued;
+}
+
+void SubscriptionDispatcher::handle_connection_recovery_on_loop(const std::string& connection_id)
+{
+    server_->log_info("Connection recovered: " + connection_id);
+    
+    // 重启后首次登录：批量恢复上次保存的订阅集合
+    restore_universe(connection_id);
+    
+    // 降级期间订阅已转移到其他连接，但本连接仍在订阅，释放不再归属本连接的合约
+    auto connection = connection_manager_ ? connection_manager_->get_connection(connection_id) : nullptr;
+    if (connection) {
+        std::vector<std::string> orphaned;
+        for (const auto& instrument_id : connection->get_subscribed_instruments()) {
+            auto it = global_subscriptions_.find(instrument_id);
+            if (it == global_subscriptions_.end() ||
+                (it->second->assigned_connection_id != connection_id &&
+                 it->second->standby_connection_id != connection_id &&
+                 it->second->migrating_from_connection_id != connection_id)) {
+                orphaned.push_back(instrument_id);
+            }
+        }
+        if (!orphaned.empty()) {
+            connection->unsubscribe_instruments(orphaned);
+            server_->log_info("Released " + std::to_string(orphaned.size()) +
+                             " orphaned subscriptions on " + connection_id);
+        }
+    }
+    
+    // 交给规划定时任务重新均衡：把故障期间迁走的订阅按限速迁回
+    rebalance_requested_ = true;
+    
+    // 处理待重试的订阅
+    process_pending_subscriptions();
+}
+
+void SubscriptionDispatcher::on_subscription_success_on_loop(const std::string& connection_id, const std::string& instrument_id)
+{
+    auto it = global_subscriptions_.find(instrument_id);
+    if (it != global_subscriptions_.end()) {
+        it->second->status = SubscriptionStatus::ACTIVE;
         it->second->last_update_time = std::chrono::system_clock::now();
         
         connection_subscriptions_[connection_id].insert(instrument_id);
         successful_subscriptions_++;
         
-        server_->log_info("Subscription successful: " + instrument_id + " on " + connection_id);
+        // 迁移：新连接已订阅成功，退订原连接（两者重叠期间的重复行情由仲裁丢弃）
+        auto& info = it->second;
+        if (!info->migrating_from_connection_id.empty() && info->assigned_connection_id == connection_id) {
+            execute_unsubscription(instrument_id, info->migrating_from_connection_id);
+            finish_move(*info);
+        }
     }
 }
 
-void SubscriptionDispatcher::on_subscription_failed(const std::string& connection_id, const std::string& instrument_id)
+void SubscriptionDispatcher::on_subscription_failed_on_loop(const std::string& connection_id, const std::string& instrument_id)
 {
-    std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
-    
     auto it = global_subscriptions_.find(instrument_id);
+    if (it != global_subscriptions_.end() && it->second->standby_connection_id == connection_id) {
+        // 热备订阅失败只放弃热备，主订阅不受影响
+        it->second->standby_connection_id.clear();
+        server_->log_warning("Standby subscription failed: " + instrument_id + " on " + connection_id);
+        return;
+    }
+    
+    if (it != global_subscriptions_.end() && !it->second->migrating_from_connection_id.empty() &&
+        it->second->assigned_connection_id == connection_id) {
+        // 迁移目标订阅失败，原连接仍在订阅，撤销迁移
+        it->second->assigned_connection_id = it->second->migrating_from_connection_id;
+        finish_move(*it->second);
+        it->second->status = SubscriptionStatus::ACTIVE;
+        server_->log_warning("Subscription move failed, keeping " + instrument_id + " on " +
+                            it->second->assigned_connection_id);
+        return;
+    }
+    
     if (it != global_subscriptions_.end()) {
         it->second->status = SubscriptionStatus::FAILED;
         it->second->retry_count++;
@@ -425,7 +1267,6 @@ void SubscriptionDispatcher::on_subscription_failed(const std::string& connectio
         
         // 如果重试次数未超限，加入重试队列
         if (it->second->retry_count < max_retry_count_) {
-            std::lock_guard<std::mutex> retry_lock(retry_queue_mutex_);
             retry_queue_.push(instrument_id);
         }
         
@@ -434,10 +1275,8 @@ void SubscriptionDispatcher::on_subscription_failed(const std::string& connectio
     }
 }
 
-void SubscriptionDispatcher::on_unsubscription_success(const std::string& connection_id, const std::string& instrument_id)
+void SubscriptionDispatcher::on_unsubscription_success_on_loop(const std::string& connection_id, const std::string& instrument_id)
 {
-    std::lock_guard<std::mutex> conn_lock(connections_mutex_);
-    
     auto it = connection_subscriptions_.find(connection_id);
     if (it != connection_subscriptions_.end()) {
         it->second.erase(instrument_id);
@@ -445,14 +1284,14 @@ void SubscriptionDispatcher::on_unsubscription_success(const std::string& connec
             connection_subscriptions_.erase(it);
         }
     }
-    
-    server_->log_info("Unsubscription successful: " + instrument_id + " on " + connection_id);
 }
 
 void SubscriptionDispatcher::on_market_data(const std::string& connection_id, 
                                           const std::string& instrument_id, 
                                           const std::string& json_data)
 {
+    rate_tracker_.on_tick(instrument_id);
+    
     // 缓存行情数据，不立即广播
     if (server_) {
         server_->cache_market_data(instrument_id, json_data);
@@ -492,21 +1331,17 @@ void SubscriptionDispatcher::process_pending_subscriptions()
 {
     std::queue<std::string> current_retry_queue;
     
-    {
-        std::lock_guard<std::mutex> retry_lock(retry_queue_mutex_);
-        current_retry_queue = retry_queue_;
-        retry_queue_ = std::queue<std::string>(); // 清空重试队列
-    }
+    current_retry_queue = retry_queue_;
+    retry_queue_ = std::queue<std::string>(); // 清空重试队列
     
     while (!current_retry_queue.empty()) {
         std::string instrument_id = current_retry_queue.front();
         current_retry_queue.pop();
         
-        std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
         auto it = global_subscriptions_.find(instrument_id);
         if (it != global_subscriptions_.end() && it->second->status == SubscriptionStatus::FAILED) {
             // 选择新连接重试
-            std::shared_ptr<CTPConnection> new_connection = select_connection_by_quality();
+            std::shared_ptr<CTPConnection> new_connection = select_failover_connection(instrument_id, "");
             if (new_connection) {
                 it->second->assigned_connection_id = new_connection->get_connection_id();
                 it->second->status = SubscriptionStatus::SUBSCRIBING;
@@ -514,7 +1349,6 @@ void SubscriptionDispatcher::process_pending_subscriptions()
                 if (!execute_subscription(instrument_id, new_connection->get_connection_id())) {
                     it->second->status = SubscriptionStatus::FAILED;
                     if (it->second->retry_count < max_retry_count_) {
-                        std::lock_guard<std::mutex> retry_lock(retry_queue_mutex_);
                         retry_queue_.push(instrument_id);
                     }
                 }
@@ -525,98 +1359,365 @@ void SubscriptionDispatcher::process_pending_subscriptions()
 
 SubscriptionDispatcher::Statistics SubscriptionDispatcher::get_statistics() const
 {
-    std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
-    std::lock_guard<std::mutex> sess_lock(sessions_mutex_);
-    std::lock_guard<std::mutex> conn_lock(connections_mutex_);
-    
-    Statistics stats;
-    stats.total_instruments = global_subscriptions_.size();
-    stats.total_sessions = session_subscriptions_.size();
+    return std::atomic_load(&snapshot_)->statistics;
+}
+
+void SubscriptionDispatcher::set_rate_balance(int interval_seconds, int max_moves, double tolerance)
+{
+    rate_balance_interval_ = std::max(0, interval_seconds);
+    rate_balance_max_moves_ = static_cast<size_t>(std::max(1, max_moves));
+    rate_balance_tolerance_ = std::max(0.0, tolerance);
     
-    for (const auto& pair : global_subscriptions_) {
-        switch (pair.second->status) {
-            case SubscriptionStatus::ACTIVE:
-                stats.active_subscriptions++;
-                break;
-            case SubscriptionStatus::PENDING:
-            case SubscriptionStatus::SUBSCRIBING:
-                stats.pending_subscriptions++;
-                break;
-            case SubscriptionStatus::FAILED:
-                stats.failed_subscriptions++;
-                break;
-            default:
-                break;
+    if (rate_balance_interval_ > 0) {
+        server_->log_info("Rate-based rebalancing enabled: every " + std::to_string(interval_seconds) +
+                         "s, up to " + std::to_string(rate_balance_max_moves_) + " moves");
+    }
+}
+
+void SubscriptionDispatcher::set_rebalance(int interval_seconds, int moves_per_second)
+{
+    rebalance_interval_ = std::max(0, interval_seconds);
+    move_limiter_.set_rate(std::max(1, moves_per_second), std::max(1, moves_per_second));
+}
+
+void SubscriptionDispatcher::planner_tick()
+{
+    // 事件循环每100ms调用一次
+    const int kTicksPerSecond = 10;
+    if (++planner_ticks_ >= kTicksPerSecond) {
+        planner_ticks_ = 0;
+        
+        // 每秒采样一次行情频率
+        rate_tracker_.sample();
+        
+        // 开启频率均衡时由它按自己的间隔规划，定时均衡不再重复规划；哈希分发不参与频率均衡
+        int rate_interval = rate_balance_interval_;
+        bool rate_planning = rate_interval > 0 && load_balance_strategy_ != LoadBalanceStrategy::HASH_BASED;
+        if (rate_planning && ++seconds_since_rate_plan_ >= rate_interval) {
+            seconds_since_rate_plan_ = 0;
+            rebalance("rate");
+        }
+        
+        int rebalance_interval = rebalance_interval_;
+        if (!rate_planning && rebalance_interval > 0 && ++seconds_since_rebalance_ >= rebalance_interval) {
+            seconds_since_rebalance_ = 0;
+            rebalance("timer");
         }
     }
     
-    // 连接分布统计
-    for (const auto& pair : connection_subscriptions_) {
-        stats.connection_distribution[pair.first] = pair.second.size();
+    if (rebalance_requested_.exchange(false)) {
+        rebalance("recovery");
     }
     
-    return stats;
+    // 按限速执行迁移
+    process_move_queue();
 }
 
-void SubscriptionDispatcher::start_maintenance_timer()
+void SubscriptionDispatcher::rebalance(const std::string& reason)
 {
-    if (maintenance_running_) {
+    if (!connection_manager_) {
         return;
     }
     
-    maintenance_running_ = true;
-    maintenance_thread_ = std::make_unique<std::thread>(&SubscriptionDispatcher::maintenance_task, this);
+    std::vector<PlannedMove> moves;
+    if (load_balance_strategy_ == LoadBalanceStrategy::HASH_BASED) {
+        moves = plan_hash_moves();
+    } else if (rate_balance_interval_ > 0) {
+        moves = plan_rate_moves();
+    } else if (load_balance_strategy_ != LoadBalanceStrategy::LATENCY) {
+        // 延迟优先策略有意集中到低延迟前置，不按数量摊平
+        moves = plan_count_moves();
+    }
     
-    server_->log_info("Started subscription maintenance timer");
+    // 新的规划基于最新状态，替换尚未执行的旧规划
+    size_t dropped = 0;
+    dropped = move_queue_.size();
+    move_queue_.assign(moves.begin(), moves.end());
+    
+    if (!moves.empty()) {
+        server_->log_info("Rebalance (" + reason + ") planned " + std::to_string(moves.size()) + " moves" +
+                         (dropped ? ", replaced " + std::to_string(dropped) + " pending" : std::string()));
+    }
 }
 
-void SubscriptionDispatcher::stop_maintenance_timer()
+std::vector<PlannedMove> SubscriptionDispatcher::plan_hash_moves()
 {
-    maintenance_running_ = false;
-    
-    if (maintenance_thread_ && maintenance_thread_->joinable()) {
-        maintenance_thread_->join();
+    // 哈希环上的归属连接与当前连接不一致的订阅（故障期间顺延出去的）迁回归属连接
+    std::vector<PlannedMove> moves;
+    std::vector<std::shared_ptr<CTPConnection>> candidates;
+    for (const auto& conn : connection_manager_->get_available_connections()) {
+        if (conn->can_accept_more_subscriptions()) {
+            candidates.push_back(conn);
+        }
     }
     
-    maintenance_thread_.reset();
-    server_->log_info("Stopped subscription maintenance timer");
+    for (const auto& pair : global_subscriptions_) {
+        const auto& info = pair.second;
+        if (info->status != SubscriptionStatus::ACTIVE || !info->migrating_from_connection_id.empty() || info->lingering) {
+            continue;
+        }
+        auto owner = select_connection_from_ring(pair.first, candidates);
+        if (!owner || owner->get_connection_id() == info->assigned_connection_id ||
+            owner->get_connection_id() == info->standby_connection_id) {
+            continue;
+        }
+        PlannedMove move;
+        move.instrument_id = pair.first;
+        move.from_connection_id = info->assigned_connection_id;
+        move.to_connection_id = owner->get_connection_id();
+        moves.push_back(move);
+    }
+    return moves;
 }
 
-void SubscriptionDispatcher::maintenance_task()
+std::vector<PlannedMove> SubscriptionDispatcher::plan_count_moves()
 {
-    while (maintenance_running_) {
-        try {
-            // 处理待重试的订阅
-            process_pending_subscriptions();
-            
-            // 清理过期订阅
-            cleanup_expired_subscriptions();
+    // 目标分布：主订阅数按各连接max_subscriptions的比例分配
+    std::vector<std::shared_ptr<CTPConnection>> available = connection_manager_->get_available_connections();
+    if (available.size() < 2) {
+        return {};
+    }
+    
+    std::map<std::string, long> counts;
+    std::map<std::string, long> targets;
+    size_t total_capacity = 0;
+    for (const auto& conn : available) {
+        counts[conn->get_connection_id()] = 0;
+        total_capacity += conn->get_max_subscriptions();
+    }
+    
+    std::map<std::string, std::vector<std::pair<double, std::string>>> movable;  // connection_id -> (rate, instrument)
+    long total = 0;
+    for (const auto& pair : global_subscriptions_) {
+        const auto& info = pair.second;
+        auto it = counts.find(info->assigned_connection_id);
+        if (it == counts.end()) {
+            continue;
+        }
+        it->second++;
+        total++;
+        // 保留订阅没有session，可能随时到期退订，迁移只会浪费CTP请求
+        if (info->status == SubscriptionStatus::ACTIVE && info->migrating_from_connection_id.empty() &&
+            !info->lingering) {
+            movable[it->first].push_back(std::make_pair(rate_tracker_.get_rate(pair.first), pair.first));
+        }
+    }
+    if (total == 0 || total_capacity == 0) {
+        return {};
+    }
+    
+    for (const auto& conn : available) {
+        long target = static_cast<long>(static_cast<double>(total) * conn->get_max_subscriptions() / total_capacity + 0.5);
+        targets[conn->get_connection_id()] = std::min(target, static_cast<long>(conn->get_max_subscriptions()));
+    }
+    
+    std::vector<PlannedMove> moves;
+    for (auto& pair : movable) {
+        const std::string& from = pair.first;
+        long target = targets[from];
+        // 偏差不超过目标的10%（至少2个）时不迁移，避免来回抖动
+        long slack = std::max(2L, target / 10);
+        if (counts[from] <= target + slack) {
+            continue;
+        }
+        
+        // 低频合约优先迁移，对行情的影响最小
+        std::sort(pair.second.begin(), pair.second.end());
+        for (const auto& candidate : pair.second) {
+            if (counts[from] <= target) {
+                break;
+            }
+            std::string standby = global_subscriptions_[candidate.second]->standby_connection_id;
             
-            // 统计信息日志
-            if (maintenance_running_) {
-                auto stats = get_statistics();
-                server_->log_info("Subscription stats - Total: " + std::to_string(stats.total_instruments) +
-                                 ", Active: " + std::to_string(stats.active_subscriptions) +
-                                 ", Pending: " + std::to_string(stats.pending_subscriptions) +
-                                 ", Failed: " + std::to_string(stats.failed_subscriptions) +
-                                 ", Sessions: " + std::to_string(stats.total_sessions));
+            // 缺口最大的连接
+            std::string to;
+            long best_deficit = 0;
+            for (const auto& target_pair : targets) {
+                long deficit = target_pair.second - counts[target_pair.first];
+                if (target_pair.first != from && target_pair.first != standby && deficit > best_deficit) {
+                    best_deficit = deficit;
+                    to = target_pair.first;
+                }
+            }
+            if (to.empty()) {
+                break;
             }
             
-        } catch (const std::exception& e) {
-            server_->log_error("Maintenance task error: " + std::string(e.what()));
+            PlannedMove move;
+            move.instrument_id = candidate.second;
+            move.from_connection_id = from;
+            move.to_connection_id = to;
+            move.rate = candidate.first;
+            moves.push_back(move);
+            counts[from]--;
+            counts[to]++;
         }
+    }
+    return moves;
+}
+
+std::vector<PlannedMove> SubscriptionDispatcher::plan_rate_moves()
+{
+    std::vector<PlannerConnection> connections;
+    std::map<std::string, size_t> index;
+    for (const auto& conn : connection_manager_->get_available_connections()) {
+        PlannerConnection planner_conn;
+        planner_conn.connection_id = conn->get_connection_id();
+        planner_conn.capacity = conn->get_max_subscriptions();
+        planner_conn.count = conn->get_subscription_count();
+        index[planner_conn.connection_id] = connections.size();
+        connections.push_back(planner_conn);
+    }
+    if (connections.size() < 2) {
+        return {};
+    }
+    
+    // 连接负载 = 其上主订阅和热备订阅的频率之和；只迁移稳定的主订阅
+    std::map<std::string, double> rates = rate_tracker_.get_rates();
+    std::vector<PlannerInstrument> instruments;
+    for (const auto& pair : global_subscriptions_) {
+        const auto& info = pair.second;
+        auto rate_it = rates.find(pair.first);
+        double rate = (rate_it != rates.end()) ? rate_it->second : 0.0;
         
-        // 等待下次维护
-        for (int i = 0; i < maintenance_interval_.count() && maintenance_running_; ++i) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+        auto standby_it = index.find(info->standby_connection_id);
+        if (standby_it != index.end()) {
+            connections[standby_it->second].load += rate;
+        }
+        auto assigned_it = index.find(info->assigned_connection_id);
+        if (assigned_it == index.end()) {
+            continue;
+        }
+        connections[assigned_it->second].load += rate;
+        
+        if (info->status == SubscriptionStatus::ACTIVE && info->migrating_from_connection_id.empty() &&
+            !info->lingering) {
+            PlannerInstrument inst;
+            inst.instrument_id = pair.first;
+            inst.connection_id = info->assigned_connection_id;
+            inst.rate = rate;
+            if (!info->standby_connection_id.empty()) {
+                inst.excluded.insert(info->standby_connection_id);
+            }
+            instruments.push_back(inst);
         }
     }
+    
+    return SubscriptionPlanner::plan(instruments, connections, rate_balance_max_moves_, rate_balance_tolerance_);
 }
 
-void SubscriptionDispatcher::cleanup_expired_subscriptions()
+void SubscriptionDispatcher::process_move_queue()
+{
+    size_t applied = 0;
+    while (true) {
+        PlannedMove move;
+        if (move_queue_.empty() || move_limiter_.time_until_available().count() > 0) {
+            break;
+        }
+        move = move_queue_.front();
+        move_queue_.pop_front();
+        
+        // 规划到执行之间状态可能已变化，只执行仍然成立的迁移
+        auto it = global_subscriptions_.find(move.instrument_id);
+        if (it == global_subscriptions_.end() ||
+            it->second->assigned_connection_id != move.from_connection_id ||
+            it->second->status != SubscriptionStatus::ACTIVE ||
+            !it->second->migrating_from_connection_id.empty()) {
+            continue;
+        }
+        auto target = connection_manager_->get_connection(move.to_connection_id);
+        if (!target || target->get_status() != CTPConnectionStatus::LOGGED_IN ||
+            !target->can_accept_more_subscriptions()) {
+            continue;
+        }
+        // 只有实际执行的迁移消耗令牌
+        if (move_limiter_.try_acquire() && move_subscription(it->second, move.to_connection_id)) {
+            applied++;
+            moves_applied_++;
+        }
+    }
+    
+    if (applied > 0) {
+        if (move_queue_.empty()) {
+            server_->log_info("Rebalance moves completed, total applied: " + std::to_string(moves_applied_));
+        }
+    }
+}
+
+bool SubscriptionDispatcher::move_subscription(const std::shared_ptr<SubscriptionInfo>& info,
+                                               const std::string& to_connection_id)
+{
+    // 先订阅新连接，订阅成功回调中再退订原连接，迁移期间不丢行情
+    std::string from_connection_id = info->assigned_connection_id;
+    if (from_connection_id == to_connection_id || !execute_subscription(info->instrument_id, to_connection_id)) {
+        return false;
+    }
+    info->migrating_from_connection_id = from_connection_id;
+    info->assigned_connection_id = to_connection_id;
+    tick_arbiter_.begin_overlap();
+    return true;
+}
+
+void SubscriptionDispatcher::finish_move(SubscriptionInfo& info)
+{
+    if (!info.migrating_from_connection_id.empty()) {
+        info.migrating_from_connection_id.clear();
+        tick_arbiter_.end_overlap();
+    }
+}
+
+void SubscriptionDispatcher::maintenance_task()
 {
-    std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
+    // 由事件循环按maintenance_interval_周期调用
+    // 处理待重试的订阅
+    process_pending_subscriptions();
     
+    // 清理过期订阅
+    cleanup_expired_subscriptions();
+    
+    // 退订超过保留时间的保留订阅
+    expire_lingering_subscriptions();
+    
+    // 刷新前置之间的相对滞后（延迟优先策略使用）
+    refresh_relative_lag();
+    
+    // 统计信息日志（维护在事件循环线程执行，先发布快照再读取）
+    publish_snapshot();
+    auto stats = get_statistics();
+    server_->log_info("Subscription stats - Total: " + std::to_string(stats.total_instruments) +
+                     ", Active: " + std::to_string(stats.active_subscriptions) +
+                     ", Pending: " + std::to_string(stats.pending_subscriptions) +
+                     ", Failed: " + std::to_string(stats.failed_subscriptions) +
+                     ", Lingering: " + std::to_string(stats.lingering_subscriptions) +
+                     ", Sessions: " + std::to_string(stats.total_sessions));
+    
+    auto loop_stats = get_loop_statistics();
+    std::ostringstream loop_oss;
+    loop_oss << std::fixed << std::setprecision(1)
+             << "Dispatcher loop stats - commands: " << loop_stats.commands_processed
+             << ", queue depth: " << loop_stats.queue_depth
+             << ", avg wait " << loop_stats.avg_wait_us << " us"
+             << ", max wait " << loop_stats.max_wait_us << " us"
+             << ", " << loop_stats.commands_per_second << " commands/s";
+    server_->log_info(loop_oss.str());
+    
+    // 冗余模式下输出各前置的仲裁统计，显示哪个前置更快
+    if (redundancy_mode_ != RedundancyMode::NONE) {
+        for (const auto& pair : get_arbitration_stats()) {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(2)
+                << "Arbitration stats - " << pair.first
+                << ": first " << pair.second.first_arrivals
+                << ", duplicate " << pair.second.duplicates
+                << ", stale " << pair.second.stale
+                << ", avg lag " << pair.second.avg_lag_ms << " ms";
+            server_->log_info(oss.str());
+        }
+    }
+}
+
+void SubscriptionDispatcher::cleanup_expired_subscriptions()
+{
     auto now = std::chrono::system_clock::now();
     std::vector<std::string> to_remove;
     
@@ -631,7 +1732,353 @@ void SubscriptionDispatcher::cleanup_expired_subscriptions()
     }
     
     for (const auto& instrument_id : to_remove) {
-        global_subscriptions_.erase(instrument_id);
+        auto it = global_subscriptions_.find(instrument_id);
+        if (it->second->lingering) {
+            lingering_lru_.erase(it->second->lingering_pos);
+        }
+        global_subscriptions_.erase(it);
         server_->log_info("Cleaned up expired subscription: " + instrument_id);
     }
+}
+
+void SubscriptionDispatcher::set_linger(int linger_seconds, int max_per_connection)
+{
+    linger_seconds_ = std::max(0, linger_seconds);
+    linger_max_per_connection_ = static_cast<size_t>(std::max(0, max_per_connection));
+    
+    if (linger_seconds_ > 0 && linger_max_per_connection_ > 0) {
+        server_->log_info("Subscription linger enabled: " + std::to_string(linger_seconds) + "s, up to " +
+                         std::to_string(max_per_connection) + " per connection");
+    }
+}
+
+void SubscriptionDispatcher::retire_subscription(const std::string& instrument_id,
+                                                 std::map<std::string, std::vector<std::string>>& releases)
+{
+    auto it = global_subscriptions_.find(instrument_id);
+    if (it == global_subscriptions_.end()) {
+        return;
+    }
+    
+    // 只保留已在上游生效的订阅，失败或进行中的直接释放
+    auto& info = it->second;
+    if (linger_seconds_ <= 0 || linger_max_per_connection_ == 0 ||
+        info->status != SubscriptionStatus::ACTIVE || info->assigned_connection_id.empty()) {
+        release_subscription(instrument_id, releases);
+        return;
+    }
+    
+    info->lingering = true;
+    info->lingering_until = std::chrono::steady_clock::now() + std::chrono::seconds(linger_seconds_.load());
+    info->lingering_pos = lingering_lru_.insert(lingering_lru_.end(), instrument_id);
+    
+    // 超出前置的保留上限或前置接近满载时淘汰最久未使用的保留订阅
+    evict_lingering(info->assigned_connection_id, releases);
+}
+
+void SubscriptionDispatcher::release_subscription(const std::string& instrument_id,
+                                                  std::map<std::string, std::vector<std::string>>& releases)
+{
+    auto it = global_subscriptions_.find(instrument_id);
+    if (it == global_subscriptions_.end()) {
+        return;
+    }
+    
+    const auto& info = it->second;
+    if (!info->assigned_connection_id.empty()) {
+        releases[info->assigned_connection_id].push_back(instrument_id);
+    }
+    if (!info->standby_connection_id.empty()) {
+        releases[info->standby_connection_id].push_back(instrument_id);
+    }
+    if (!info->migrating_from_connection_id.empty()) {
+        releases[info->migrating_from_connection_id].push_back(instrument_id);
+        finish_move(*info);
+    }
+    if (info->lingering) {
+        lingering_lru_.erase(info->lingering_pos);
+    }
+    
+    global_subscriptions_.erase(it);
+    tick_arbiter_.remove_instrument(instrument_id);
+    rate_tracker_.remove_instrument(instrument_id);
+}
+
+void SubscriptionDispatcher::track_instrument_rate(const std::string& instrument_id)
+{
+    // 订阅创建时登记一次计数槽，行情线程此后无锁计数
+    if (rate_tracker_.add_instrument(instrument_id) < 0) {
+        server_->log_warning("Rate tracker full, tick rate of " + instrument_id + " not tracked");
+    }
+}
+
+void SubscriptionDispatcher::revive_subscription(SubscriptionInfo& info)
+{
+    lingering_lru_.erase(info.lingering_pos);
+    info.lingering = false;
+    info.warm_start = false;
+    lingering_revived_++;
+}
+
+size_t SubscriptionDispatcher::evict_lingering(const std::string& connection_id,
+                                               std::map<std::string, std::vector<std::string>>& releases)
+{
+    auto connection = connection_manager_ ? connection_manager_->get_connection(connection_id) : nullptr;
+    
+    // 前置订阅数保持在容量的90%以内，为新订阅留出余量
+    size_t subscribed = connection ? connection->get_subscription_count() : 0;
+    size_t capacity_limit = connection ? connection->get_max_subscriptions() * 9 / 10 : 0;
+    
+    // 启动恢复的订阅不计入保留上限，只在前置接近满载时淘汰
+    std::vector<std::string> lingering_here;
+    size_t counted = 0;
+    for (const auto& instrument_id : lingering_lru_) {
+        auto it = global_subscriptions_.find(instrument_id);
+        if (it != global_subscriptions_.end() && it->second->assigned_connection_id == connection_id) {
+            lingering_here.push_back(instrument_id);
+            if (!it->second->warm_start) {
+                counted++;
+            }
+        }
+    }
+    
+    size_t evicted = 0;
+    for (const auto& instrument_id : lingering_here) {
+        size_t remaining_subscribed = subscribed > evicted ? subscribed - evicted : 0;
+        bool over_capacity = remaining_subscribed >= capacity_limit;
+        if (!over_capacity && counted <= linger_max_per_connection_) {
+            break;
+        }
+        bool warm = global_subscriptions_[instrument_id]->warm_start;
+        if (!over_capacity && warm) {
+            continue;
+        }
+        release_subscription(instrument_id, releases);
+        if (!warm) {
+            counted--;
+        }
+        evicted++;
+    }
+    
+    lingering_evicted_ += evicted;
+    return evicted;
+}
+
+void SubscriptionDispatcher::expire_lingering_subscriptions()
+{
+    std::map<std::string, std::vector<std::string>> releases;
+    size_t expired = 0;
+    // 启动恢复的订阅与普通保留订阅的到期时间不同，需要检查整个队列
+    auto now = std::chrono::steady_clock::now();
+    std::vector<std::string> to_release;
+    for (const auto& instrument_id : lingering_lru_) {
+        auto it = global_subscriptions_.find(instrument_id);
+        if (it != global_subscriptions_.end() && it->second->lingering_until <= now) {
+            to_release.push_back(instrument_id);
+        }
+    }
+    for (const auto& instrument_id : to_release) {
+        release_subscription(instrument_id, releases);
+        expired++;
+    }
+    
+    if (expired > 0) {
+        apply_releases(releases);
+        server_->log_info("Released " + std::to_string(expired) + " lingering subscriptions after expiry (revived " +
+                         std::to_string(lingering_revived_) + ", evicted " + std::to_string(lingering_evicted_) + " so far)");
+    }
+}
+
+void SubscriptionDispatcher::apply_releases(const std::map<std::string, std::vector<std::string>>& releases)
+{
+    for (const auto& pair : releases) {
+        auto connection = connection_manager_ ? connection_manager_->get_connection(pair.first) : nullptr;
+        if (connection) {
+            connection->unsubscribe_instruments(pair.second);
+        }
+    }
+}
+
+void SubscriptionDispatcher::set_universe(const std::string& file, int save_interval_seconds, int grace_seconds)
+{
+    post([this, file, save_interval_seconds, grace_seconds]() {
+        universe_file_ = file;
+        universe_save_interval_ = std::max(1, save_interval_seconds);
+        universe_grace_seconds_ = std::max(0, grace_seconds);
+        next_universe_save_ = std::chrono::steady_clock::now() + std::chrono::seconds(universe_save_interval_);
+    });
+}
+
+void SubscriptionDispatcher::load_universe()
+{
+    // 与登录后的恢复在同一队列中按序执行，先于任何前置的恢复处理
+    post([this]() { load_universe_on_loop(); });
+}
+
+void SubscriptionDispatcher::load_universe_on_loop()
+{
+    if (universe_file_.empty()) {
+        return;
+    }
+    
+    std::ifstream file(universe_file_);
+    if (!file.is_open()) {
+        server_->log_info("No subscription universe file found: " + universe_file_);
+        return;
+    }
+    
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    rapidjson::Document doc;
+    doc.Parse(content.c_str());
+    if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("instruments") || !doc["instruments"].IsArray()) {
+        server_->log_warning("Invalid subscription universe file: " + universe_file_);
+        return;
+    }
+    
+    // 原连接已不在配置中的合约放入空id分组，由最先登录的前置接管
+    std::set<std::string> configured;
+    if (connection_manager_) {
+        for (const auto& conn : connection_manager_->get_all_connections()) {
+            configured.insert(conn->get_connection_id());
+        }
+    }
+    
+    size_t loaded = 0;
+    warm_universe_.clear();
+    for (const auto& item : doc["instruments"].GetArray()) {
+        if (!item.IsObject() || !item.HasMember("instrument_id") || !item["instrument_id"].IsString()) {
+            continue;
+        }
+        std::string connection_id;
+        if (item.HasMember("connection_id") && item["connection_id"].IsString() &&
+            configured.count(item["connection_id"].GetString())) {
+            connection_id = item["connection_id"].GetString();
+        }
+        warm_universe_[connection_id].push_back(item["instrument_id"].GetString());
+        loaded++;
+    }
+    
+    server_->log_info("Loaded " + std::to_string(loaded) + " instruments from subscription universe " +
+                     universe_file_ + " for warm restart");
+}
+
+bool SubscriptionDispatcher::save_universe()
+{
+    rapidjson::Document doc;
+    doc.SetObject();
+    auto& allocator = doc.GetAllocator();
+    rapidjson::Value items(rapidjson::kArrayType);
+    
+    for (const auto& pair : global_subscriptions_) {
+        if (pair.second->status != SubscriptionStatus::ACTIVE || pair.second->assigned_connection_id.empty()) {
+            continue;
+        }
+        rapidjson::Value item(rapidjson::kObjectType);
+        item.AddMember("instrument_id", rapidjson::Value(pair.first.c_str(), allocator), allocator);
+        item.AddMember("connection_id", rapidjson::Value(pair.second->assigned_connection_id.c_str(), allocator), allocator);
+        items.PushBack(item, allocator);
+    }
+    
+    // 尚未登录的前置的待恢复合约一并保留，避免启动阶段覆盖掉
+    for (const auto& pair : warm_universe_) {
+        for (const auto& instrument_id : pair.second) {
+            if (global_subscriptions_.count(instrument_id)) {
+                continue;
+            }
+            rapidjson::Value item(rapidjson::kObjectType);
+            item.AddMember("instrument_id", rapidjson::Value(instrument_id.c_str(), allocator), allocator);
+            item.AddMember("connection_id", rapidjson::Value(pair.first.c_str(), allocator), allocator);
+            items.PushBack(item, allocator);
+        }
+    }
+    
+    // 关闭时订阅已清空，不覆盖上次保存的集合
+    if (items.Empty()) {
+        return false;
+    }
+    
+    doc.AddMember("saved_at", static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()), allocator);
+    doc.AddMember("instruments", items, allocator);
+    
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    doc.Accept(writer);
+    
+    // 先写临时文件再改名，避免进程中断留下不完整的文件
+    std::string tmp_file = universe_file_ + ".tmp";
+    {
+        std::ofstream file(tmp_file, std::ios::trunc);
+        if (!file.is_open()) {
+            server_->log_error("Failed to write subscription universe: " + tmp_file);
+            return false;
+        }
+        file << buffer.GetString();
+        if (!file.good()) {
+            server_->log_error("Failed to write subscription universe: " + tmp_file);
+            return false;
+        }
+    }
+    
+    std::error_code ec;
+    std::filesystem::rename(tmp_file, universe_file_, ec);
+    if (ec) {
+        server_->log_error("Failed to replace subscription universe " + universe_file_ + ": " + ec.message());
+        return false;
+    }
+    return true;
+}
+
+void SubscriptionDispatcher::restore_universe(const std::string& connection_id)
+{
+    auto connection = connection_manager_ ? connection_manager_->get_connection(connection_id) : nullptr;
+    if (!connection) {
+        return;
+    }
+    
+    std::vector<std::string> instruments;
+    for (const std::string& key : {connection_id, std::string()}) {
+        auto it = warm_universe_.find(key);
+        if (it != warm_universe_.end()) {
+            instruments.insert(instruments.end(), it->second.begin(), it->second.end());
+            warm_universe_.erase(it);
+        }
+    }
+    if (instruments.empty()) {
+        return;
+    }
+    
+    // 恢复的订阅没有session，作为保留订阅登记，宽限期内没有客户端订阅则释放
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds(universe_grace_seconds_);
+    std::vector<std::string> batch;
+    for (const auto& instrument_id : instruments) {
+        if (global_subscriptions_.count(instrument_id)) {
+            continue;
+        }
+        auto info = std::make_shared<SubscriptionInfo>(instrument_id);
+        info->assigned_connection_id = connection_id;
+        info->status = SubscriptionStatus::SUBSCRIBING;
+        info->lingering = true;
+        info->warm_start = true;
+        info->lingering_until = until;
+        info->lingering_pos = lingering_lru_.insert(lingering_lru_.end(), instrument_id);
+        global_subscriptions_[instrument_id] = info;
+        track_instrument_rate(instrument_id);
+        batch.push_back(instrument_id);
+    }
+    
+    // 一次数组订阅，超出前置容量的部分放弃
+    std::vector<std::string> rejected;
+    size_t issued = connection->subscribe_instruments(batch, rejected);
+    std::map<std::string, std::vector<std::string>> releases;
+    for (const auto& instrument_id : rejected) {
+        auto it = global_subscriptions_.find(instrument_id);
+        if (it != global_subscriptions_.end()) {
+            it->second->assigned_connection_id.clear();
+            release_subscription(instrument_id, releases);
+        }
+    }
+    
+    server_->log_info("Warm restart: restored " + std::to_string(issued) + " subscriptions on " + connection_id +
+                     (rejected.empty() ? "" : " (" + std::to_string(rejected.size()) + " rejected)"));
 }
\ No newline at end of file
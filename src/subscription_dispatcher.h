@@ -7,6 +7,11 @@
 #pragma once
 
 #include "multi_ctp_config.h"
+#include "tick_arbiter.h"
+#include "consistent_hash_ring.h"
+#include "instrument_rate_tracker.h"
+#include "subscription_planner.h"
+#include "token_bucket.h"
 #include <memory>
 #include <map>
 #include <set>
@@ -16,8 +21,11 @@
 #include <vector>
 #include <atomic>
 #include <queue>
+#include <deque>
 #include <thread>
 #include <chrono>
+#include <list>
+#include <condition_variable>
 
 class MarketDataServer;
 class CTPConnection;
@@ -36,22 +44,35 @@ enum class SubscriptionStatus {
 struct SubscriptionInfo {
     std::string instrument_id;
     std::string assigned_connection_id;
+    std::string standby_connection_id;         // 热备前置（冗余模式下）
+    std::string migrating_from_connection_id;  // 迁移中的原连接，新连接订阅成功后退订
     SubscriptionStatus status;
     std::set<std::string> requesting_sessions;  // 请求该订阅的session列表
     std::chrono::system_clock::time_point created_time;
     std::chrono::system_clock::time_point last_update_time;
     int retry_count;
     
+    // 保留订阅：最后一个session退订后仍在上游订阅，到期前重新订阅无需CTP请求
+    bool lingering;
+    bool warm_start;                                  // 启动时按持久化的订阅集合恢复，尚无session
+    std::chrono::steady_clock::time_point lingering_until;
+    std::list<std::string>::iterator lingering_pos;   // 在保留队列中的位置
+    
     SubscriptionInfo(const std::string& inst_id) 
         : instrument_id(inst_id)
         , status(SubscriptionStatus::PENDING)
         , created_time(std::chrono::system_clock::now())
         , last_update_time(std::chrono::system_clock::now())
-        , retry_count(0) {}
+        , retry_count(0)
+        , lingering(false)
+        , warm_start(false) {}
 };
 
 
 // 全局订阅分发器
+// 所有订阅状态由一个事件循环线程独占：客户端订阅/退订、CTP订阅回报、连接故障/恢复事件都作为命令
+// 投递到多生产者单消费者队列，由事件循环依次执行，定时的均衡规划与维护任务也在该线程运行，
+// 状态本身不加锁，也不会在持锁时调用CTPConnection。查询接口读取事件循环定期发布的只读快照。
 class SubscriptionDispatcher
 {
 public:
@@ -62,12 +83,16 @@ public:
     bool initialize(CTPConnectionManager* connection_manager);
     void shutdown();
     
-    // 订阅管理
+    // 订阅管理（投递到事件循环异步执行，返回值表示已受理）
     bool add_subscription(const std::string& session_id, const std::string& instrument_id);
     bool remove_subscription(const std::string& session_id, const std::string& instrument_id);
     void remove_all_subscriptions_for_session(const std::string& session_id);
     
-    // 订阅状态查询
+    // 批量订阅管理：按选中的连接分组，每个连接每批只下发一次数组订阅，只输出一条汇总日志
+    size_t add_subscriptions(const std::string& session_id, const std::vector<std::string>& instrument_ids);
+    size_t remove_subscriptions(const std::string& session_id, const std::vector<std::string>& instrument_ids);
+    
+    // 订阅状态查询（读取最近发布的快照，最多滞后一个发布周期）
     std::vector<std::string> get_subscriptions_for_session(const std::string& session_id);
     std::vector<std::string> get_sessions_for_instrument(const std::string& instrument_id);
     SubscriptionStatus get_subscription_status(const std::string& instrument_id);
@@ -77,6 +102,34 @@ public:
     void set_load_balance_strategy(LoadBalanceStrategy strategy);
     LoadBalanceStrategy get_load_balance_strategy() const { return load_balance_strategy_; }
     
+    // 双前置热备
+    void set_redundancy(RedundancyMode mode, const std::vector<std::string>& instruments);
+    RedundancyMode get_redundancy_mode() const { return redundancy_mode_; }
+    
+    // 行情仲裁（由CTPConnection在处理行情前调用），返回false表示重复或过期的副本
+    bool accept_tick(const std::string& connection_id, const CThostFtdcDepthMarketDataField& md) {
+        return tick_arbiter_.accept(connection_id, md);
+    }
+    std::map<std::string, TickArbiterStats> get_arbitration_stats() const { return tick_arbiter_.get_stats(); }
+    
+    // 共享合约上相对最快前置的期望滞后（毫秒），由维护任务根据仲裁统计刷新
+    double get_relative_lag_ms(const std::string& connection_id) const;
+    
+    // 按行情频率均衡
+    void set_rate_balance(int interval_seconds, int max_moves, double tolerance);
+    double get_instrument_rate(const std::string& instrument_id) const { return rate_tracker_.get_rate(instrument_id); }
+    
+    // 定时/恢复时重新均衡，迁移按moves_per_second限速
+    void set_rebalance(int interval_seconds, int moves_per_second);
+    
+    // 保留订阅：无session后继续订阅linger_seconds秒，每个前置最多max_per_connection个，0为关闭
+    void set_linger(int linger_seconds, int max_per_connection);
+    
+    // 订阅集合持久化：定期保存已生效的合约及其连接，重启后各前置登录即批量恢复，
+    // 恢复的订阅在grace_seconds内没有客户端订阅则释放
+    void set_universe(const std::string& file, int save_interval_seconds, int grace_seconds);
+    void load_universe();
+    
     // 故障转移
     void handle_connection_failure(const std::string& connection_id);
     void handle_connection_recovery(const std::string& connection_id);
@@ -97,37 +150,109 @@ public:
         size_t active_subscriptions;
         size_t pending_subscriptions;
         size_t failed_subscriptions;
+        size_t lingering_subscriptions;
         std::map<std::string, size_t> connection_distribution;
         size_t total_sessions;
     };
     Statistics get_statistics() const;
     
-    // 监控和维护
-    void start_maintenance_timer();
-    void stop_maintenance_timer();
+    // 事件循环统计
+    struct LoopStatistics {
+        size_t commands_processed;
+        size_t queue_depth;
+        double avg_wait_us;      // 命令从投递到开始执行的平均等待
+        double max_wait_us;
+        double commands_per_second;
+    };
+    LoopStatistics get_loop_statistics() const;
     
 private:
+    // 事件循环：投递命令、循环主体、定时任务
+    void post(std::function<void()> command);
+    void start_event_loop();
+    void stop_event_loop();
+    void event_loop();
+    void planner_tick();
+    void publish_snapshot();
+    
+    // 以下在事件循环线程执行
+    void add_subscription_on_loop(const std::string& session_id, const std::string& instrument_id);
+    void remove_subscription_on_loop(const std::string& session_id, const std::string& instrument_id);
+    void add_subscriptions_on_loop(const std::string& session_id, const std::vector<std::string>& instrument_ids);
+    void remove_subscriptions_on_loop(const std::string& session_id, const std::vector<std::string>& instrument_ids);
+    void handle_connection_failure_on_loop(const std::string& connection_id);
+    void handle_connection_recovery_on_loop(const std::string& connection_id);
+    void on_subscription_success_on_loop(const std::string& connection_id, const std::string& instrument_id);
+    void on_subscription_failed_on_loop(const std::string& connection_id, const std::string& instrument_id);
+    void on_unsubscription_success_on_loop(const std::string& connection_id, const std::string& instrument_id);
+    void load_universe_on_loop();
+    bool save_universe();
+    
+
     // 负载均衡算法实现
     std::shared_ptr<CTPConnection> select_connection_round_robin();
     std::shared_ptr<CTPConnection> select_connection_least_connections();
     std::shared_ptr<CTPConnection> select_connection_by_quality();
     std::shared_ptr<CTPConnection> select_connection_by_hash(const std::string& instrument_id);
+    std::shared_ptr<CTPConnection> select_connection_from_ring(
+        const std::string& instrument_id,
+        const std::vector<std::shared_ptr<CTPConnection>>& candidates);
+    std::shared_ptr<CTPConnection> select_failover_connection(const std::string& instrument_id,
+                                                              const std::string& failed_connection_id);
+    void refresh_hash_ring();
+    std::shared_ptr<CTPConnection> select_connection_by_latency(
+        const std::vector<std::shared_ptr<CTPConnection>>& candidates);
+    
+    // 批量选择：在同一批次内计入已分配但尚未下发的订阅数
+    std::shared_ptr<CTPConnection> select_connection_for_batch(
+        const std::string& instrument_id,
+        const std::vector<std::shared_ptr<CTPConnection>>& available_connections,
+        const std::map<std::string, size_t>& planned);
     
     // 订阅处理
     bool execute_subscription(const std::string& instrument_id, const std::string& connection_id);
     bool execute_unsubscription(const std::string& instrument_id, const std::string& connection_id);
     void process_pending_subscriptions();
-    void retry_failed_subscriptions();
     
-    // 故障转移处理
-    void migrate_subscriptions(const std::string& failed_connection_id, 
-                             const std::string& target_connection_id);
-    void migrate_subscription(const std::string& instrument_id, 
-                            const std::string& from_connection_id, 
-                            const std::string& to_connection_id);
+    // 向一个连接下发数组订阅，被拒绝的主订阅标记失败并进入重试队列，返回下发数量
+    size_t issue_batch_subscriptions(const std::string& connection_id, const std::vector<std::string>& instrument_ids);
+    
+    // 热备选择：排除指定连接后按连接质量选择
+    bool needs_standby(const std::string& instrument_id) const;
+    std::shared_ptr<CTPConnection> select_standby_connection(const std::set<std::string>& excluded);
     
     // 连接评分
-    int calculate_connection_score(std::shared_ptr<CTPConnection> connection);
+    int calculate_connection_score(std::shared_ptr<CTPConnection> connection, size_t pending_subscriptions = 0);
+    
+    // 延迟评分：实测EWMA延迟 + 共享合约上的相对滞后，样本不足时返回负数
+    double calculate_latency_score(std::shared_ptr<CTPConnection> connection) const;
+    void refresh_relative_lag();
+    
+    // 行情频率采样与均衡规划
+    void rebalance(const std::string& reason);
+    std::vector<PlannedMove> plan_hash_moves();
+    std::vector<PlannedMove> plan_count_moves();
+    std::vector<PlannedMove> plan_rate_moves();
+    void process_move_queue();
+    // 结束迁移（完成、撤销或合约移除），通知仲裁器重叠结束
+    void finish_move(SubscriptionInfo& info);
+    bool move_subscription(const std::shared_ptr<SubscriptionInfo>& info, const std::string& to_connection_id);
+    
+    // 保留订阅：retire在最后一个session退订时调用，
+    // 进入保留队列或直接释放；需要退订的连接和合约加入releases
+    void retire_subscription(const std::string& instrument_id,
+                             std::map<std::string, std::vector<std::string>>& releases);
+    void release_subscription(const std::string& instrument_id,
+                              std::map<std::string, std::vector<std::string>>& releases);
+    void revive_subscription(SubscriptionInfo& info);
+    void track_instrument_rate(const std::string& instrument_id);
+    size_t evict_lingering(const std::string& connection_id,
+                           std::map<std::string, std::vector<std::string>>& releases);
+    void expire_lingering_subscriptions();
+    void apply_releases(const std::map<std::string, std::vector<std::string>>& releases);
+    
+    // 前置登录后批量恢复持久化订阅集合中属于该前置的合约
+    void restore_universe(const std::string& connection_id);
     
     // 维护任务
     void maintenance_task();
@@ -142,22 +267,84 @@ private:
     std::map<std::string, std::set<std::string>> connection_subscriptions_;          // connection_id -> instrument_ids
     
     // 负载均衡
-    LoadBalanceStrategy load_balance_strategy_;
+    std::atomic<LoadBalanceStrategy> load_balance_strategy_;
     std::atomic<size_t> round_robin_counter_;
     
-    // 线程安全
-    mutable std::mutex subscriptions_mutex_;
-    mutable std::mutex sessions_mutex_;
-    mutable std::mutex connections_mutex_;
+    // 哈希分发使用的一致性哈希环，包含所有已配置连接（不论是否可用），
+    // 查找时跳过不可用的连接，连接故障/恢复只影响原本属于它的合约
+    ConsistentHashRing<std::string> hash_ring_;
+    std::map<std::string, int> hash_ring_weights_;   // connection_id -> 虚拟节点权重
+    
+    // 双前置热备与行情仲裁
+    std::atomic<RedundancyMode> redundancy_mode_;
+    std::set<std::string> redundant_instruments_;
+    TickArbiter tick_arbiter_;
+    
+    // 相对滞后缓存：connection_id -> 毫秒
+    std::map<std::string, double> relative_lag_ms_;
+    
+    // 行情频率统计与均衡规划
+    InstrumentRateTracker rate_tracker_;
+    std::atomic<int> rate_balance_interval_;
+    std::atomic<size_t> rate_balance_max_moves_;
+    std::atomic<double> rate_balance_tolerance_;
+    
+    // 重新均衡：规划结果进入迁移队列，由事件循环按令牌桶限速执行
+    std::atomic<int> rebalance_interval_;
+    std::atomic<bool> rebalance_requested_;
+    int planner_ticks_;
+    int seconds_since_rate_plan_;
+    int seconds_since_rebalance_;
+    std::deque<PlannedMove> move_queue_;
+    TokenBucket move_limiter_;
+    size_t moves_applied_;
+    
+    // 保留订阅队列（按进入时间排序，最久未使用的在前）
+    std::list<std::string> lingering_lru_;
+    std::atomic<int> linger_seconds_;
+    std::atomic<size_t> linger_max_per_connection_;
+    size_t lingering_revived_;
+    size_t lingering_evicted_;
+    
+    // 订阅集合持久化；warm_universe_为待恢复的合约（connection_id -> instruments，空id为原连接已不存在）
+    std::string universe_file_;
+    int universe_save_interval_;
+    int universe_grace_seconds_;
+    std::map<std::string, std::vector<std::string>> warm_universe_;
+    std::chrono::steady_clock::time_point next_universe_save_;   // 由事件循环按保存间隔定时，不受维护间隔限制
+    
+    // 事件循环：命令队列是唯一的锁，只在投递和取出时短暂持有
+    struct LoopCommand {
+        std::function<void()> run;
+        std::chrono::steady_clock::time_point posted;
+    };
+    std::deque<LoopCommand> commands_;
+    mutable std::mutex commands_mutex_;
+    std::condition_variable commands_cv_;
+    std::unique_ptr<std::thread> loop_thread_;
+    std::atomic<bool> loop_running_;
+    std::atomic<size_t> commands_processed_;
+    std::atomic<double> wait_total_us_;
+    std::atomic<double> wait_max_us_;
+    std::chrono::steady_clock::time_point loop_started_;
+    
+    // 只读快照：事件循环在状态变化后按发布周期整体替换，查询线程用atomic_load读取
+    struct Snapshot {
+        std::map<std::string, std::vector<std::string>> session_instruments;
+        std::map<std::string, std::vector<std::string>> instrument_sessions;
+        std::map<std::string, SubscriptionStatus> instrument_status;
+        std::map<std::string, double> relative_lag_ms;
+        Statistics statistics = {};
+    };
+    std::shared_ptr<const Snapshot> snapshot_;
+    bool snapshot_dirty_;
+    std::chrono::steady_clock::time_point last_snapshot_;
     
-    // 维护定时器
-    std::unique_ptr<std::thread> maintenance_thread_;
-    std::atomic<bool> maintenance_running_;
+    // 维护任务周期
     std::chrono::seconds maintenance_interval_;
     
     // 重试机制
     std::queue<std::string> retry_queue_;
-    std::mutex retry_queue_mutex_;
     int max_retry_count_;
     
     // 统计数据
@@ -0,0 +1,100 @@
+/////////////////////////////////////////////////////////////////////////
+///@file subscription_planner.cpp
+///@brief	按行情频率均衡订阅的装箱规划器实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "subscription_planner.h"
+#include <map>
+#include <cmath>
+
+std::vector<PlannedMove> SubscriptionPlanner::plan(const std::vector<PlannerInstrument>& instruments,
+                                                   std::vector<PlannerConnection> connections,
+                                                   size_t max_moves,
+                                                   double tolerance)
+{
+    std::vector<PlannedMove> moves;
+    if (connections.size() < 2 || max_moves == 0) {
+        return moves;
+    }
+
+    std::map<std::string, size_t> index;
+    double total_load = 0.0;
+    for (size_t i = 0; i < connections.size(); ++i) {
+        index[connections[i].connection_id] = i;
+        total_load += connections[i].load;
+    }
+    const double threshold = tolerance * total_load / connections.size();
+
+    // 每个连接上可迁移的合约
+    std::vector<std::vector<size_t>> placed(connections.size());
+    for (size_t i = 0; i < instruments.size(); ++i) {
+        auto it = index.find(instruments[i].connection_id);
+        if (it != index.end() && instruments[i].rate > 0.0) {
+            placed[it->second].push_back(i);
+        }
+    }
+    std::vector<bool> moved(instruments.size(), false);
+
+    while (moves.size() < max_moves) {
+        // 负载最高的连接，以及有剩余容量、负载最低的连接
+        size_t high = 0;
+        for (size_t i = 1; i < connections.size(); ++i) {
+            if (connections[i].load > connections[high].load) {
+                high = i;
+            }
+        }
+        size_t low = connections.size();
+        for (size_t i = 0; i < connections.size(); ++i) {
+            if (i == high || connections[i].count >= connections[i].capacity) {
+                continue;
+            }
+            if (low == connections.size() || connections[i].load < connections[low].load) {
+                low = i;
+            }
+        }
+        if (low == connections.size()) {
+            break;
+        }
+
+        double gap = connections[high].load - connections[low].load;
+        if (gap <= threshold || gap <= 0.0) {
+            break;
+        }
+
+        // 迁移频率为r的合约后两者之差变为|gap - 2r|，r越接近gap/2收益越大，r >= gap时没有收益
+        size_t best = instruments.size();
+        double best_distance = 0.0;
+        for (size_t candidate : placed[high]) {
+            const PlannerInstrument& inst = instruments[candidate];
+            if (moved[candidate] || inst.rate >= gap ||
+                inst.excluded.count(connections[low].connection_id)) {
+                continue;
+            }
+            double distance = std::fabs(gap / 2.0 - inst.rate);
+            if (best == instruments.size() || distance < best_distance) {
+                best = candidate;
+                best_distance = distance;
+            }
+        }
+        if (best == instruments.size()) {
+            break;
+        }
+
+        const PlannerInstrument& inst = instruments[best];
+        moved[best] = true;
+        connections[high].load -= inst.rate;
+        connections[high].count--;
+        connections[low].load += inst.rate;
+        connections[low].count++;
+
+        PlannedMove move;
+        move.instrument_id = inst.instrument_id;
+        move.from_connection_id = connections[high].connection_id;
+        move.to_connection_id = connections[low].connection_id;
+        move.rate = inst.rate;
+        moves.push_back(move);
+    }
+
+    return moves;
+}
@@ -0,0 +1,49 @@
+/////////////////////////////////////////////////////////////////////////
+///@file subscription_planner.h
+///@brief	按行情频率均衡订阅的装箱规划器
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <set>
+#include <cstddef>
+
+// 规划输入：一个可迁移的订阅
+struct PlannerInstrument {
+    std::string instrument_id;
+    std::string connection_id;          // 当前所在连接
+    double rate = 0.0;                  // 期望行情频率（条/秒）
+    std::set<std::string> excluded;     // 不能迁往的连接（如该合约的热备连接）
+};
+
+// 规划输入：一个连接的当前负载
+struct PlannerConnection {
+    std::string connection_id;
+    size_t capacity = 0;                // max_subscriptions
+    size_t count = 0;                   // 当前订阅数（含不可迁移的订阅）
+    double load = 0.0;                  // 当前期望行情频率之和（含不可迁移的订阅）
+};
+
+// 规划输出：一次迁移
+struct PlannedMove {
+    std::string instrument_id;
+    std::string from_connection_id;
+    std::string to_connection_id;
+    double rate = 0.0;
+};
+
+// 订阅规划器
+// 以当前分布为起点做增量均衡：每一步从负载最高的连接取一个频率最接近负载差一半的合约，
+// 迁往有剩余容量且负载最低的连接，直到最高与最低负载之差不超过平均负载的tolerance倍、
+// 找不到能缩小差距的合约或达到max_moves。只做有收益的迁移，已均衡时不产生任何迁移。
+class SubscriptionPlanner
+{
+public:
+    static std::vector<PlannedMove> plan(const std::vector<PlannerInstrument>& instruments,
+                                         std::vector<PlannerConnection> connections,
+                                         size_t max_moves,
+                                         double tolerance);
+};
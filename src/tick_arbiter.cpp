@@ -0,0 +1,171 @@
+/////////////////////////////////////////////////////////////////////////
+///@file tick_arbiter.cpp
+///@brief	多前置冗余订阅的行情仲裁实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "tick_arbiter.h"
+#include <cstring>
+#include <functional>
+
+namespace {
+
+int64_t steady_now_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+TickArbiter::TickArbiter()
+    : redundancy_enabled_(false)
+    , overlaps_(0)
+    , grace_until_ms_(0)
+{
+}
+
+void TickArbiter::begin_overlap()
+{
+    overlaps_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TickArbiter::end_overlap()
+{
+    grace_until_ms_.store(steady_now_ms() + kOverlapGraceMs, std::memory_order_relaxed);
+    overlaps_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool TickArbiter::is_active()
+{
+    if (redundancy_enabled_.load(std::memory_order_relaxed) || overlaps_.load(std::memory_order_relaxed) > 0) {
+        return true;
+    }
+    int64_t grace_until = grace_until_ms_.load(std::memory_order_relaxed);
+    if (grace_until == 0) {
+        return false;
+    }
+    if (steady_now_ms() < grace_until) {
+        return true;
+    }
+    grace_until_ms_.compare_exchange_strong(grace_until, 0, std::memory_order_relaxed);
+    return false;
+}
+
+bool TickArbiter::accept(const std::string& connection_id, const CThostFtdcDepthMarketDataField& md)
+{
+    if (!is_active()) {
+        return true;
+    }
+
+    const std::string instrument_id = md.InstrumentID;
+    const TickKey key = make_key(md);
+    const auto now = std::chrono::steady_clock::now();
+
+    Shard& shard = shard_for(instrument_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    ConnectionCounters& counters = shard.counters[connection_id];
+    auto it = shard.states.find(instrument_id);
+    if (it == shard.states.end()) {
+        shard.states.emplace(instrument_id, InstrumentState{key, now});
+        counters.first_arrivals++;
+        return true;
+    }
+
+    int order = compare(key, it->second.last);
+    if (order > 0) {
+        it->second.last = key;
+        it->second.first_arrival = now;
+        counters.first_arrivals++;
+        return true;
+    }
+
+    if (order == 0) {
+        counters.duplicates++;
+        counters.lag_total_ms += std::chrono::duration<double, std::milli>(now - it->second.first_arrival).count();
+    } else {
+        counters.stale++;
+    }
+    return false;
+}
+
+void TickArbiter::remove_instrument(const std::string& instrument_id)
+{
+    Shard& shard = shard_for(instrument_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.states.erase(instrument_id);
+}
+
+std::map<std::string, TickArbiterStats> TickArbiter::get_stats() const
+{
+    std::map<std::string, ConnectionCounters> totals;
+    for (size_t i = 0; i < kShardCount; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        for (const auto& pair : shards_[i].counters) {
+            ConnectionCounters& total = totals[pair.first];
+            total.first_arrivals += pair.second.first_arrivals;
+            total.duplicates += pair.second.duplicates;
+            total.stale += pair.second.stale;
+            total.lag_total_ms += pair.second.lag_total_ms;
+        }
+    }
+
+    std::map<std::string, TickArbiterStats> result;
+    for (const auto& pair : totals) {
+        TickArbiterStats& stats = result[pair.first];
+        stats.first_arrivals = pair.second.first_arrivals;
+        stats.duplicates = pair.second.duplicates;
+        stats.stale = pair.second.stale;
+        stats.avg_lag_ms = pair.second.duplicates ? pair.second.lag_total_ms / pair.second.duplicates : 0.0;
+    }
+    return result;
+}
+
+int TickArbiter::compare(const TickKey& a, const TickKey& b)
+{
+    // 交易日切换时成交量清零，先比较交易日
+    int day_order = std::strncmp(a.trading_day, b.trading_day, sizeof(a.trading_day));
+    if (day_order != 0) {
+        return day_order;
+    }
+
+    // 同一交易日内累计成交量单调不减
+    if (a.volume != b.volume) {
+        return a.volume > b.volume ? 1 : -1;
+    }
+
+    // 成交量相同时比较时间，夜盘跨零点时差值超过半天视为回绕
+    const int kDayMs = 24 * 3600 * 1000;
+    int diff = a.time_ms - b.time_ms;
+    if (diff < -kDayMs / 2) {
+        diff += kDayMs;
+    } else if (diff > kDayMs / 2) {
+        diff -= kDayMs;
+    }
+    return (diff > 0) ? 1 : (diff < 0 ? -1 : 0);
+}
+
+TickArbiter::TickKey TickArbiter::make_key(const CThostFtdcDepthMarketDataField& md)
+{
+    TickKey key;
+    std::memcpy(key.trading_day, md.TradingDay, sizeof(key.trading_day));
+    key.trading_day[sizeof(key.trading_day) - 1] = '\0';
+
+    // UpdateTime格式 HH:MM:SS
+    const char* t = md.UpdateTime;
+    key.time_ms = md.UpdateMillisec;
+    if (strnlen(t, sizeof(md.UpdateTime)) >= 8) {
+        int hours = (t[0] - '0') * 10 + (t[1] - '0');
+        int minutes = (t[3] - '0') * 10 + (t[4] - '0');
+        int seconds = (t[6] - '0') * 10 + (t[7] - '0');
+        key.time_ms += ((hours * 60 + minutes) * 60 + seconds) * 1000;
+    }
+    key.volume = md.Volume;
+    return key;
+}
+
+TickArbiter::Shard& TickArbiter::shard_for(const std::string& instrument_id)
+{
+    return shards_[std::hash<std::string>()(instrument_id) % kShardCount];
+}
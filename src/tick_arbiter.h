@@ -0,0 +1,92 @@
+/////////////////////////////////////////////////////////////////////////
+///@file tick_arbiter.h
+///@brief	多前置冗余订阅的行情仲裁
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../libs/ThostFtdcUserApiStruct.h"
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+// 单个连接的仲裁统计
+struct TickArbiterStats {
+    size_t first_arrivals = 0;   // 率先到达并被转发的tick数
+    size_t duplicates = 0;       // 重复到达被丢弃的tick数
+    size_t stale = 0;            // 比已转发tick更旧被丢弃的tick数
+    double avg_lag_ms = 0.0;     // 重复tick相对首个到达的平均滞后
+};
+
+// 行情仲裁器
+// 同一合约在多个前置上同时订阅时，按(TradingDay, UpdateTime, UpdateMillisec, Volume)
+// 识别同一笔行情：第一个到达的副本转发，之后到达的副本丢弃，比已转发行情更旧的也丢弃。
+// 按合约哈希分片加锁，行情线程之间不争用同一把锁。
+// 只有同一合约可能从多个前置到达时才需要仲裁：开启热备，或迁移的新旧订阅重叠期间（含退订后在途行情的宽限期）。
+// 其余时间accept不加锁直接放行，默认的非冗余部署不承担仲裁开销。
+class TickArbiter
+{
+public:
+    TickArbiter();
+
+    // 返回true表示该tick应转发
+    bool accept(const std::string& connection_id, const CThostFtdcDepthMarketDataField& md);
+
+    // 热备开关（由事件循环在切换冗余模式时设置）
+    void set_redundancy_enabled(bool enabled) { redundancy_enabled_.store(enabled, std::memory_order_relaxed); }
+    // 迁移开始/结束：新旧订阅重叠期间仲裁，结束后保留宽限期丢弃原连接的在途行情
+    void begin_overlap();
+    void end_overlap();
+
+    // 合约取消订阅后清理状态
+    void remove_instrument(const std::string& instrument_id);
+
+    // connection_id -> 统计
+    std::map<std::string, TickArbiterStats> get_stats() const;
+
+private:
+    struct TickKey {
+        char trading_day[9];
+        int time_ms;        // 当日毫秒数
+        int volume;
+    };
+
+    struct InstrumentState {
+        TickKey last;
+        std::chrono::steady_clock::time_point first_arrival;
+    };
+
+    struct ConnectionCounters {
+        size_t first_arrivals = 0;
+        size_t duplicates = 0;
+        size_t stale = 0;
+        double lag_total_ms = 0.0;
+    };
+
+    static const size_t kShardCount = 64;
+    static const int64_t kOverlapGraceMs = 2000;
+
+    bool is_active();
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, InstrumentState> states;
+        std::unordered_map<std::string, ConnectionCounters> counters;
+    };
+
+    // 返回 >0 表示a比b新，0表示同一笔，<0表示a更旧
+    static int compare(const TickKey& a, const TickKey& b);
+    static TickKey make_key(const CThostFtdcDepthMarketDataField& md);
+
+    Shard& shard_for(const std::string& instrument_id);
+
+    mutable Shard shards_[kShardCount];
+
+    std::atomic<bool> redundancy_enabled_;
+    std::atomic<int> overlaps_;
+    std::atomic<int64_t> grace_until_ms_;   // steady_clock毫秒，0表示无宽限期
+};
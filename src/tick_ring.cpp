@@ -0,0 +1,168 @@
+/////////////////////////////////////////////////////////////////////////
+///@file tick_ring.cpp
+///@brief	共享内存tick广播环写入端实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "tick_ring.h"
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <signal.h>
+
+TickRing::TickRing()
+    : header_(nullptr)
+    , slots_(nullptr)
+{
+}
+
+TickRing::~TickRing()
+{
+    close();
+}
+
+bool TickRing::open(const std::string& name, uint32_t capacity, std::string& error)
+{
+    close();
+    namespace bip = boost::interprocess;
+    
+    uint32_t rounded = 1;
+    while (rounded < capacity && rounded < (1u << 31)) {
+        rounded <<= 1;
+    }
+    capacity = rounded;
+    
+    bool reusable = false;
+    try {
+        shm_ = std::make_unique<bip::shared_memory_object>(bip::open_or_create, name.c_str(), bip::read_write);
+        bip::offset_t current_size = 0;
+        shm_->get_size(current_size);
+        if (static_cast<size_t>(current_size) >= sizeof(TickRingHeader)) {
+            // 头部有效的广播环原样沿用（容量以已有对象为准），不截断，已映射的读取端继续可用
+            region_ = std::make_unique<bip::mapped_region>(*shm_, bip::read_write);
+            const TickRingHeader* existing = static_cast<const TickRingHeader*>(region_->get_address());
+            reusable = existing->magic == kTickRingMagic && existing->version == kTickRingVersion &&
+                       existing->record_size == sizeof(TickRecord) && existing->max_readers == kTickRingMaxReaders &&
+                       existing->capacity > 0 && (existing->capacity & (existing->capacity - 1)) == 0 &&
+                       tick_ring_size(existing->capacity) <= region_->get_size();
+        }
+        if (!reusable) {
+            region_.reset();
+            shm_->truncate(tick_ring_size(capacity));
+            region_ = std::make_unique<bip::mapped_region>(*shm_, bip::read_write);
+        }
+    } catch (const bip::interprocess_exception& e) {
+        error = e.what();
+        region_.reset();
+        shm_.reset();
+        return false;
+    }
+    
+    header_ = static_cast<TickRingHeader*>(region_->get_address());
+    slots_ = tick_ring_slots(header_);
+    
+    if (!reusable) {
+        // 新建或布局不符：清零后重新初始化，magic最后写入；created_ms即初始化纪元，读取端据此发现写位置归零
+        memset(static_cast<void*>(header_), 0, tick_ring_size(capacity));
+        new (&header_->write_cursor) std::atomic<uint64_t>(0);
+        for (uint32_t i = 0; i < kTickRingMaxReaders; ++i) {
+            new (&header_->readers[i].pid) std::atomic<int32_t>(0);
+            new (&header_->readers[i].position) std::atomic<uint64_t>(0);
+            new (&header_->readers[i].overruns) std::atomic<uint64_t>(0);
+            new (&header_->readers[i].lost) std::atomic<uint64_t>(0);
+        }
+        for (uint32_t i = 0; i < capacity; ++i) {
+            new (&slots_[i].sequence) std::atomic<uint64_t>(0);
+        }
+        header_->version = kTickRingVersion;
+        header_->capacity = capacity;
+        header_->record_size = sizeof(TickRecord);
+        header_->max_readers = kTickRingMaxReaders;
+        header_->created_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::atomic_thread_fence(std::memory_order_release);
+        header_->magic = kTickRingMagic;
+        return true;
+    }
+    
+    // 沿用原写位置；上次退出时写到一半的槽位清空后标记为写完，读取端会跳过空记录
+    for (uint32_t i = 0; i < header_->capacity; ++i) {
+        uint64_t sequence = slots_[i].sequence.load();
+        if (sequence & 1) {
+            memset(&slots_[i].record, 0, sizeof(TickRecord));
+            slots_[i].sequence.store(sequence + 1, std::memory_order_release);
+        }
+    }
+    return true;
+}
+
+void TickRing::close()
+{
+    region_.reset();
+    shm_.reset();
+    header_ = nullptr;
+    slots_ = nullptr;
+}
+
+void TickRing::publish(const std::string& instrument_id, int64_t receive_time_ms, const NormalizedQuote& quote)
+{
+    if (!header_) {
+        return;
+    }
+    
+    // 单写入者：多个前置线程在此串行，槽位写完后才推进写位置，序号与写位置始终按顺序前进
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    uint64_t sequence = header_->write_cursor.load(std::memory_order_relaxed);
+    TickRingSlot& slot = slots_[sequence & (header_->capacity - 1)];
+    
+    slot.sequence.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    TickRecord& record = slot.record;
+    size_t length = std::min(instrument_id.size(), sizeof(record.instrument_id) - 1);
+    memcpy(record.instrument_id, instrument_id.data(), length);
+    record.instrument_id[length] = '\0';
+    record.receive_time_ms = receive_time_ms;
+    memcpy(&record.quote, &quote, sizeof(quote));
+    
+    slot.sequence.store(2 * sequence + 2, std::memory_order_release);
+    header_->write_cursor.store(sequence + 1, std::memory_order_release);
+}
+
+uint64_t TickRing::get_write_cursor() const
+{
+    return header_ ? header_->write_cursor.load(std::memory_order_relaxed) : 0;
+}
+
+std::vector<TickRingReaderInfo> TickRing::get_readers()
+{
+    std::vector<TickRingReaderInfo> readers;
+    if (!header_) {
+        return readers;
+    }
+    
+    uint64_t cursor = header_->write_cursor.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < kTickRingMaxReaders; ++i) {
+        TickRingReaderSlot& slot = header_->readers[i];
+        int32_t pid = slot.pid.load(std::memory_order_acquire);
+        if (pid == 0) {
+            continue;
+        }
+        // 读取端异常退出没有注销时回收登记项
+        if (kill(pid, 0) != 0 && errno == ESRCH) {
+            slot.pid.compare_exchange_strong(pid, 0);
+            continue;
+        }
+        
+        TickRingReaderInfo info;
+        info.name.assign(slot.name, strnlen(slot.name, sizeof(slot.name)));
+        info.pid = pid;
+        info.position = slot.position.load(std::memory_order_relaxed);
+        info.lag = cursor > info.position ? cursor - info.position : 0;
+        info.overruns = slot.overruns.load(std::memory_order_relaxed);
+        info.lost = slot.lost.load(std::memory_order_relaxed);
+        readers.push_back(info);
+    }
+    return readers;
+}
@@ -0,0 +1,54 @@
+/////////////////////////////////////////////////////////////////////////
+///@file tick_ring.h
+///@brief	共享内存tick广播环写入端
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "tick_ring_layout.h"
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 读取端状态（网关侧统计）
+struct TickRingReaderInfo {
+    std::string name;
+    int pid;
+    uint64_t position;
+    uint64_t lag;             // 写位置 - 读位置
+    uint64_t overruns;
+    uint64_t lost;
+};
+
+// tick广播环：网关是唯一的写入进程，同机多个进程通过tick_ring_reader.h各自按序读取全部tick。
+// 进程内多个前置线程的publish以互斥锁串行，保持布局要求的单写入者；环满后覆盖最旧的tick。
+class TickRing
+{
+public:
+    TickRing();
+    ~TickRing();
+
+    // 创建或打开共享内存对象，capacity向上取整为2的幂；已有对象头部有效时沿用其容量和写位置，已登记的读取端继续有效
+    bool open(const std::string& name, uint32_t capacity, std::string& error);
+    void close();
+    bool is_open() const { return header_ != nullptr; }
+
+    void publish(const std::string& instrument_id, int64_t receive_time_ms, const NormalizedQuote& quote);
+
+    uint64_t get_write_cursor() const;
+    uint32_t get_capacity() const { return header_ ? header_->capacity : 0; }
+
+    // 各读取端的读位置与落后量，进程已退出的登记项顺带回收
+    std::vector<TickRingReaderInfo> get_readers();
+
+private:
+    std::unique_ptr<boost::interprocess::shared_memory_object> shm_;
+    std::unique_ptr<boost::interprocess::mapped_region> region_;
+    TickRingHeader* header_;
+    TickRingSlot* slots_;
+    std::mutex publish_mutex_;
+};
@@ -0,0 +1,69 @@
+/////////////////////////////////////////////////////////////////////////
+///@file tick_ring_layout.h
+///@brief	共享内存tick广播环布局（网关与本地读取端共用）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "normalized_quote.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// 共享内存对象布局：TickRingHeader（含读取端登记表）后紧跟 capacity 个 TickRingSlot。
+// 网关按序号 n 写入槽位 n % capacity，写满后覆盖最旧的tick；每个读取端自己维护读位置，互不影响。
+// 槽位序号：写入中为 2n+1，写完为 2n+2。读取端在位置 n 读到 2n+2 为可读，更大表示已被覆盖（读取端落后一圈以上）。
+// 单写入者约定：任一时刻只有一个线程写入，按序号顺序写完槽位 n 后才把 write_cursor 推进到 n+1，
+// 因此 write_cursor 之前的槽位都已写完，读取端不会在序号空洞上等待。网关进程内多个前置线程由写入端加锁串行。
+// created_ms 兼作初始化纪元：环被重新初始化（write_cursor 归零）时改变，读取端据此重新映射并登记。
+
+const uint64_t kTickRingMagic = 0x31305254444d4151ULL;   // "QAMDTR01"
+const uint32_t kTickRingVersion = 1;
+const char* const kTickRingDefaultName = "qamdticks";
+const uint32_t kTickRingMaxReaders = 32;
+
+// 读取端登记：读取端打开时以CAS占用一项，定期更新读位置，网关据此计算落后量
+struct alignas(64) TickRingReaderSlot {
+    std::atomic<int32_t> pid;               // 0为空闲
+    char name[28];
+    std::atomic<uint64_t> position;         // 下一条要读的序号
+    std::atomic<uint64_t> overruns;         // 被覆盖的次数
+    std::atomic<uint64_t> lost;             // 因覆盖跳过的tick数
+};
+
+struct alignas(64) TickRingHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t capacity;                      // 2的幂
+    uint32_t record_size;
+    uint32_t max_readers;
+    std::atomic<uint64_t> write_cursor;     // 下一条tick的序号
+    int64_t created_ms;                     // 初始化时间，兼作初始化纪元
+    TickRingReaderSlot readers[kTickRingMaxReaders];
+};
+
+// 一条tick
+struct TickRecord {
+    char instrument_id[32];                 // 带交易所前缀的显示格式，如SHFE.rb2501
+    int64_t receive_time_ms;                // 网关收到行情的本地时间
+    NormalizedQuote quote;
+};
+
+struct alignas(64) TickRingSlot {
+    std::atomic<uint64_t> sequence;
+    TickRecord record;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "tick ring requires lock-free 64-bit atomics");
+static_assert(std::atomic<int32_t>::is_always_lock_free, "tick ring requires lock-free 32-bit atomics");
+
+inline size_t tick_ring_size(uint32_t capacity)
+{
+    return sizeof(TickRingHeader) + static_cast<size_t>(capacity) * sizeof(TickRingSlot);
+}
+
+inline TickRingSlot* tick_ring_slots(TickRingHeader* header)
+{
+    return reinterpret_cast<TickRingSlot*>(reinterpret_cast<char*>(header) + sizeof(TickRingHeader));
+}
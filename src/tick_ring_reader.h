@@ -0,0 +1,209 @@
+/////////////////////////////////////////////////////////////////////////
+///@file tick_ring_reader.h
+///@brief	共享内存tick广播环读取端（仅头文件，供同机录制、信号、风控等进程使用）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// 用法：
+//   TickRingReader ring;
+//   if (ring.open("recorder")) {
+//       TickRecord tick;
+//       while (running) {
+//           if (ring.next(tick)) { ... } else { /* 暂无新tick，自行等待或让出CPU */ }
+//       }
+//   }
+// 每个读取端按序读取全部tick；落后超过一圈时跳过被覆盖的部分，get_lost()累计跳过的条数。
+// 读位置和覆盖次数登记在共享内存中，网关的get_metrics按读取端给出落后量。链接时需要 -lrt（旧版glibc）。
+// 网关重新初始化广播环（写位置归零）后，next()发现初始化纪元改变或读位置超过写位置时重新映射、登记并从最新位置继续；
+// 重新打开失败时is_open()变为false，由调用方稍后重新open()。
+
+#include "tick_ring_layout.h"
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class TickRingReader
+{
+public:
+    TickRingReader() : header_(nullptr), slots_(nullptr), mapped_size_(0), reader_(nullptr), position_(0), lost_(0), epoch_(0) {}
+    ~TickRingReader() { close(); }
+
+    TickRingReader(const TickRingReader&) = delete;
+    TickRingReader& operator=(const TickRingReader&) = delete;
+
+    // 映射网关创建的广播环并登记读取端；from_latest为false时从环中最旧的tick开始读
+    bool open(const char* reader_name, bool from_latest = true, const char* name = kTickRingDefaultName)
+    {
+        close();
+        std::string shm_name = std::string("/") + name;
+        int fd = shm_open(shm_name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TickRingHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* addr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return false;
+        }
+
+        header_ = static_cast<TickRingHeader*>(addr);
+        mapped_size_ = st.st_size;
+        if (header_->magic != kTickRingMagic || header_->version != kTickRingVersion ||
+            header_->record_size != sizeof(TickRecord) || header_->capacity == 0 ||
+            tick_ring_size(header_->capacity) > mapped_size_) {
+            close();
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        slots_ = tick_ring_slots(header_);
+        epoch_ = header_->created_ms;
+        reader_name_ = reader_name;
+        ring_name_ = name;
+
+        // 登记读取端
+        int32_t pid = static_cast<int32_t>(getpid());
+        for (uint32_t i = 0; i < kTickRingMaxReaders; ++i) {
+            int32_t expected = 0;
+            if (header_->readers[i].pid.compare_exchange_strong(expected, pid)) {
+                reader_ = &header_->readers[i];
+                break;
+            }
+        }
+        if (!reader_) {
+            close();
+            return false;
+        }
+        memset(reader_->name, 0, sizeof(reader_->name));
+        strncpy(reader_->name, reader_name, sizeof(reader_->name) - 1);
+        reader_->overruns.store(0, std::memory_order_relaxed);
+        reader_->lost.store(0, std::memory_order_relaxed);
+
+        uint64_t cursor = header_->write_cursor.load(std::memory_order_acquire);
+        if (from_latest) {
+            position_ = cursor;
+        } else {
+            position_ = cursor > header_->capacity ? cursor - header_->capacity : 0;
+        }
+        lost_ = 0;
+        reader_->position.store(position_, std::memory_order_relaxed);
+        return true;
+    }
+
+    void close()
+    {
+        if (reader_) {
+            reader_->pid.store(0, std::memory_order_release);
+            reader_ = nullptr;
+        }
+        if (header_) {
+            munmap(header_, mapped_size_);
+            header_ = nullptr;
+            slots_ = nullptr;
+            mapped_size_ = 0;
+        }
+    }
+
+    bool is_open() const { return header_ != nullptr; }
+
+    // 读取下一条tick，暂无新tick时返回false
+    bool next(TickRecord& record)
+    {
+        if (!header_) {
+            return false;
+        }
+        while (true) {
+            const TickRingSlot& slot = slots_[position_ & (header_->capacity - 1)];
+            uint64_t ready = 2 * position_ + 2;
+            uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before < ready) {
+                // 已读到最新；纪元改变或读位置超过写位置说明网关重新初始化了广播环
+                if (header_->created_ms == epoch_ &&
+                    position_ <= header_->write_cursor.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                if (!resync()) {
+                    return false;
+                }
+                continue;
+            }
+            if (before == ready) {
+                memcpy(&record, &slot.record, sizeof(record));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                    position_++;
+                    reader_->position.store(position_, std::memory_order_relaxed);
+                    if (record.instrument_id[0] == '\0') {
+                        continue;   // 网关上次异常退出时未写完的槽位
+                    }
+                    return true;
+                }
+            }
+            skip_overrun();
+        }
+    }
+
+    // 当前读位置与写位置之差
+    uint64_t get_lag() const
+    {
+        return header_ ? header_->write_cursor.load(std::memory_order_relaxed) - position_ : 0;
+    }
+    uint64_t get_lost() const { return lost_; }
+    uint64_t get_position() const { return position_; }
+
+private:
+    // 重新映射并登记，从最新位置继续，累计的lost保留；网关尚未初始化完成时返回false，下次再试
+    bool resync()
+    {
+        if (header_->magic != kTickRingMagic) {
+            return false;
+        }
+        // 重新初始化会清空登记表，登记项已不属于本读取端时不能再注销它
+        if (reader_->pid.load(std::memory_order_acquire) != static_cast<int32_t>(getpid())) {
+            reader_ = nullptr;
+        }
+        std::string reader_name = reader_name_;
+        std::string ring_name = ring_name_;
+        uint64_t lost = lost_;
+        if (!open(reader_name.c_str(), true, ring_name.c_str())) {
+            return false;
+        }
+        lost_ = lost;
+        reader_->lost.store(lost_, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 被覆盖：跳到距写位置半圈的位置，留出余量避免立即再次被覆盖
+    void skip_overrun()
+    {
+        uint64_t cursor = header_->write_cursor.load(std::memory_order_acquire);
+        uint64_t resume = cursor > header_->capacity / 2 ? cursor - header_->capacity / 2 : 0;
+        if (resume <= position_) {
+            resume = position_ + 1;
+        }
+        lost_ += resume - position_;
+        position_ = resume;
+        reader_->overruns.fetch_add(1, std::memory_order_relaxed);
+        reader_->lost.store(lost_, std::memory_order_relaxed);
+        reader_->position.store(position_, std::memory_order_relaxed);
+    }
+
+    TickRingHeader* header_;
+    const TickRingSlot* slots_;
+    size_t mapped_size_;
+    TickRingReaderSlot* reader_;
+    uint64_t position_;
+    uint64_t lost_;
+    int64_t epoch_;             // 打开时的初始化纪元（header的created_ms）
+    std::string reader_name_;
+    std::string ring_name_;
+};
@@ -0,0 +1,75 @@
+/////////////////////////////////////////////////////////////////////////
+///@file tick_watchdog.cpp
+///@brief	行情静默检测实现
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "tick_watchdog.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+TickWatchdog::TickWatchdog(const MultiCTPConfig& config)
+    : enabled_(config.watchdog_enabled)
+    , interval_ms_(std::max(10, config.watchdog_interval_ms))
+    , min_silence_ms_(config.watchdog_min_silence_ms)
+    , max_silence_ms_(std::max(config.watchdog_min_silence_ms, config.watchdog_max_silence_ms))
+    , silence_factor_(config.watchdog_silence_factor)
+    , min_rate_(config.watchdog_min_rate)
+    , restart_after_seconds_(config.watchdog_restart_after)
+{
+    for (const auto& text : config.watchdog_sessions) {
+        Session session;
+        if (parse_session(text, session.start_minute, session.end_minute)) {
+            sessions_.push_back(session);
+        }
+    }
+}
+
+bool TickWatchdog::in_session(int64_t& ms_since_open) const
+{
+    auto now = std::chrono::system_clock::now();
+    std::time_t now_t = std::chrono::system_clock::to_time_t(now);
+    std::tm local_tm;
+    localtime_r(&now_t, &local_tm);
+    const int64_t kDayMs = 24LL * 3600 * 1000;
+    int64_t now_ms = ((local_tm.tm_hour * 60LL + local_tm.tm_min) * 60 + local_tm.tm_sec) * 1000 +
+        std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+
+    for (const auto& session : sessions_) {
+        int64_t start_ms = session.start_minute * 60000LL;
+        int64_t end_ms = session.end_minute * 60000LL;
+        bool inside = (start_ms <= end_ms) ? (now_ms >= start_ms && now_ms < end_ms)
+                                           : (now_ms >= start_ms || now_ms < end_ms);
+        if (inside) {
+            ms_since_open = (now_ms - start_ms + kDayMs) % kDayMs;
+            return true;
+        }
+    }
+    return false;
+}
+
+int64_t TickWatchdog::silence_threshold_ms(double tick_rate) const
+{
+    if (tick_rate < min_rate_ || tick_rate <= 0.0) {
+        return -1;
+    }
+    int64_t threshold = static_cast<int64_t>(silence_factor_ * 1000.0 / tick_rate);
+    return std::min(max_silence_ms_, std::max(min_silence_ms_, threshold));
+}
+
+bool TickWatchdog::parse_session(const std::string& text, int& start_minute, int& end_minute)
+{
+    int start_hour = 0, start_min = 0, end_hour = 0, end_min = 0;
+    if (std::sscanf(text.c_str(), "%d:%d-%d:%d", &start_hour, &start_min, &end_hour, &end_min) != 4) {
+        return false;
+    }
+    if (start_hour < 0 || start_hour > 23 || end_hour < 0 || end_hour > 24 ||
+        start_min < 0 || start_min > 59 || end_min < 0 || end_min > 59) {
+        return false;
+    }
+    start_minute = start_hour * 60 + start_min;
+    end_minute = end_hour * 60 + end_min;
+    return start_minute != end_minute;
+}
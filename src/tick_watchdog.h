@@ -0,0 +1,55 @@
+/////////////////////////////////////////////////////////////////////////
+///@file tick_watchdog.h
+///@brief	行情静默检测（交易时段与静默阈值）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "multi_ctp_config.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// 行情静默检测规则
+// 连接保持TCP连接但不再推送行情时，OnFrontDisconnected不会触发。按连接自身的行情频率估计
+// 正常的到达间隔，静默时间超过 factor 倍间隔（限制在[min, max]毫秒内）即判定为降级。
+// 只在交易时段内检测；频率过低的连接无法可靠判断，不检测。
+// 恢复带滞回：降级连接要在recovery_window_ms()内持续收到行情（间隔不超过静默阈值、条数足够）才回到正常状态。
+class TickWatchdog
+{
+public:
+    explicit TickWatchdog(const MultiCTPConfig& config);
+
+    bool is_enabled() const { return enabled_; }
+    int get_interval_ms() const { return interval_ms_; }
+    int get_restart_after_seconds() const { return restart_after_seconds_; }
+    int64_t get_max_silence_ms() const { return max_silence_ms_; }
+    // 降级连接须连续收到行情这么久才恢复：watchdog_restart_after的一半，不短于一个检测周期
+    int64_t recovery_window_ms() const { return std::max<int64_t>(restart_after_seconds_ * 500LL, interval_ms_); }
+
+    // 当前是否处于交易时段，ms_since_open返回距本时段开始的毫秒数
+    bool in_session(int64_t& ms_since_open) const;
+
+    // 按行情频率(条/秒)计算静默阈值，频率过低时返回-1表示不检测
+    int64_t silence_threshold_ms(double tick_rate) const;
+
+    // 解析"HH:MM-HH:MM"，结束早于开始表示跨零点
+    static bool parse_session(const std::string& text, int& start_minute, int& end_minute);
+
+private:
+    struct Session {
+        int start_minute;
+        int end_minute;
+    };
+
+    bool enabled_;
+    int interval_ms_;
+    int64_t min_silence_ms_;
+    int64_t max_silence_ms_;
+    double silence_factor_;
+    double min_rate_;
+    int restart_after_seconds_;
+    std::vector<Session> sessions_;
+};
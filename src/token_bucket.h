@@ -0,0 +1,72 @@
+/////////////////////////////////////////////////////////////////////////
+///@file token_bucket.h
+///@brief	令牌桶限速器
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <algorithm>
+
+// 令牌桶限速器
+// 以rate个/秒的速度补充令牌，最多累积burst个；每次请求消耗一个令牌。
+class TokenBucket
+{
+public:
+    TokenBucket(double rate, double burst)
+        : rate_(std::max(0.001, rate))
+        , burst_(std::max(1.0, burst))
+        , tokens_(std::max(1.0, burst))
+        , last_refill_(std::chrono::steady_clock::now())
+    {
+    }
+
+    // 尝试获取一个令牌，成功返回true
+    bool try_acquire()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refill();
+        if (tokens_ >= 1.0) {
+            tokens_ -= 1.0;
+            return true;
+        }
+        return false;
+    }
+
+    // 距离下一个令牌可用的等待时间
+    std::chrono::milliseconds time_until_available()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refill();
+        if (tokens_ >= 1.0) {
+            return std::chrono::milliseconds(0);
+        }
+        return std::chrono::milliseconds(static_cast<long long>((1.0 - tokens_) * 1000.0 / rate_) + 1);
+    }
+
+    void set_rate(double rate, double burst)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refill();
+        rate_ = std::max(0.001, rate);
+        burst_ = std::max(1.0, burst);
+        tokens_ = std::min(tokens_, burst_);
+    }
+
+private:
+    void refill()
+    {
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+        tokens_ = std::min(burst_, tokens_ + elapsed * rate_);
+        last_refill_ = now;
+    }
+
+    double rate_;
+    double burst_;
+    double tokens_;
+    std::chrono::steady_clock::time_point last_refill_;
+    std::mutex mutex_;
+};
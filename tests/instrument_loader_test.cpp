@@ -0,0 +1,196 @@
+/////////////////////////////////////////////////////////////////////////
+///@file instrument_loader_test.cpp
+///@brief	合约表缓存读写单元测试（make test）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "../src/instrument_loader.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond \
+                      << std::endl;                                              \
+            ++g_failures;                                                        \
+        }                                                                        \
+    } while (0)
+
+const char* const kFront = "tcp://127.0.0.1:10201";
+
+long long now_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string g_cache_file;
+
+MultiCTPConfig make_config(const std::string& front)
+{
+    MultiCTPConfig config;
+    config.instrument_trade_front = front;
+    config.instrument_cache_file = g_cache_file;
+    config.instrument_cache_max_age_hours = 12;
+    return config;
+}
+
+std::vector<InstrumentRecord> make_instruments()
+{
+    std::vector<InstrumentRecord> instruments(2);
+    instruments[0].exchange_id = "SHFE";
+    instruments[0].instrument_id = "rb2501";
+    instruments[0].product_id = "rb";
+    instruments[0].volume_multiple = 10;
+    instruments[0].price_tick = 1.0;
+    instruments[0].expire_date = "20250115";
+    instruments[1].exchange_id = "CFFEX";
+    instruments[1].instrument_id = "IO2501-C-4000";
+    instruments[1].product_id = "IO";
+    instruments[1].product_class = '2';
+    instruments[1].volume_multiple = 100;
+    instruments[1].price_tick = 0.2;
+    instruments[1].is_trading = false;
+    return instruments;
+}
+
+// 手写缓存文件，用于构造过期或异常内容
+void write_cache(long long saved_at, const std::string& front, const std::string& instruments)
+{
+    std::ofstream file(g_cache_file, std::ios::trunc);
+    file << "{\"saved_at\":" << saved_at << ",\"trade_front\":\"" << front
+         << "\",\"instruments\":" << instruments << "}";
+}
+
+const char* const kOneInstrument = "[{\"exchange_id\":\"SHFE\",\"instrument_id\":\"rb2501\"}]";
+
+void test_save_and_load()
+{
+    InstrumentLoader loader(make_config(kFront));
+    std::vector<InstrumentRecord> saved = make_instruments();
+    CHECK(loader.save_cache(saved));
+    CHECK(!std::filesystem::exists(g_cache_file + ".tmp"));
+
+    std::vector<InstrumentRecord> loaded;
+    CHECK(loader.load_cache(loaded, false));
+    CHECK(loaded.size() == saved.size());
+    for (size_t i = 0; i < loaded.size() && i < saved.size(); ++i) {
+        CHECK(loaded[i].exchange_id == saved[i].exchange_id);
+        CHECK(loaded[i].instrument_id == saved[i].instrument_id);
+        CHECK(loaded[i].product_id == saved[i].product_id);
+        CHECK(loaded[i].product_class == saved[i].product_class);
+        CHECK(loaded[i].volume_multiple == saved[i].volume_multiple);
+        CHECK(loaded[i].price_tick == saved[i].price_tick);
+        CHECK(loaded[i].expire_date == saved[i].expire_date);
+        CHECK(loaded[i].is_trading == saved[i].is_trading);
+    }
+}
+
+// 换了交易前置：新鲜缓存作废，查询失败时仍可作为过期缓存使用
+void test_trade_front_change()
+{
+    InstrumentLoader old_loader(make_config(kFront));
+    CHECK(old_loader.save_cache(make_instruments()));
+
+    InstrumentLoader loader(make_config("tcp://127.0.0.1:20201"));
+    std::vector<InstrumentRecord> loaded;
+    CHECK(!loader.load_cache(loaded, false));
+    CHECK(loaded.empty());
+    CHECK(loader.load_cache(loaded, true));
+    CHECK(loaded.size() == 2);
+}
+
+// saved_at超过有效期、缺失或在未来时不算新鲜缓存
+void test_expiry()
+{
+    InstrumentLoader loader(make_config(kFront));
+    std::vector<InstrumentRecord> loaded;
+
+    write_cache(now_ms() - 11LL * 3600 * 1000, kFront, kOneInstrument);
+    CHECK(loader.load_cache(loaded, false));
+
+    loaded.clear();
+    write_cache(now_ms() - 13LL * 3600 * 1000, kFront, kOneInstrument);
+    CHECK(!loader.load_cache(loaded, false));
+    CHECK(loader.load_cache(loaded, true));
+    CHECK(loaded.size() == 1);
+
+    loaded.clear();
+    write_cache(now_ms() + 3600 * 1000, kFront, kOneInstrument);
+    CHECK(!loader.load_cache(loaded, false));
+
+    std::ofstream(g_cache_file, std::ios::trunc)
+        << "{\"trade_front\":\"" << kFront << "\",\"instruments\":" << kOneInstrument << "}";
+    CHECK(!loader.load_cache(loaded, false));
+}
+
+// 空合约表（或全部条目无效）的缓存不可用，避免用空表覆盖内存中的合约
+void test_empty_instruments()
+{
+    InstrumentLoader loader(make_config(kFront));
+    std::vector<InstrumentRecord> loaded = make_instruments();
+
+    write_cache(now_ms(), kFront, "[]");
+    CHECK(!loader.load_cache(loaded, false));
+    CHECK(!loader.load_cache(loaded, true));
+    CHECK(loaded.size() == 2);
+
+    write_cache(now_ms(), kFront, "[{\"instrument_id\":\"rb2501\"},42]");
+    CHECK(!loader.load_cache(loaded, true));
+
+    std::ofstream(g_cache_file, std::ios::trunc) << "{\"saved_at\":";
+    CHECK(!loader.load_cache(loaded, true));
+
+    std::filesystem::remove(g_cache_file);
+    CHECK(!loader.load_cache(loaded, true));
+}
+
+// 未配置交易前置时查询直接失败，load退回过期缓存
+void test_load_falls_back_to_stale_cache()
+{
+    InstrumentLoader loader(make_config(""));
+    std::vector<InstrumentRecord> loaded;
+    std::string source;
+
+    std::filesystem::remove(g_cache_file);
+    CHECK(!loader.load(loaded, source));
+    CHECK(source == "no trade front configured");
+
+    write_cache(now_ms() - 13LL * 3600 * 1000, kFront, kOneInstrument);
+    CHECK(loader.load(loaded, source));
+    CHECK(source.compare(0, 11, "stale cache") == 0);
+    CHECK(loaded.size() == 1);
+}
+
+} // namespace
+
+int main()
+{
+    std::filesystem::path dir = std::filesystem::temp_directory_path() /
+                                ("instrument_loader_test." + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+    g_cache_file = (dir / "instrument_cache.json").string();
+
+    test_save_and_load();
+    test_trade_front_change();
+    test_expiry();
+    test_empty_instruments();
+    test_load_falls_back_to_stale_cache();
+
+    std::filesystem::remove_all(dir);
+
+    if (g_failures != 0) {
+        std::cerr << "instrument_loader_test: " << g_failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "instrument_loader_test: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,226 @@
+/////////////////////////////////////////////////////////////////////////
+///@file quote_codec_test.cpp
+///@brief	行情二进制编解码单元测试（make test）
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+#include "../src/quote_codec.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond \
+                      << std::endl;                                              \
+            ++g_failures;                                                        \
+        }                                                                        \
+    } while (0)
+
+bool same_price(double a, double b)
+{
+    return std::fabs(a - b) < 1e-9;
+}
+
+CThostFtdcDepthMarketDataField make_depth()
+{
+    CThostFtdcDepthMarketDataField md;
+    memset(&md, 0, sizeof(md));
+    strcpy(md.InstrumentID, "rb2501");
+    strcpy(md.TradingDay, "20250102");
+    strcpy(md.UpdateTime, "21:05:30");
+    md.UpdateMillisec = 500;
+    md.PreSettlementPrice = 3521.0;
+    md.PreClosePrice = 3518.0;
+    md.LastPrice = 3530.0;
+    md.HighestPrice = 3545.0;
+    md.LowestPrice = 3499.0;
+    md.OpenPrice = 3520.0;
+    md.ClosePrice = 0.0;            // 盘中无收盘价
+    md.SettlementPrice = DBL_MAX;   // CTP无效值
+    md.UpperLimitPrice = 3802.0;
+    md.LowerLimitPrice = 3239.0;
+    md.AskPrice1 = 3531.0; md.AskPrice2 = 3532.0; md.AskPrice3 = 3533.0;
+    md.BidPrice1 = 3530.0; md.BidPrice2 = 3529.0; md.BidPrice3 = 3528.0; md.BidPrice4 = 3527.0; md.BidPrice5 = 3526.0;
+    md.AskVolume1 = 12; md.AskVolume2 = 40; md.AskVolume3 = 7;
+    md.BidVolume1 = 3; md.BidVolume2 = 88; md.BidVolume3 = 15; md.BidVolume4 = 1; md.BidVolume5 = 260;
+    md.Volume = 1234567;
+    md.Turnover = 43567890123.5;
+    md.OpenInterest = 1876543;
+    md.PreOpenInterest = 1870001;
+    return md;
+}
+
+// 逐字段比对两条标准化行情（instrument_id不参与编码）
+void check_same(const NormalizedQuote& decoded, const NormalizedQuote& original)
+{
+    CHECK(decoded.present_mask == original.present_mask);
+    CHECK(decoded.timestamp_ms == original.timestamp_ms);
+    CHECK(decoded.volume == original.volume);
+    CHECK(decoded.open_interest == original.open_interest);
+    CHECK(decoded.pre_open_interest == original.pre_open_interest);
+    CHECK(memcmp(&decoded.amount, &original.amount, sizeof(double)) == 0);
+    if (original.has(kQuotePreSettlement)) {
+        CHECK(same_price(decoded.pre_settlement, original.pre_settlement));
+    }
+    for (int i = 0; i < kQuoteDepthLevels; ++i) {
+        if (original.has(kQuoteAskPrice1 << i)) {
+            CHECK(same_price(decoded.ask_price[i], original.ask_price[i]));
+            CHECK(decoded.ask_volume[i] == original.ask_volume[i]);
+        }
+        if (original.has(kQuoteBidPrice1 << i)) {
+            CHECK(same_price(decoded.bid_price[i], original.bid_price[i]));
+            CHECK(decoded.bid_volume[i] == original.bid_volume[i]);
+        }
+    }
+    const double NormalizedQuote::*scalars[] = {
+        &NormalizedQuote::last_price, &NormalizedQuote::highest, &NormalizedQuote::lowest,
+        &NormalizedQuote::open, &NormalizedQuote::close, &NormalizedQuote::settlement,
+        &NormalizedQuote::upper_limit, &NormalizedQuote::lower_limit, &NormalizedQuote::pre_close
+    };
+    const uint32_t bits[] = {kQuoteLastPrice, kQuoteHighest, kQuoteLowest, kQuoteOpen, kQuoteClose,
+                             kQuoteSettlement, kQuoteUpperLimit, kQuoteLowerLimit, kQuotePreClose};
+    for (size_t i = 0; i < sizeof(bits) / sizeof(bits[0]); ++i) {
+        if (original.has(bits[i])) {
+            CHECK(same_price(decoded.*scalars[i], original.*scalars[i]));
+        }
+    }
+}
+
+void test_round_trip()
+{
+    CThostFtdcDepthMarketDataField md = make_depth();
+    NormalizedQuote original;
+    QuoteCodec::normalize(md, original);
+
+    std::string encoded = QuoteCodec::encode(original);
+    CHECK(QuoteCodec::is_binary(encoded));
+
+    NormalizedQuote decoded;
+    CHECK(QuoteCodec::decode(encoded.data(), encoded.size(), decoded));
+    check_same(decoded, original);
+    CHECK(strcmp(decoded.trading_day, original.trading_day) == 0);
+    CHECK(strcmp(decoded.update_time, original.update_time) == 0);
+    CHECK(decoded.update_millisec == original.update_millisec);
+}
+
+// NaN/DBL_MAX/0 均视为无效价格：对应位为0，不参与编码
+void test_invalid_prices()
+{
+    CThostFtdcDepthMarketDataField md = make_depth();
+    md.LastPrice = std::numeric_limits<double>::quiet_NaN();
+    md.AskPrice1 = DBL_MAX;
+    md.BidPrice2 = -DBL_MAX;
+
+    NormalizedQuote original;
+    QuoteCodec::normalize(md, original);
+    CHECK(!original.has(kQuoteLastPrice));
+    CHECK(!original.has(kQuoteSettlement));
+    CHECK(!original.has(kQuoteClose));
+    CHECK(!original.has(kQuoteAskPrice1));
+    CHECK(!original.has(kQuoteBidPrice1 << 1));
+    CHECK(original.has(kQuoteAskPrice1 << 1));
+
+    std::string encoded = QuoteCodec::encode(original);
+    NormalizedQuote decoded;
+    CHECK(QuoteCodec::decode(encoded.data(), encoded.size(), decoded));
+    check_same(decoded, original);
+    CHECK(decoded.last_price == 0.0);
+    CHECK(decoded.ask_price[0] == 0.0);
+}
+
+// zigzag边界：int64/int32极值、负数和0
+void test_zigzag_edges()
+{
+    const int64_t values[] = {
+        0, 1, -1, 63, -64, 64, -65,
+        std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min(),
+        std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min(),
+        std::numeric_limits<int64_t>::max() - 1, std::numeric_limits<int64_t>::min() + 1
+    };
+    for (int64_t value : values) {
+        NormalizedQuote original;
+        memset(&original, 0, sizeof(original));
+        original.present_mask = kQuoteAskPrice1 | kQuoteBidPrice1;
+        original.timestamp_ms = value;
+        original.volume = value;
+        original.open_interest = ~value;
+        original.pre_open_interest = value;
+        original.amount = static_cast<double>(value);
+        original.ask_volume[0] = static_cast<int32_t>(value);
+        original.bid_volume[0] = std::numeric_limits<int32_t>::min();
+
+        std::string encoded = QuoteCodec::encode(original);
+        NormalizedQuote decoded;
+        CHECK(QuoteCodec::decode(encoded.data(), encoded.size(), decoded));
+        check_same(decoded, original);
+        // 超出localtime范围的时间戳不得留下未终止的日期字符串
+        CHECK(strnlen(decoded.trading_day, sizeof(decoded.trading_day)) < sizeof(decoded.trading_day));
+        CHECK(strnlen(decoded.update_time, sizeof(decoded.update_time)) < sizeof(decoded.update_time));
+    }
+
+    // 价格差值为负（低于昨结算）
+    NormalizedQuote original;
+    memset(&original, 0, sizeof(original));
+    original.present_mask = kQuotePreSettlement | kQuoteLastPrice | kQuoteLowerLimit;
+    original.pre_settlement = 80000.0;
+    original.last_price = 0.01;
+    original.lower_limit = 72000.5;
+    std::string encoded = QuoteCodec::encode(original);
+    NormalizedQuote decoded;
+    CHECK(QuoteCodec::decode(encoded.data(), encoded.size(), decoded));
+    check_same(decoded, original);
+}
+
+// 截断、版本号错误和超长varint都必须返回false，不能越界读
+void test_truncated_input()
+{
+    CThostFtdcDepthMarketDataField md = make_depth();
+    NormalizedQuote original;
+    QuoteCodec::normalize(md, original);
+    std::string encoded = QuoteCodec::encode(original);
+
+    NormalizedQuote decoded;
+    for (size_t len = 0; len < encoded.size(); ++len) {
+        // 拷贝到恰好len字节的堆内存，越界读可被sanitizer发现
+        std::unique_ptr<char[]> prefix(new char[len + 1]);
+        memcpy(prefix.get(), encoded.data(), len);
+        CHECK(!QuoteCodec::decode(prefix.get(), len, decoded));
+    }
+    CHECK(!QuoteCodec::decode(nullptr, 0, decoded));
+
+    std::string wrong_version = encoded;
+    wrong_version[0] = static_cast<char>(QuoteCodec::kBinaryVersion + 1);
+    CHECK(!QuoteCodec::decode(wrong_version.data(), wrong_version.size(), decoded));
+
+    std::string overlong(1, static_cast<char>(QuoteCodec::kBinaryVersion));
+    overlong.append(16, static_cast<char>(0x80));
+    CHECK(!QuoteCodec::decode(overlong.data(), overlong.size(), decoded));
+
+    CHECK(!QuoteCodec::is_binary("{\"instrument_id\":\"rb2501\"}"));
+}
+
+} // namespace
+
+int main()
+{
+    test_round_trip();
+    test_invalid_prices();
+    test_zigzag_edges();
+    test_truncated_input();
+
+    if (g_failures != 0) {
+        std::cerr << "quote_codec_test: " << g_failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "quote_codec_test: all checks passed" << std::endl;
+    return 0;
+}
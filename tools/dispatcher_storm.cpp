@@ -0,0 +1,367 @@
+/////////////////////////////////////////////////////////////////////////
+///@file dispatcher_storm.cpp
+///@brief	订阅分发器压测：多个生产者线程并发订阅/退订，统计事件循环吞吐与排队
+///@copyright	QuantAxis版权所有
+/////////////////////////////////////////////////////////////////////////
+
+// 使用真实的 SubscriptionDispatcher / CTPConnectionManager / CTPConnection，只替换厂商行情接口：
+// 本文件提供 CThostFtdcMdApi::CreateFtdcMdApi，返回的桩接口在自己的回调线程上立即应答登录和订阅，
+// 因此链接时不带 thostmduserapi_se.so（见 Makefile 的 storm 目标）。
+//
+// 用法: bin/dispatcher_storm [--producers 8] [--seconds 5] [--connections 4]
+//                            [--instruments 2000] [--batch 20] [--pause-us 1000]
+
+#include "../src/market_data_server.h"
+#include "../src/ctp_connection_manager.h"
+#include "../src/subscription_dispatcher.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 桩行情接口：Init后回调前置连接，登录和订阅请求在回调线程上立即应答成功
+class StormMdApi final : public CThostFtdcMdApi
+{
+public:
+    StormMdApi() : spi_(nullptr), running_(false) {}
+
+    void Release() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        delete this;
+    }
+
+    void Init() override
+    {
+        running_ = true;
+        thread_ = std::thread(&StormMdApi::callback_loop, this);
+        push([this]() { spi_->OnFrontConnected(); });
+    }
+
+    int Join() override { return 0; }
+    const char* GetTradingDay() override { return "20250102"; }
+    void RegisterFront(char*) override {}
+    void RegisterNameServer(char*) override {}
+    void RegisterFensUserInfo(CThostFtdcFensUserInfoField*) override {}
+    void RegisterSpi(CThostFtdcMdSpi* spi) override { spi_ = spi; }
+
+    int SubscribeMarketData(char* instruments[], int count) override
+    {
+        std::vector<std::string> ids(instruments, instruments + count);
+        push([this, ids]() {
+            for (size_t i = 0; i < ids.size(); ++i) {
+                CThostFtdcSpecificInstrumentField field;
+                memset(&field, 0, sizeof(field));
+                strncpy(field.InstrumentID, ids[i].c_str(), sizeof(field.InstrumentID) - 1);
+                spi_->OnRspSubMarketData(&field, nullptr, 0, i + 1 == ids.size());
+            }
+        });
+        return 0;
+    }
+
+    int UnSubscribeMarketData(char* instruments[], int count) override
+    {
+        std::vector<std::string> ids(instruments, instruments + count);
+        push([this, ids]() {
+            for (size_t i = 0; i < ids.size(); ++i) {
+                CThostFtdcSpecificInstrumentField field;
+                memset(&field, 0, sizeof(field));
+                strncpy(field.InstrumentID, ids[i].c_str(), sizeof(field.InstrumentID) - 1);
+                spi_->OnRspUnSubMarketData(&field, nullptr, 0, i + 1 == ids.size());
+            }
+        });
+        return 0;
+    }
+
+    int SubscribeForQuoteRsp(char*[], int) override { return 0; }
+    int UnSubscribeForQuoteRsp(char*[], int) override { return 0; }
+
+    int ReqUserLogin(CThostFtdcReqUserLoginField*, int request_id) override
+    {
+        push([this, request_id]() {
+            CThostFtdcRspUserLoginField rsp;
+            memset(&rsp, 0, sizeof(rsp));
+            spi_->OnRspUserLogin(&rsp, nullptr, request_id, true);
+        });
+        return 0;
+    }
+
+    int ReqUserLogout(CThostFtdcUserLogoutField*, int) override { return 0; }
+    int ReqQryMulticastInstrument(CThostFtdcQryMulticastInstrumentField*, int) override { return 0; }
+
+private:
+    void push(std::function<void()> callback)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            callbacks_.push_back(std::move(callback));
+        }
+        cv_.notify_one();
+    }
+
+    void callback_loop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this]() { return !callbacks_.empty() || !running_; });
+            if (!running_) {
+                break;
+            }
+            auto callback = std::move(callbacks_.front());
+            callbacks_.pop_front();
+            lock.unlock();
+            if (spi_) {
+                callback();
+            }
+            lock.lock();
+        }
+    }
+
+    CThostFtdcMdSpi* spi_;
+    bool running_;
+    std::deque<std::function<void()>> callbacks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+struct StormOptions {
+    int producers = 8;
+    int seconds = 5;
+    int connections = 4;
+    int instruments = 2000;
+    int batch = 20;
+    int pause_us = 1000;
+};
+
+struct StormResult {
+    size_t posted = 0;              // 生产者调用次数
+    size_t processed = 0;           // 事件循环执行的命令数，含订阅应答
+    double elapsed_s = 0.0;         // 从开始投递到队列清空
+    double produce_elapsed_s = 0.0;
+    double drain_ms = 0.0;          // 生产者停止后清空队列的耗时
+    double mean_wait_us = 0.0;
+    double max_wait_us = 0.0;
+    size_t peak_queue_depth = 0;
+    bool drained = false;
+};
+
+void print_usage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--producers N] [--seconds N] [--connections N]"
+              << " [--instruments N] [--batch N] [--pause-us N]" << std::endl;
+}
+
+// 等待事件循环队列清空并保持空闲，返回是否在超时前清空
+bool wait_idle(SubscriptionDispatcher& dispatcher, std::chrono::milliseconds timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    int idle_samples = 0;
+    size_t last_processed = 0;
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto stats = dispatcher.get_loop_statistics();
+        if (stats.queue_depth == 0 && stats.commands_processed == last_processed) {
+            if (++idle_samples >= 20) {
+                return true;
+            }
+        } else {
+            idle_samples = 0;
+        }
+        last_processed = stats.commands_processed;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+// 压测一轮：启动桩连接，生产者线程持续投递订阅/退订，停止后等待事件循环清空
+bool run_storm(const StormOptions& options, const std::vector<std::string>& instruments,
+               StormResult& result, std::string& error)
+{
+    MultiCTPConfig config;
+    MarketDataServer server(config);
+    auto dispatcher = std::make_unique<SubscriptionDispatcher>(&server);
+    auto manager = std::make_unique<CTPConnectionManager>(&server, dispatcher.get());
+
+    for (int i = 0; i < options.connections; ++i) {
+        CTPConnectionConfig connection_config;
+        connection_config.connection_id = "storm_" + std::to_string(i);
+        connection_config.front_addr = "tcp://127.0.0.1:" + std::to_string(10000 + i);
+        connection_config.broker_id = "9999";
+        connection_config.max_subscriptions = options.instruments;
+        connection_config.request_rate = 1000000;   // 不让令牌桶成为瓶颈
+        connection_config.request_burst = 1000000;
+        manager->add_connection(connection_config);
+    }
+
+    dispatcher->initialize(manager.get());
+    manager->start_all_connections();
+
+    auto login_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (manager->get_available_connections().size() < static_cast<size_t>(options.connections)) {
+        if (std::chrono::steady_clock::now() >= login_deadline) {
+            error = "stub connections did not log in";
+            dispatcher->shutdown();
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    wait_idle(*dispatcher, std::chrono::seconds(5));
+    auto baseline = dispatcher->get_loop_statistics();
+
+    // 采样线程：每毫秒读取一次队列深度
+    std::atomic<bool> sampling(true);
+    size_t peak_queue_depth = 0;
+    std::thread sampler([&]() {
+        while (sampling) {
+            peak_queue_depth = std::max(peak_queue_depth, dispatcher->get_loop_statistics().queue_depth);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    std::atomic<bool> producing(true);
+    std::atomic<size_t> posted(0);
+    std::vector<std::thread> producers;
+    auto storm_started = std::chrono::steady_clock::now();
+    for (int p = 0; p < options.producers; ++p) {
+        producers.emplace_back([&, p]() {
+            std::mt19937 rng(p + 1);
+            std::uniform_int_distribution<int> pick(0, options.instruments - 1);
+            const std::string session_id = "storm-session-" + std::to_string(p);
+            std::vector<std::string> batch(options.batch);
+            size_t local_posted = 0;
+            while (producing.load(std::memory_order_relaxed)) {
+                int start = pick(rng);
+                for (int i = 0; i < options.batch; ++i) {
+                    batch[i] = instruments[(start + i) % options.instruments];
+                }
+                const std::string& single = instruments[pick(rng)];
+                dispatcher->add_subscriptions(session_id, batch);
+                dispatcher->add_subscription(session_id, single);
+                dispatcher->remove_subscriptions(session_id, batch);
+                dispatcher->remove_subscription(session_id, single);
+                local_posted += 4;
+                if (options.pause_us > 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(options.pause_us));
+                }
+            }
+            posted += local_posted;
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(options.seconds));
+    producing = false;
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    auto producers_stopped = std::chrono::steady_clock::now();
+    bool drained = wait_idle(*dispatcher, std::chrono::seconds(60));
+    auto storm_finished = std::chrono::steady_clock::now();
+    sampling = false;
+    sampler.join();
+
+    auto stats = dispatcher->get_loop_statistics();
+    result.posted = posted;
+    result.processed = stats.commands_processed - baseline.commands_processed;
+    result.elapsed_s = std::chrono::duration<double>(storm_finished - storm_started).count();
+    result.produce_elapsed_s = std::chrono::duration<double>(producers_stopped - storm_started).count();
+    result.drain_ms = std::chrono::duration<double, std::milli>(storm_finished - producers_stopped).count();
+    // 累计平均减去压测前的部分，只统计压测期间的命令
+    result.mean_wait_us = result.processed
+        ? (stats.avg_wait_us * stats.commands_processed - baseline.avg_wait_us * baseline.commands_processed) /
+              result.processed
+        : 0.0;
+    result.max_wait_us = stats.max_wait_us;
+    result.peak_queue_depth = peak_queue_depth;
+    result.drained = drained;
+
+    dispatcher->shutdown();
+    manager.reset();
+    dispatcher.reset();
+    return true;
+}
+
+} // namespace
+
+CThostFtdcMdApi* CThostFtdcMdApi::CreateFtdcMdApi(const char*, const bool, const bool)
+{
+    return new StormMdApi();
+}
+
+int main(int argc, char* argv[])
+{
+    StormOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--producers" && i + 1 < argc) {
+            options.producers = std::atoi(argv[++i]);
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            options.seconds = std::atoi(argv[++i]);
+        } else if (arg == "--connections" && i + 1 < argc) {
+            options.connections = std::atoi(argv[++i]);
+        } else if (arg == "--instruments" && i + 1 < argc) {
+            options.instruments = std::atoi(argv[++i]);
+        } else if (arg == "--batch" && i + 1 < argc) {
+            options.batch = std::atoi(argv[++i]);
+        } else if (arg == "--pause-us" && i + 1 < argc) {
+            options.pause_us = std::atoi(argv[++i]);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.producers <= 0 || options.seconds <= 0 || options.connections <= 0 ||
+        options.instruments <= 0 || options.batch <= 0 || options.pause_us < 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> instruments;
+    for (int i = 0; i < options.instruments; ++i) {
+        instruments.push_back("storm" + std::to_string(i));
+    }
+
+    // 分发器每条订阅都输出日志：保留格式化开销，输出丢到/dev/null，报告前恢复
+    std::ofstream null_out("/dev/null");
+    std::streambuf* saved_cout = std::cout.rdbuf(null_out.rdbuf());
+    StormResult result;
+    std::string error;
+    bool completed = run_storm(options, instruments, result, error);
+    std::cout.rdbuf(saved_cout);
+    if (!completed) {
+        std::cerr << "Storm failed: " << error << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "producers=" << options.producers << " connections=" << options.connections
+              << " instruments=" << options.instruments << " batch=" << options.batch
+              << " pause_us=" << options.pause_us << " seconds=" << options.seconds << "\n"
+              << "client calls posted:     " << result.posted << " ("
+              << result.posted / result.produce_elapsed_s << "/s)\n"
+              << "loop commands processed: " << result.processed << " ("
+              << result.processed / result.elapsed_s << "/s, incl. acks)\n"
+              << "queue wait mean/max:     " << result.mean_wait_us << " us / " << result.max_wait_us << " us\n"
+              << "peak queue_depth:        " << result.peak_queue_depth << "\n"
+              << "drain after producers:   " << result.drain_ms << " ms"
+              << (result.drained ? "" : " (not drained)") << std::endl;
+    return result.drained ? 0 : 1;
+}